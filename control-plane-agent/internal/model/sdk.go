@@ -42,6 +42,10 @@ type SDKConfigRDMA struct {
 type SDKConnectionOptionsRDMA struct {
 	Provider     string `json:"provider,omitempty"`
 	NumEndpoints uint8  `json:"numEndpoints,omitempty"`
+	Transport    string `json:"transport,omitempty"`
+	Completion   string `json:"completion,omitempty"`
+	SegmentSize  uint32 `json:"segmentSize,omitempty"`
+	FlowControl  string `json:"flowControl,omitempty"`
 }
 
 type SDKConfigVideo struct {
@@ -190,6 +194,10 @@ func (s *SDKConnectionConfig) AssignFromPb(cfg *sdk.ConnectionConfig) error {
 	if cfg.Options != nil && cfg.Options.Rdma != nil {
 		s.Options.RDMA.Provider = cfg.Options.Rdma.Provider
 		s.Options.RDMA.NumEndpoints = uint8(cfg.Options.Rdma.NumEndpoints)
+		s.Options.RDMA.Transport = cfg.Options.Rdma.Transport
+		s.Options.RDMA.Completion = cfg.Options.Rdma.Completion
+		s.Options.RDMA.SegmentSize = cfg.Options.Rdma.SegmentSize
+		s.Options.RDMA.FlowControl = cfg.Options.Rdma.FlowControl
 	}
 
 	switch payload := cfg.Payload.(type) {
@@ -269,6 +277,10 @@ func (s *SDKConnectionConfig) AssignToPb(cfg *sdk.ConnectionConfig) {
 		Rdma: &sdk.ConnectionOptionsRDMA{
 			Provider:     s.Options.RDMA.Provider,
 			NumEndpoints: uint32(s.Options.RDMA.NumEndpoints),
+			Transport:    s.Options.RDMA.Transport,
+			Completion:   s.Options.RDMA.Completion,
+			SegmentSize:  s.Options.RDMA.SegmentSize,
+			FlowControl:  s.Options.RDMA.FlowControl,
 		},
 	}
 
@@ -338,6 +350,12 @@ func (s *SDKConnectionConfig) CheckPayloadCompatibility(c *SDKConnectionConfig)
 	if s.Options.RDMA.NumEndpoints != c.Options.RDMA.NumEndpoints {
 		return fmt.Errorf("incompatible rdma number of endpoints: %v vs. %v", s.Options.RDMA.NumEndpoints, c.Options.RDMA.NumEndpoints)
 	}
+	if s.Options.RDMA.Transport != c.Options.RDMA.Transport {
+		return fmt.Errorf("incompatible rdma transport: %v vs. %v", s.Options.RDMA.Transport, c.Options.RDMA.Transport)
+	}
+	if s.Options.RDMA.FlowControl != c.Options.RDMA.FlowControl {
+		return fmt.Errorf("incompatible rdma flow control: %v vs. %v", s.Options.RDMA.FlowControl, c.Options.RDMA.FlowControl)
+	}
 
 	switch {
 	case s.Payload.Video != nil:
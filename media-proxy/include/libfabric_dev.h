@@ -125,6 +125,9 @@ typedef enum {
     FI_KIND_TRANSMITTER,
     FI_KIND_RECEIVER,
 } conn_kind;
+struct rdma_domain;
+struct rdma_mr_cache;
+
 typedef struct {
     struct fid_fabric *fabric;
     struct fid_domain *domain;
@@ -138,6 +141,12 @@ typedef struct {
     int ep_attr_type;          // Store EP type for endpoint creation
     int addr_format;           // Store address format for endpoint creation
     const char *provider_name; // Provider name (e.g., "tcp", "verbs")
+    bool rma_write;            // One-sided RDMA write transport
+    bool flow_credits;         // Receiver returns credits to the transmitter
+    bool unreliable;           // Unreliable datagram endpoints
+    bool shared_rx;            // Endpoints receive from a shared receive context
+    struct rdma_domain *shared_domain; // Fabric and domain shared with other contexts
+    struct rdma_mr_cache *mr_cache; // Memory registration cache of the domain
 } libfabric_ctx;
 
 static void rdma_free_res(libfabric_ctx *rdma_ctx);
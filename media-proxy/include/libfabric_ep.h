@@ -34,6 +34,7 @@ typedef struct ep_ctx_t {
     cq_ctx_t cq_ctx;
 
     libfabric_ctx *rdma_ctx;
+    struct fid_ep *srx; /* Shared receive context, owned by the caller */
 
     volatile bool stop_flag;
 } ep_ctx_t;
@@ -44,6 +45,8 @@ typedef struct {
     rdma_addr local_addr;
     enum direction dir;
     struct fid_cq *shared_rx_cq;
+    enum cq_comp_method comp_method; /* Completion method of the CQ opened by ep_init */
+    struct fid_ep *srx;              /* Shared receive context to bind, or NULL */
 } ep_cfg_t;
 
 /**
@@ -52,21 +55,49 @@ typedef struct {
 struct libfabric_ep_ops_t {
     int (*ep_reg_mr)(ep_ctx_t *ep_ctx, void *data_buf, size_t data_buf_size);
     int (*ep_send_buf)(ep_ctx_t *ep_ctx, void *buf, size_t buf_size);
+    int (*ep_send_burst)(ep_ctx_t *ep_ctx, void **bufs, size_t *buf_sizes, int count);
+    int (*ep_sendv)(ep_ctx_t *ep_ctx, const struct iovec *iov, void **desc, size_t count,
+                    void *buf_ctx);
+    int (*ep_writedata)(ep_ctx_t *ep_ctx, const struct iovec *iov, void **desc, size_t count,
+                        uint64_t data, uint64_t remote_addr, uint64_t key, void *buf_ctx);
+    int (*ep_inject)(ep_ctx_t *ep_ctx, const void *buf, size_t buf_size);
+    int (*ep_inject_writedata)(ep_ctx_t *ep_ctx, const void *buf, size_t buf_size,
+                               uint64_t data, uint64_t remote_addr, uint64_t key);
     int (*ep_recv_buf)(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *buf_ctx);
+    int (*ep_recv_desc)(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *desc,
+                        void *buf_ctx);
     int (*ep_cq_read)(ep_ctx_t *ep_ctx, void **buf_ctx, int timeout);
     int (*ep_init)(ep_ctx_t **ep_ctx, ep_cfg_t *cfg);
+    int (*ep_reinit)(ep_ctx_t *ep_ctx, ep_cfg_t *cfg);
+    int (*ep_getname)(ep_ctx_t *ep_ctx, void *addr, size_t *addrlen);
+    int (*ep_set_peer)(ep_ctx_t *ep_ctx, const void *addr);
     int (*ep_destroy)(ep_ctx_t **ep_ctx);
 };
 
 extern struct libfabric_ep_ops_t libfabric_ep_ops;
 
+/* Find the name of the network interface having the address */
+int get_interface_name_by_ip(const char *ip_str, char *if_name, size_t if_name_len);
+
 #ifdef UNIT_TESTS_ENABLED
 /* buf has to point to memory registered with ep_reg_mr */
 int ep_send_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size);
+int ep_send_burst(ep_ctx_t *ep_ctx, void **bufs, size_t *buf_sizes, int count);
+int ep_sendv(ep_ctx_t *ep_ctx, const struct iovec *iov, void **desc, size_t count,
+             void *buf_ctx);
+int ep_writedata(ep_ctx_t *ep_ctx, const struct iovec *iov, void **desc, size_t count,
+                 uint64_t data, uint64_t remote_addr, uint64_t key, void *buf_ctx);
+int ep_inject(ep_ctx_t *ep_ctx, const void *buf, size_t buf_size);
+int ep_inject_writedata(ep_ctx_t *ep_ctx, const void *buf, size_t buf_size, uint64_t data,
+                        uint64_t remote_addr, uint64_t key);
 int ep_recv_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *buf_ctx);
+int ep_recv_desc(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *desc, void *buf_ctx);
 int ep_cq_read(ep_ctx_t *ep_ctx, void **buf_ctx, int timeout);
 int ep_reg_mr(ep_ctx_t *ep_ctx, void *data_buf, size_t data_buf_size);
 int ep_init(ep_ctx_t **ep_ctx, ep_cfg_t *cfg);
+int ep_reinit(ep_ctx_t *ep_ctx, ep_cfg_t *cfg);
+int ep_getname(ep_ctx_t *ep_ctx, void *addr, size_t *addrlen);
+int ep_set_peer(ep_ctx_t *ep_ctx, const void *addr);
 int ep_destroy(ep_ctx_t **ep_ctx);
 #endif /* UNIT_TESTS_ENABLED */
 
@@ -21,8 +21,22 @@ int rdma_reg_mr(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t si
                 void **desc);
 uint64_t rdma_info_to_mr_access(struct fi_info *info);
 void rdma_unreg_mr(struct fid_mr *data_mr);
+void rdma_mr_cache_invalidate(libfabric_ctx *rdma_ctx, void *buf, size_t size);
 #endif
 
+/**
+ * Registration cache of a domain, created with the domain and destroyed when
+ * the last device context on it is deinitialized. Registrations of host
+ * memory through rdma_reg_mr() are reference-counted and shared when an
+ * earlier one covers the range; rdma_unreg_mr() drops the reference and
+ * keeps the registration idle until it is evicted in LRU order.
+ *
+ * The cache cannot see memory being unmapped. Owners must invalidate a range
+ * with rdma_mr_cache_invalidate() before releasing it.
+ */
+int rdma_mr_cache_create(struct rdma_mr_cache **cache);
+void rdma_mr_cache_destroy(struct rdma_mr_cache **cache);
+
 /**
  * Isolation interface for testability. Accessed from unit tests only.
  */
@@ -32,6 +46,7 @@ struct libfabric_mr_ops_t {
                        struct fid_mr **mr, void **desc);
     uint64_t (*rdma_info_to_mr_access)(struct fi_info *info);
     void (*rdma_unreg_mr)(struct fid_mr *data_mr);
+    void (*rdma_mr_cache_invalidate)(libfabric_ctx *rdma_ctx, void *buf, size_t size);
 };
 
 extern struct libfabric_mr_ops_t libfabric_mr_ops;
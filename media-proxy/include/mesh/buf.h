@@ -7,8 +7,14 @@
 #ifndef BUF_H
 #define BUF_H
 
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "mesh_seq.h"
 
 namespace mesh::connection {
 
@@ -31,6 +37,7 @@ public:
     BufferPartition sysdata;
 
     size_t total_size() const;
+    size_t used_size(const void *data, size_t size) const;
 };
 
 /**
@@ -38,12 +45,94 @@ public:
  */
 class BufferSysData {
 public:
-    int64_t timestamp_ms;
-    uint32_t seq;
+    int64_t timestamp_ns; // capture time (CLOCK_REALTIME), 0 if not set
+    uint32_t seq;         // per-connection sequence number set by the sender
     uint32_t payload_len;
     uint32_t metadata_len;
 };
 
+class BufferPool;
+
+/**
+ * Reference-counted handle to a data plane buffer
+ *
+ * A handle is allocated from a BufferPool and holds one reference, owned
+ * by the caller of alloc(). A data plane stage that needs the buffer after
+ * returning from the call, e.g. to queue or forward it asynchronously, must
+ * retain() the handle and release() it when done. When the last reference
+ * is dropped, the release callback returns the underlying memory to its
+ * owner, e.g. a memif ring slot, and the handle goes back to the pool.
+ *
+ * A handle of a ring slot stalls the ingress ring while it is held. Stages
+ * that queue buffers for an unbounded time copy such a buffer instead.
+ */
+class BufferHandle {
+public:
+    using ReleaseCallback = void (*)(BufferHandle *buf);
+
+    void retain();
+    void release();
+
+    const BufferPartitions& parts() const;
+    BufferSysData * sysdata() const;
+
+    void *data;
+    uint32_t size;
+    int64_t ingress_ns; // time the buffer entered Media Proxy, 0 if unknown
+    bool ring_slot;     // the buffer is a slot of an ingress ring
+
+    ReleaseCallback on_release;
+    void *owner;
+    uint64_t cookie;
+
+private:
+    friend class BufferPool;
+
+    std::atomic<uint32_t> refs;
+    BufferPool *pool;
+};
+
+/**
+ * Fixed-capacity pool of buffer handles
+ *
+ * All handles of the pool share the same buffer partitioning. If storage
+ * is requested, the pool allocates memory for every handle, and the handle
+ * data points to it. Otherwise, the handles wrap memory owned by the caller.
+ *
+ * The pool is deleted by destroy(). The deletion is deferred until all
+ * handles are released. The owner of the memory the handles point into
+ * frees it in a callback passed to on_destroy(), so the memory outlives
+ * the last handle.
+ */
+class BufferPool {
+public:
+    BufferPool(const BufferPartitions& parts) : parts(parts) {}
+
+    bool init(uint32_t capacity, bool with_storage = false);
+    void destroy();
+    void on_destroy(std::function<void()> fn);
+
+    BufferHandle * alloc();
+    uint32_t available();
+    uint32_t outstanding();
+
+    const BufferPartitions parts;
+
+private:
+    friend class BufferHandle;
+
+    ~BufferPool();
+    void put(BufferHandle *buf);
+
+    std::unique_ptr<BufferHandle[]> handles;
+    std::unique_ptr<uint8_t[]> storage;
+    std::vector<BufferHandle *> free_list;
+    std::vector<std::function<void()>> destroy_fns;
+    std::mutex mx;
+    uint32_t capacity = 0;
+    bool destroying = false;
+};
+
 } // namespace mesh::connection
 
 #endif // BUF_H
@@ -166,6 +166,34 @@ public:
         return true;
     }
 
+    bool try_send(T value) {
+        std::unique_lock<std::mutex> lk(mx);
+        if (_closed || q.size() >= cap) {
+            return false;
+        }
+        q.push(std::move(value));
+        cv_empty.notify_one();
+        return true;
+    }
+
+    // Sends the value without blocking. If the channel is full, the oldest
+    // value is evicted to make room and returned to the caller. If the
+    // channel is closed, the value itself is returned.
+    std::optional<T> send_evict(T value) {
+        std::unique_lock<std::mutex> lk(mx);
+        if (_closed) {
+            return value;
+        }
+        std::optional<T> evicted;
+        if (q.size() >= cap) {
+            evicted = std::move(q.front());
+            q.pop();
+        }
+        q.push(std::move(value));
+        cv_empty.notify_one();
+        return evicted;
+    }
+
     std::optional<T> receive(context::Context& ctx) {
         std::unique_lock<std::mutex> lk(mx);
         cv_empty.wait(lk, ctx.stop_token(), [this] { return !q.empty() || _closed; });
@@ -160,6 +160,10 @@ public:
         struct {
             std::string provider;
             uint16_t num_endpoints;
+            std::string transport;
+            std::string completion;
+            uint32_t segment_size;
+            std::string flow_control;
         } rdma;
     } options;
 
@@ -225,6 +229,12 @@ public:
 
     Result do_receive(context::Context& ctx, void *ptr, uint32_t sz,
                       uint32_t& sent);
+    Result do_receive(context::Context& ctx, BufferHandle *buf, uint32_t& sent);
+    Result do_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                            uint32_t count, uint32_t& sent);
+
+    // Max number of buffers passed in one burst through the link.
+    static constexpr uint32_t burst_max = 32;
 
     // TODO: add calls to reset metrics (counters).
 
@@ -241,34 +251,54 @@ protected:
     Result set_result(Result res);
 
     Result transmit(context::Context& ctx, void *ptr, uint32_t sz);
+    Result transmit(context::Context& ctx, BufferHandle *buf);
+    Result transmit_burst(context::Context& ctx, BufferHandle **bufs,
+                          uint32_t count);
 
     virtual Result on_establish(context::Context& ctx) = 0;
     virtual Result on_shutdown(context::Context& ctx) = 0;
     virtual Result on_receive(context::Context& ctx, void *ptr, uint32_t sz,
                               uint32_t& sent);
+    virtual Result on_receive(context::Context& ctx, BufferHandle *buf,
+                              uint32_t& sent);
+    virtual Result on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                                    uint32_t count, uint32_t& sent);
     virtual void on_delete(context::Context& ctx) {}
 
     Kind _kind = Kind::undefined; // must be properly set in the derived class ctor
 
     sync::DataplaneAtomicPtr dp_link;
 
+    // Counters are updated by the data plane threads without contention
+    // and aggregated on read.
     struct {
-        std::atomic<uint64_t> inbound_bytes;
-        std::atomic<uint64_t> outbound_bytes;
-        std::atomic<uint32_t> transactions_succeeded;
-        std::atomic<uint32_t> transactions_failed;
-        std::atomic<uint32_t> errors;
-
-        int64_t  prev_timestamp_ms;
-        uint64_t prev_inbound_bytes;
-        uint64_t prev_outbound_bytes;
-        uint32_t prev_errors;
-        uint32_t prev_transactions_succeeded;
+        telemetry::ShardedCounters<5> counters;
+
+        telemetry::ShardedCounter<5> inbound_bytes{counters, 0};
+        telemetry::ShardedCounter<5> outbound_bytes{counters, 1};
+        telemetry::ShardedCounter<5> transactions_succeeded{counters, 2};
+        telemetry::ShardedCounter<5> transactions_failed{counters, 3};
+        telemetry::ShardedCounter<5> errors{counters, 4};
+
+        telemetry::Histogram receive_ns; // time spent in on_receive() per call
+        telemetry::Histogram e2e_ns;     // from ingress to completion of on_receive()
+
+        // Checked at ingress against the system data set by the sender.
+        SequenceTracker seq;
+        telemetry::Histogram capture_ns; // from capture by the sender to ingress
+
+        int64_t  prev_timestamp_ms = 0;
+        uint64_t prev_inbound_bytes = 0;
+        uint64_t prev_outbound_bytes = 0;
+        uint64_t prev_errors = 0;
+        uint64_t prev_transactions_succeeded = 0;
     } metrics;
 
-private:
     virtual void collect(telemetry::Metric& metric, const int64_t& timestamp_ms);
 
+private:
+    void track_ingress(const BufferSysData *sysdata);
+
     std::atomic<State> _state = State::not_configured;
     std::atomic<Status> _status = Status::initial;
 
@@ -8,6 +8,9 @@
 #define CONN_LOCAL_H
 
 #include "conn.h"
+#include "conn_local_relay.h"
+#include "conn_local_poller.h"
+#include "mem_region.h"
 #include "mcm_dp.h"
 #include "shm_memif.h"
 #include <cstdarg>
@@ -17,32 +20,89 @@ namespace mesh::connection {
 class Local : public Connection {
 
 public:
+    ~Local() override;
+
     Result configure_memif(context::Context& ctx, memif_ops_t *ops,
                            size_t frame_size, uint8_t log2_ring_size);
     void get_params(memif_conn_param *param);
+    std::string relay_region_path() const { return relay ? relay->path : ""; }
+
+    virtual void relay_reclaim() {}
 
 protected:
     virtual void default_memif_ops(memif_ops_t *ops) = 0;
-    virtual int on_memif_receive(void *ptr, uint32_t sz) = 0;
+    virtual int on_memif_receive(BufferHandle **bufs, uint16_t count) = 0;
+    virtual void on_relay_disconnect() {}
+
+    bool relay_active() const { return relay && relay_connected; }
 
     memif_socket_handle_t memif_socket;
     memif_conn_handle_t memif_conn;
     size_t frame_size;
 
+    // Zero-copy relay region shared with other local connections of
+    // the multipoint group. Set to nullptr when the relay is disabled.
+    RelayRegion *relay = nullptr;
+    bool relay_connected = false; // peer has mapped the relay region
+    std::mutex relay_mx;
+
+    // Egress: slots referenced by the memif tx descriptors.
+    std::unique_ptr<uint32_t[]> relay_slots;
+
 private:
     Result on_establish(context::Context& ctx) override;
     Result on_shutdown(context::Context& ctx) override;
 
+    int rx_burst(uint16_t qid, uint16_t& received);
+    uint16_t poll_rx();
+    void rx_refill(uint16_t qid);
+    bool rx_open();
+    void rx_close();
+    void * rx_map(void *data, uint32_t len) const;
+    void relay_detach();
+
+    static void on_rx_buffer_release(BufferHandle *buf);
+
     static int callback_on_connect(memif_conn_handle_t conn, void *private_ctx);
     static int callback_on_disconnect(memif_conn_handle_t conn, void *private_ctx);
     static int callback_on_interrupt(memif_conn_handle_t conn, void *private_ctx,
                                      uint16_t qid);
+    static void * callback_get_region_addr(uint32_t size, int fd,
+                                           void *private_ctx);
+    static int callback_del_region(void *addr, uint32_t size, int fd,
+                                   void *private_ctx);
 
     memif_socket_args_t memif_socket_args;
     memif_conn_args_t memif_conn_args;
     memif_ops_t ops;
     std::jthread th;
-    bool ready;
+    std::atomic<bool> ready = false;
+
+    // Set while the ingress ring is served by a busy-poll thread.
+    // Accessed only by the memif event loop thread.
+    LocalPoller *poller = nullptr;
+    friend class LocalPoller;
+
+    // Ingress: ring slots received in order, each returned to the memif
+    // ring only after all consumers have released its buffer handle.
+    // The pool, the slot reference counters and the region mappings belong
+    // to one memif session, and are freed after the last handle is released.
+    struct PendingSlot {
+        uint32_t slot;
+        bool relay;
+    };
+    struct RxMap {
+        uint8_t *memif_addr; // Mapping of libmemif, gone on disconnect
+        uint8_t *addr;       // Mapping the buffer handles point into
+        size_t size;
+    };
+    BufferPool *rx_pool = nullptr;
+    std::atomic<uint32_t> *rx_refs = nullptr;
+    std::vector<RxMap> rx_maps;
+    std::unique_ptr<PendingSlot[]> rx_pending;
+    uint32_t rx_ring_size = 0;
+    uint32_t rx_pending_head = 0;
+    std::atomic<uint32_t> rx_pending_count = 0; // Also read by the event loop
 };
 
 } // namespace mesh::connection
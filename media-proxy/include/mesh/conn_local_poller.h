@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef CONN_LOCAL_POLLER_H
+#define CONN_LOCAL_POLLER_H
+
+#include "conn_worker.h"
+
+namespace mesh::connection {
+
+class Local;
+
+/**
+ * LocalPoller
+ *
+ * Busy-poll thread serving the ingress rings of many local connections.
+ * Connections attached to a poller have memif interrupts disabled. The
+ * poller drains every ring with multi-buffer bursts and refills it in
+ * batches, which saves an eventfd wakeup and a syscall per packet.
+ *
+ * The poller spins while it has connections to serve.
+ */
+class LocalPoller : public ConnWorker<LocalPoller, Local> {
+    friend class ConnWorker<LocalPoller, Local>;
+
+    static constexpr const char *name = "Local poller";
+
+    LocalPoller(int cpu) : ConnWorker(cpu) { start(); }
+
+    static const std::vector<int>& cpus();
+    uint32_t poll(Local *conn);
+    void idle(uint32_t work, int& idle_cycles);
+};
+
+} // namespace mesh::connection
+
+#endif // CONN_LOCAL_POLLER_H
@@ -0,0 +1,97 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef CONN_LOCAL_RELAY_H
+#define CONN_LOCAL_RELAY_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace mesh::connection {
+
+class Local;
+
+/**
+ * RelayRegion
+ *
+ * Memif buffer region owned by Media Proxy and shared by all local
+ * connections of a multipoint group to relay frames without copying.
+ *
+ * The region is a file in /run/mcm. Its path is passed to the SDK, which
+ * maps it as the external buffer region of the memif interface, so all
+ * interfaces of the group see the same memory. The layout follows the
+ * libmemif one: the lower half holds slots of the slave-to-master ring,
+ * the upper half holds slots of the master-to-slave ring. The ingress
+ * connection receives frames into the lower half, and the egress connections
+ * point their descriptors at the received slots instead of copying the data.
+ * The upper half is a pool of slots the egress connections copy into when
+ * a frame does not originate from the region.
+ *
+ * Every slot carries a reference counter. The ingress connection returns
+ * a slot to its ring only after all egress connections have released it.
+ */
+class RelayRegion {
+public:
+    static constexpr uint32_t no_slot = UINT32_MAX;
+
+    static RelayRegion * attach(const std::string& urn, uint32_t buffer_size,
+                                uint32_t ring_size, bool producer);
+    void detach(bool producer);
+    void attach_ref();
+
+    void add_consumer(Local *conn);
+    void remove_consumer(Local *conn);
+    void reclaim_consumers();
+
+    bool is_slot(const void *ptr, uint32_t sz) const {
+        auto p = (const uint8_t *)ptr;
+        return p >= base && p + sz <= base + size &&
+               !((p - base) % buffer_size);
+    }
+    uint32_t slot_of(const void *ptr) const {
+        return ((const uint8_t *)ptr - base) / buffer_size;
+    }
+    uint32_t offset_of(uint32_t slot) const {
+        return slot * buffer_size;
+    }
+    bool is_same_file(int other_fd) const;
+
+    void hold(uint32_t slot);
+    void retain(uint32_t slot);
+    void release(uint32_t slot);
+    bool is_released(uint32_t slot) const;
+    bool alloc_slot(uint32_t& slot);
+
+    std::string path;
+    void *addr;
+    uint32_t size;
+    uint32_t buffer_size;
+    uint32_t ring_size;
+
+private:
+    RelayRegion(const std::string& urn, uint32_t buffer_size,
+                uint32_t ring_size);
+    ~RelayRegion();
+
+    std::string urn;
+    uint8_t *base;
+    int fd;
+    std::unique_ptr<std::atomic<uint32_t>[]> refs;
+    std::atomic<uint32_t> next_pool_slot;
+    int attached;
+    bool has_producer;
+
+    std::list<Local *> consumers;
+    std::mutex consumers_mx;
+};
+
+} // namespace mesh::connection
+
+#endif // CONN_LOCAL_RELAY_H
@@ -17,7 +17,7 @@ public:
 
 private:
     void default_memif_ops(memif_ops_t *ops) override;
-    int on_memif_receive(void *ptr, uint32_t sz) override;
+    int on_memif_receive(BufferHandle **bufs, uint16_t count) override;
 
     bool no_link_reported;
 };
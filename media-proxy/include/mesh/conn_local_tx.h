@@ -16,12 +16,24 @@ class LocalTx : public Local {
 public:
     LocalTx();
 
+    void relay_reclaim() override;
+
 private:
     void default_memif_ops(memif_ops_t *ops) override;
-    int on_memif_receive(void *ptr, uint32_t sz) override;
+    int on_memif_receive(BufferHandle **bufs, uint16_t count) override;
+    void on_relay_disconnect() override;
 
     Result on_receive(context::Context& ctx, void *ptr, uint32_t sz,
                       uint32_t& sent) override;
+    Result on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                            uint32_t count, uint32_t& sent) override;
+
+    Result send_burst(void **ptrs, uint32_t *sizes, uint16_t count,
+                      uint32_t& sent);
+    void reclaim_slots();
+    void release_slots(uint32_t *slots, uint16_t count);
+
+    uint16_t relay_reclaimed = 0; // first tx descriptor not yet reclaimed
 };
 
 } // namespace mesh::connection
@@ -9,11 +9,11 @@
 #include "libfabric_cq.h"
 #include "libfabric_dev.h"
 #include "mcm_dp.h"
+#include "sync.h"
 #include <mutex>
 #include <cstring>
 #include <cstddef>
 #include <atomic>
-#include <queue>
 #include <array>
 
 #ifndef RDMA_DEFAULT_TIMEOUT
@@ -31,9 +31,57 @@
 #ifndef RDMA_NUM_EPS
 #define RDMA_NUM_EPS  1
 #endif
+#ifndef RDMA_MAX_EPS
+#define RDMA_MAX_EPS  8
+#endif
+#ifndef RDMA_INJECT_MAX
+#define RDMA_INJECT_MAX 2048
+#endif
+
+/* RDMA completion queue polling strategy */
+typedef enum {
+    RDMA_CQ_HYBRID = 0, /**< spin, then yield, then sleep */
+    RDMA_CQ_BUSY_POLL,  /**< spin continuously */
+    RDMA_CQ_FD_WAIT,    /**< block on the CQ file descriptor */
+} mcm_rdma_cq_strategy;
+
+/* RDMA flow control when the receiver has no room for another frame */
+typedef enum {
+    RDMA_FLOW_NONE = 0,    /**< no credits with the send transport, retry the send */
+    RDMA_FLOW_BLOCK,       /**< wait for a credit */
+    RDMA_FLOW_DROP_OLDEST, /**< drop the oldest frame waiting for a credit */
+    RDMA_FLOW_DROP_NEWEST, /**< drop the frame being sent */
+} mcm_rdma_flow_control;
+
+/* RDMA endpoint type selected by the connection mode */
+typedef enum {
+    RDMA_EP_RELIABLE = 0, /**< reliable datagram endpoint, "RC" or "RD" */
+    RDMA_EP_UNRELIABLE,   /**< unreliable datagram endpoint, "UD" */
+} mcm_rdma_ep_type;
 
 namespace mesh::connection {
 
+/**
+ * RdmaOptions
+ *
+ * Options of an RDMA connection set by the proxy. They are passed next to
+ * mcm_conn_param, which the SDK sends as is over gRPC, so that the wire
+ * size of mcm_conn_param stays the same.
+ */
+struct RdmaOptions {
+    bool rma_write = false; // One-sided RDMA write transport
+    mcm_rdma_cq_strategy cq_strategy = RDMA_CQ_HYBRID;
+    std::string local_ips;  // Comma-separated local addresses, one per rail
+    std::string remote_ips; // Comma-separated remote addresses, one per rail
+    uint32_t segment_size = 0; // Chunk size of segmented frame writes, 0 = whole frames
+    mcm_rdma_flow_control flow_control = RDMA_FLOW_NONE;
+    mcm_rdma_ep_type ep_type = RDMA_EP_RELIABLE;
+    uint32_t max_latency_ns = 0; // Latency budget of the transmitter, 0 = none
+};
+
+class RdmaProgress;
+class RdmaSharedRx;
+
 /**
  * Rdma
  *
@@ -42,16 +90,21 @@ namespace mesh::connection {
  * for specialized RDMA Tx and Rx classes.
  */
 class Rdma : public Connection {
+    friend class RdmaProgress;
+
 public:
     Rdma();
     virtual ~Rdma();
-    // Deinitialize RDMA if no active connections
+    // Deinitialize the device context, which closes its domain if no other
+    // context holds it
     static void deinit_rdma_if_needed(libfabric_ctx *m_dev_handle);
+    // NUMA node of the network interface having the address, or -1
+    static int nic_numa_node(const char *ip);
 
 // Used only for Unit tests, provides access to protected members
 #ifdef UNIT_TESTS_ENABLED
-    size_t get_buffer_queue_size() const { return buffer_queue.size(); }
-    bool is_buffer_queue_empty() const { return buffer_queue.empty(); }
+    size_t get_buffer_queue_size() const { return buffer_ring.size(); }
+    bool is_buffer_queue_empty() const { return buffer_ring.empty(); }
     void *get_buffer_block() const { return buffer_block; }
 #endif
 
@@ -63,7 +116,8 @@ public:
 protected:
     // Configure the RDMA session
     virtual Result configure(context::Context& ctx, const mcm_conn_param& request,
-                             libfabric_ctx *& dev_handle);
+                             libfabric_ctx *& dev_handle,
+                             const RdmaOptions& options = {});
 
     // Overrides from Connection
     virtual Result on_establish(context::Context& ctx) override;
@@ -89,19 +143,54 @@ protected:
     std::string          rdma_provider = "verbs"; // Default provider
     // Endpoint contexts (one pointer per EP)
     std::vector<ep_ctx_t*> ep_ctxs;
+
+    // Rails. Every rail is a pair of local and remote addresses, usually on
+    // a separate NIC, with its own fabric and domain. The first rail uses
+    // m_dev_handle. Endpoint i runs on rail i % rails.size(), so frames
+    // striped across the endpoints are spread across the rails. Endpoints
+    // of one rail share the completion queue of its first endpoint.
+    struct Rail {
+        rdma_addr local_addr;
+        rdma_addr remote_addr;
+        libfabric_ctx *dev = nullptr;
+    };
+    std::vector<Rail> rails;
+    std::vector<ep_ctx_t*> cq_eps; // First endpoint of every rail
+
+    size_t rail_of(size_t ep_idx) const { return ep_idx % rails.size(); }
+    Result rails_init();
+    void rails_deinit();
     ep_cfg_t ep_cfg;                            // RDMA endpoint configuration
     size_t trx_sz;                              // Data transfer size
     bool init;                                  // Indicates if RDMA is initialized
     void *buffer_block;                         // Pointer to the allocated buffer block
+
+    // The buffer block is mapped on the NUMA node of the NIC of the first
+    // rail, from hugepages if configured. It is registered once per rail,
+    // by the first endpoint of the rail, and the other endpoints of the
+    // rail share the registration.
+    size_t buffer_block_size = 0; // Mapped size
+    size_t buffer_block_page = 0; // Size of the pages backing the block
+    int buffer_block_node = -1;   // NUMA node, or -1 if unknown
+
+    void *alloc_block(size_t size);
+    void free_block();
+
+    // Frees memory the buffer handles passed to the linked connection may
+    // still point into. A receiver defers it until the last handle is
+    // released.
+    virtual void retire(std::function<void()> fn) { fn(); }
+    Result register_block();
+    struct fid_mr *block_mr(size_t ep_idx) const;
+    void collect(telemetry::Metric& metric, const int64_t& timestamp_ms) override;
     int queue_size;                             // Number of buffers in the queue
     static std::atomic<int> active_connections; // Number of active RDMA connections
 
     static constexpr size_t TRAILER = sizeof(uint64_t); // Size of the trailer for sequence number
 
-    // Queue for managing buffers
-    std::queue<void *> buffer_queue;      // Queue holding available buffers
-    std::mutex queue_mutex;               // Mutex for buffer queue synchronization
-    std::condition_variable_any queue_cv; // Condition variable for buffer availability
+    // Lock-free ring of available pre-registered buffers. Grows to the
+    // queue size in init_queue_with_elements().
+    sync::Ring buffer_ring{64};
 
     // // RDMA thread logic
     virtual Result start_threads(context::Context& ctx) = 0;
@@ -109,6 +198,8 @@ protected:
     Result init_queue_with_elements(size_t capacity, size_t trx_sz);
     Result add_to_queue(void *element);
     Result consume_from_queue(context::Context& ctx, void **element);
+    Result consume_from_queue(context::Context& ctx, void **element,
+                              std::chrono::nanoseconds timeout);
     void cleanup_queue();
 
     std::jthread handle_process_buffers_thread;  // Thread for processing buffers
@@ -121,8 +212,153 @@ protected:
     bool event_ready = false;          // Indicates if an event is ready in the CQ
 
     void notify_cq_event();
+    static void cq_backoff(bool did_work, int& idle_cycles);
+    void cq_idle(bool did_work, int& idle_cycles);
+    void cq_wait_fd(std::chrono::nanoseconds timeout);
+
+    // Completion queue polling strategy of the connection threads.
+    mcm_rdma_cq_strategy cq_strategy = RDMA_CQ_HYBRID;
+
+    // Endpoint type selected by the connection mode. Unreliable datagram
+    // endpoints carry every frame in a single message of at most the MTU,
+    // and support the send transport only. The verbs provider has none.
+    mcm_rdma_ep_type ep_type = RDMA_EP_RELIABLE;
+
+    // Latency budget of a frame from its arrival to its send, 0 if none.
+    uint32_t max_latency_ns = 0;
 
     std::atomic<bool> buf_available; // Indicates buffer availability in the queue
+
+    // Shared progress engine. When the connection is attached to a worker,
+    // no per-connection threads are started and the worker calls poll().
+    // poll() makes one non-blocking pass over the completion queue and
+    // returns the amount of work done, or -1 on a fatal error.
+    RdmaProgress *progress = nullptr;
+    bool progress_stopped = false; // Accessed by the worker only
+
+    virtual int poll(context::Context& ctx) { return 0; }
+    bool progress_attach();
+    void progress_detach();
+    bool progress_inline() const;
+    uint32_t progress_poll();
+    void stop_endpoints();
+
+    // Shared receive context. When enabled in the proxy config, a receiver
+    // of the send transport without credits and with a single rail takes its
+    // buffers from the shared receive context of its domain instead of a
+    // buffer block of its own, and returns them there. m_dev_handle is then
+    // a clone of the shared domain context, freed on detach. The endpoints
+    // are not reconnected in place, since no buffer is posted on them.
+    RdmaSharedRx *shared_rx = nullptr;
+
+    void shared_rx_attach();
+    void shared_rx_detach();
+
+    // Fast reconnect of the send transport. A connection reset seen by the
+    // CQ poller re-creates the endpoints and their address vector entries in
+    // place, keeping the fabrics, the domains, the CQs, the memory
+    // registrations and the buffer pool. The data plane stays off the
+    // endpoints meanwhile, and the buffers posted on the old endpoints are
+    // recycled into the pool. A link lost again within a second of the last
+    // reconnect is flapping, and the next reconnect backs off exponentially,
+    // from 100 us up to 8 ms.
+    std::atomic<bool> link_down = false;
+    std::atomic<uint32_t> ep_users = 0;              // Data plane threads posting
+    std::unique_ptr<std::atomic<bool>[]> buf_posted; // Posted buffers, by slot
+    std::vector<ep_cfg_t> ep_cfgs;
+    uint32_t reconnect_attempt = 0;                         // CQ poller only
+    std::chrono::steady_clock::time_point reconnect_due;    // CQ poller only
+    std::chrono::steady_clock::time_point reconnect_ts;     // CQ poller only
+    std::chrono::steady_clock::time_point link_down_ts;     // CQ poller only
+    std::atomic<uint64_t> reconnects = 0;
+    std::atomic<uint64_t> link_dropped = 0; // Frames dropped while reconnecting
+
+    bool ep_enter();
+    void ep_exit();
+    void mark_posted(void *buf, bool posted = true);
+    void link_lost(int err);
+    void reconnect_poll();
+    int reconnect_endpoints();
+    void cq_discard(struct fid_cq *cq);
+    virtual void recycle_posted(void *buf);
+    virtual void on_reconnect() {}
+
+    // Called on shutdown after the endpoints are destroyed, before the
+    // domains of the rails are closed.
+    virtual void on_cleanup() {}
+
+    // Flow control. The receiver returns credits to the transmitter, which
+    // keeps no more frames in flight than the receiver has room for, and
+    // applies the policy when it runs out of credits. The write transport
+    // always uses credits. The send transport uses credits unless the
+    // policy is none, one per receive posted by the receiver.
+    mcm_rdma_flow_control flow_control = RDMA_FLOW_NONE;
+    bool flow_credits() const { return rma_write || flow_control != RDMA_FLOW_NONE; }
+
+    // One-sided write transport. The receiver exposes its buffer block as
+    // a ring of frame slots, and the transmitter writes every frame to the
+    // next slot with the slot index as immediate data. A slot holds the
+    // payload length followed by the payload. The slots released by the
+    // receiver are returned to the transmitter as credits. Control messages
+    // are exchanged on the first endpoint from a separately registered block,
+    // also by the send transport with credits. The hello message carries the
+    // address of the first endpoint of the transmitter, which the receiver
+    // sends its control messages to. The receiver of the send transport
+    // takes the hello message in a frame buffer; its trailer is CTRL_SEQ
+    // instead of a frame sequence number.
+    enum class WriteCtrlType : uint32_t {
+        hello   = 1, // Transmitter announces itself, the receiver replies with the ring
+        ring    = 2, // Receiver describes the ring of slots
+        credits = 3, // Receiver returns the released slots or the posted receives
+    };
+
+    struct WriteCtrl {
+        uint32_t magic;
+        WriteCtrlType type;
+        uint64_t credits;   // Number of slots released or receives posted since the start
+        uint64_t addr;      // Remote address of the first slot
+        uint32_t slots;     // Number of slots in the ring
+        uint32_t slot_size; // Distance between slots
+        uint64_t keys[8];   // Ring registration key per endpoint
+        uint64_t received;  // Number of frames received since the start
+        uint32_t src_len;   // Length of the transmitter address
+        uint8_t src[64];    // Address of the first endpoint of the transmitter
+        uint64_t seq;       // CTRL_SEQ, in the place of the frame trailer
+    };
+
+    static constexpr uint32_t WRITE_CTRL_MAGIC = 0x4d435752;
+    static constexpr uint64_t CTRL_SEQ = UINT64_MAX;
+
+    // Immediate data of a write: the slot index in the low bits, and in the
+    // high bits the number of chunks of a frame written in segments, or 0
+    // for a frame written at once. A zero-length write with WRITE_SKIP set
+    // is the tombstone of a frame lost by the transmitter; its chunk count
+    // is the number of writes the slot sees, the tombstone included.
+    static constexpr uint32_t WRITE_SLOT_BITS = 20;
+    static constexpr uint32_t WRITE_SKIP = 1u << (WRITE_SLOT_BITS - 1);
+    static constexpr uint32_t WRITE_SLOT_MASK = WRITE_SKIP - 1;
+    static constexpr uint32_t WRITE_MAX_CHUNKS = (1u << (32 - WRITE_SLOT_BITS)) - 1;
+    static constexpr size_t WRITE_CTRL_RECVS = 4;
+    static constexpr size_t WRITE_CTRL_SENDS = 4;
+
+    bool rma_write = false;
+
+    WriteCtrl *ctrl_block = nullptr; // Receive messages, then send messages
+    struct fid_mr *ctrl_mr = nullptr;
+    void *ctrl_desc = nullptr;
+    uint32_t ctrl_next_send = 0;     // Accessed by the CQ thread only
+    uint32_t ctrl_sends_pending = 0; // Accessed by the CQ thread only
+
+    Result ctrl_init();
+    int ctrl_reg();
+    int ctrl_post_recvs();
+    void ctrl_cleanup();
+    bool is_ctrl(const void *ptr) const;
+    int ctrl_post_recv(WriteCtrl *msg);
+    int ctrl_send(WriteCtrlType type, const WriteCtrl& msg);
+    void ctrl_on_send_completion();
+    bool ctrl_set_peer(const WriteCtrl *msg);
+    size_t ring_slot_size() const;
 };
 
 } // namespace mesh::connection
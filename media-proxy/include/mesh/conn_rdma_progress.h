@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef CONN_RDMA_PROGRESS_H
+#define CONN_RDMA_PROGRESS_H
+
+#include "conn_worker.h"
+
+namespace mesh::connection {
+
+class Rdma;
+
+/**
+ * RdmaProgress
+ *
+ * Progress engine worker serving the completion queues of many RDMA
+ * connections. Connections attached to a worker start no threads of their
+ * own. The worker polls their completion queues, reposts receives,
+ * recycles transmit buffers and delivers received frames.
+ *
+ * The worker backs off while its connections are idle.
+ */
+class RdmaProgress : public ConnWorker<RdmaProgress, Rdma> {
+    friend class ConnWorker<RdmaProgress, Rdma>;
+
+    static constexpr const char *name = "RDMA progress";
+
+    RdmaProgress(int cpu) : ConnWorker(cpu) { start(); }
+
+    static const std::vector<int>& cpus();
+    uint32_t poll(Rdma *conn);
+    void idle(uint32_t work, int& idle_cycles);
+};
+
+} // namespace mesh::connection
+
+#endif // CONN_RDMA_PROGRESS_H
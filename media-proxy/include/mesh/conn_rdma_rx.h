@@ -20,18 +20,101 @@ public:
 
     // Configure the RDMA Receive session
     Result configure(context::Context& ctx, const mcm_conn_param& request,
-                     libfabric_ctx *& dev_handle);
+                     libfabric_ctx *& dev_handle,
+                     const RdmaOptions& options = {});
 
 protected:
     virtual Result start_threads(context::Context& ctx);
+    Result on_shutdown(context::Context& ctx) override;
+    void retire(std::function<void()> fn) override;
 
     // Receive data using RDMA
     void process_buffers_thread(context::Context& ctx);
     void rdma_cq_thread(context::Context& ctx);
+    uint32_t post_receives();
+    bool post_receive(void *buf);
+    int poll_cq(context::Context& ctx);
+    void on_hello(WriteCtrl *msg);
+    void grant_credits(bool idle);
+    void recycle_posted(void *buf) override;
+    void on_reconnect() override;
+    int poll(context::Context& ctx) override;
+    void collect(telemetry::Metric& metric, const int64_t& timestamp_ms) override;
     std::atomic<uint32_t> next_rx_idx;
-    static constexpr size_t REORDER_WINDOW = 256; // > max expected out-of-order
-    std::array<void *, REORDER_WINDOW> reorder_ring{{nullptr}};
-    uint64_t reorder_head = UINT64_MAX;
+
+    // Credits of the send transport. Every receive posted is granted to the
+    // transmitter as a credit. A receive completed in error takes its credit
+    // back, since it consumed no frame. The transmitter address is learned
+    // from its hello message, and the credits are sent to it on the first
+    // endpoint.
+    std::atomic<uint64_t> recvs_posted = 0;
+    uint64_t frames_received = 0;                    // CQ poller only
+    std::unique_ptr<std::atomic<uint8_t>[]> recv_ep; // Endpoint of the receive, by buffer
+
+    // Reorder window. Frames are delivered in sequence order. The window
+    // covers the receives posted on all endpoints. A missing frame is
+    // skipped and counted as lost when a later frame has waited for it
+    // longer than the reorder timeout, or when no posted receive is left
+    // to complete it. Frames arriving after their number has been skipped
+    // are dropped as late. Accessed by the CQ poller only.
+    struct ReorderEntry {
+        void *buf = nullptr;
+        uint32_t len = 0;   // payload length, excluding the trailer
+        int64_t ts = 0;     // arrival time
+    };
+    std::unique_ptr<ReorderEntry[]> reorder_ring;
+    uint64_t reorder_mask = 0;          // window size - 1
+    uint64_t reorder_head = UINT64_MAX; // next sequence number to deliver
+    uint64_t reorder_tail = 0;          // highest sequence number seen + 1
+    uint32_t reorder_pending = 0;       // frames waiting in the window
+    int64_t reorder_gap_ts = 0;         // arrival of the first waiting frame
+    int64_t reorder_timeout_ns = 0;
+
+    struct {
+        std::atomic<uint64_t> reordered; // arrived after a later frame
+        std::atomic<uint64_t> late;      // arrived after being skipped
+        std::atomic<uint64_t> skipped;   // never arrived in time
+    } reorder_stats = {};
+
+    Result reorder_init();
+    void reorder_insert(context::Context& ctx, void *buf, uint32_t len, uint64_t seq);
+    void reorder_expire(context::Context& ctx);
+    void reorder_update_gap();
+
+    // Handles of the received buffers passed to the linked connection.
+    // A buffer is reposted for receiving when its handle is released.
+    // The handles reach the receiver through rx_owner, which is cleared on
+    // shutdown. The pool frees rx_owner and the buffer memory after the
+    // last handle is released.
+    BufferPool *rx_pool = nullptr;
+    sync::DataplaneAtomicPtr *rx_owner = nullptr;
+
+    void flush_in_order(context::Context& ctx, uint64_t skip_to = 0);
+    void rx_close();
+    void shared_rx_drain();
+    Result recycle_buffer(void *buf);
+    static void on_rx_buffer_release(BufferHandle *buf);
+
+    // One-sided write transport. Slots written by the transmitter are
+    // delivered in ring order, and returned as credits in ring order once
+    // their handles are released. A slot written in segments is ready when
+    // all of its chunks have landed. A slot with a tombstone is ready when
+    // the writes it announces have landed, and is released undelivered.
+    std::unique_ptr<bool[]> slot_ready;                  // CQ thread only
+    std::unique_ptr<uint16_t[]> slot_chunks;             // CQ thread only
+    std::unique_ptr<uint16_t[]> slot_lost;               // CQ thread only
+    std::unique_ptr<std::atomic<bool>[]> slot_released;
+    uint64_t deliver_head = 0;   // Next slot to deliver
+    uint64_t release_head = 0;   // Next slot to return as a credit
+    uint64_t credits_sent = 0;   // Credits sent to the transmitter
+    bool peer_known = false;     // Transmitter address is known
+
+    void write_cq_thread(context::Context& ctx);
+    int write_poll_cq(context::Context& ctx);
+    void write_on_ctrl(WriteCtrl *msg);
+    void write_deliver(context::Context& ctx);
+    void write_return_credits(bool idle);
+    static void on_slot_release(BufferHandle *buf);
 };
 
 } // namespace mesh::connection
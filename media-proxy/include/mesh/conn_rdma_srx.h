@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef CONN_RDMA_SRX_H
+#define CONN_RDMA_SRX_H
+
+#include "libfabric_dev.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mesh::connection {
+
+struct RdmaSharedDomain;
+
+/**
+ * RdmaSharedRx
+ *
+ * Shared receive context of the RDMA receivers of one domain. Receivers
+ * with the same provider and local address share a domain, and receivers
+ * of the domain with frames of the same size class share a receive context
+ * and its pool of posted buffers. A frame completes on the completion queue
+ * of the endpoint it arrived on, so every receiver sees its own frames only.
+ *
+ * The pool grows in chunks while few receives are left posted, up to the
+ * sum of the queue sizes of the receivers, and is released when the last
+ * receiver detaches. The chunks are mapped and registered by a thread of
+ * the context, woken up by the CQ pollers, which only post buffers already
+ * registered. A receiver that returns a buffer reposts it to the shared
+ * context.
+ */
+class RdmaSharedRx {
+public:
+    // Attach a receiver to the context of its domain and size class.
+    // Returns the context, and in dev a device context of the domain bound
+    // to the local port of the receiver, or nullptr if the domain has no
+    // shared receive context.
+    static RdmaSharedRx * attach(const libfabric_ctx& want, size_t buf_size,
+                                 uint32_t queue_size, libfabric_ctx **dev);
+    void detach(libfabric_ctx *dev, uint32_t queue_size);
+
+    // Buffer size of the size class, at most a quarter larger than the size.
+    static size_t size_class(size_t size);
+
+    struct fid_ep *context() const { return srx; }
+
+    // A receive posted to the context has completed.
+    void consumed();
+
+    // Post the buffer of a completed receive again.
+    void repost(void *buf);
+
+    // No receive is posted.
+    bool starved() const { return !posted.load(std::memory_order_relaxed); }
+
+private:
+    RdmaSharedRx(RdmaSharedDomain *dom, size_t slot_size) : dom(dom), slot_size(slot_size) {}
+
+    static void release(RdmaSharedDomain *dom, RdmaSharedRx *srx);
+
+    bool open();
+    void close();
+    void grow_locked(uint32_t slots);
+    void grow_thread(std::stop_token stoken);
+    bool post_locked(void *buf);
+    void *desc_of(void *buf) const;
+
+    static constexpr uint32_t CHUNK_SLOTS = 8;
+
+    struct Chunk {
+        char *base;
+        size_t size;
+        struct fid_mr *mr;
+        void *desc;
+    };
+
+    bool chunk_alloc(uint32_t slots, Chunk& chunk);
+    void chunk_free(Chunk& chunk);
+    void chunk_add_locked(const Chunk& chunk, uint32_t slots);
+
+    RdmaSharedDomain *dom;
+    size_t slot_size;
+    struct fid_ep *srx = nullptr;
+    uint32_t depth = 0;          // Max receives posted to the context
+
+    std::mutex mx;
+    std::vector<Chunk> chunks;   // Sorted by address
+    std::vector<void *> spare;   // Buffers that failed to post
+    uint32_t users = 0;
+    uint64_t queued = 0;         // Sum of the queue sizes of the receivers
+    uint32_t fill = 0;           // Largest queue size of the receivers
+
+    std::atomic<uint32_t> posted = 0;
+    std::atomic<uint32_t> total = 0;
+    std::atomic<uint32_t> capacity = 0;  // Max buffers in the pool
+    std::atomic<uint32_t> grow_mark = 0; // Grow when fewer receives are posted
+
+    std::atomic<bool> grow_wanted = false; // A chunk is requested
+    std::mutex grow_mx;
+    std::condition_variable_any grow_cv;
+    std::jthread grow_th;
+};
+
+} // namespace mesh::connection
+
+#endif // CONN_RDMA_SRX_H
@@ -2,6 +2,7 @@
 #define RDMA_TX_H
 
 #include "conn_rdma.h"
+#include "mem_region.h"
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -13,23 +14,188 @@ namespace mesh::connection {
  *
  * Derived class for RDMA Transmit operations.
  */
-class RdmaTx : public Rdma {
+class RdmaTx : public Rdma, private MemoryRegionListener {
 public:
     RdmaTx();
     ~RdmaTx();
 
     // Configure the RDMA Transmit session
     Result configure(context::Context& ctx, const mcm_conn_param& request,
-                     libfabric_ctx *& dev_handle);
+                     libfabric_ctx *& dev_handle,
+                     const RdmaOptions& options = {});
 
     // Transmit data using RDMA when received from connection class
     Result on_receive(context::Context& ctx, void *ptr, uint32_t sz, uint32_t& sent);
+    Result on_receive(context::Context& ctx, BufferHandle *buf, uint32_t& sent) override;
+    Result on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                            uint32_t count, uint32_t& sent) override;
 
 protected:
     virtual Result start_threads(context::Context& ctx);
     void rdma_cq_thread(context::Context& ctx);
-    // one 64-bit counter shared by all RdmaTx
-    inline static std::atomic<uint64_t> global_seq{0};
+    int poll_cq(context::Context& ctx, bool drain = true);
+    int poll(context::Context& ctx) override;
+
+    // Polls the completion queue for a caller waiting for a buffer or a
+    // credit. The backlog is not sent, since the caller may hold the write
+    // or the backlog lock.
+    int poll_inline(context::Context& ctx);
+    void collect(telemetry::Metric& metric, const int64_t& timestamp_ms) override;
+
+    void on_send_completion(void *buf);
+
+    // Frames are dropped while the link is reconnecting
+    void link_drop(void **reg_bufs, uint32_t count);
+    void recycle_posted(void *buf) override;
+    void on_reconnect() override;
+    void on_cleanup() override;
+
+    // Striping across endpoints. Sends in flight are counted per endpoint,
+    // and the endpoint of a send is recorded by buffer slot.
+    uint32_t pick_endpoint(void **reg_bufs, uint32_t count);
+    void endpoint_release(void *reg_buf);
+    std::unique_ptr<std::atomic<uint32_t>[]> ep_outstanding;
+    std::unique_ptr<std::atomic<uint8_t>[]> send_ep;
+
+    Result acquire_buffer(context::Context& ctx, void **reg_buf);
+    Result acquire_buffer_inline(context::Context& ctx, void **reg_buf,
+                                 std::chrono::nanoseconds timeout);
+    Result send_buffer(context::Context& ctx, void *reg_buf, uint32_t to_send,
+                       uint32_t& sent);
+    uint32_t fill_buffer(void *reg_buf, void *ptr, uint32_t sz, uint64_t seq);
+    uint32_t used_size(const void *ptr, uint32_t sz) const;
+    void stamp_send(void *reg_buf);
+    size_t slot_of(void *reg_buf) const;
+
+    // Small frames. A frame that fits the inject size of the provider
+    // together with its trailer is copied to the stack and injected. It
+    // needs no registered buffer and generates no local completion.
+    size_t inject_max = 0;
+    std::atomic<uint64_t> injected{0};
+    Result send_inject(context::Context& ctx, void *ptr, uint32_t to_send, uint32_t& sent);
+
+    // Latency budget. Under 20 us, a burst is sent frame by frame, since
+    // the burst path holds its first frame until the last one is copied.
+    static constexpr uint32_t BURST_MIN_BUDGET_NS = 20000;
+    bool latency_tight = false;
+
+    Result send_zero_copy(context::Context& ctx, BufferHandle *buf,
+                          void **descs_by_rail, bool registered, uint32_t& sent);
+    bool zero_copy_find(const void *ptr, size_t sz, void **descs, bool& registered);
+    void zero_copy_release(void *reg_buf);
+    void zero_copy_cleanup();
+
+    // Send timestamps indexed by buffer slot, to measure the time from
+    // posting a send to its completion.
+    std::unique_ptr<std::atomic<int64_t>[]> send_ts;
+    size_t send_slot_size = 0;
+    telemetry::Histogram send_ns;
+
+    // Zero-copy transmission. Ingress buffers are sent from the memory
+    // regions they point into. The regions are registered with every rail
+    // when they are added to the registry, or when the connection is
+    // established, and the data plane looks them up in a snapshot.
+    // A registered buffer carries the trailer, and its slot holds the handle
+    // of the ingress buffer until the send completes.
+    struct ZeroCopyRegion {
+        MemoryRegion region;
+        struct fid_mr *mr[RDMA_MAX_EPS]; // Indexed by rail
+        void *desc[RDMA_MAX_EPS];
+    };
+    using ZeroCopyRegions = std::vector<ZeroCopyRegion>;
+    void on_region_add(const MemoryRegion& region) override;
+    void on_region_remove(const MemoryRegion& region) override;
+    void zero_copy_publish(ZeroCopyRegions *regions);
+    void zero_copy_unreg(ZeroCopyRegion& r);
+    bool zero_copy = false;
+    bool zc_subscribed = false;
+    sync::DataplaneAtomicPtr zc_regions; // ZeroCopyRegions snapshot
+    std::mutex zc_mx;                    // Serializes snapshot updates
+    std::unique_ptr<std::atomic<BufferHandle *>[]> zc_handles;
+
+    // One-sided write transport. Frames are written to the slots of the
+    // receiver ring in order. A slot is written only when the receiver has
+    // returned it as a credit.
+    struct {
+        uint64_t addr;
+        uint32_t slots;
+        uint32_t slot_size;
+        uint64_t keys[8];
+    } ring = {};
+    std::atomic<bool> ring_ready = false;
+    std::atomic<uint64_t> write_credits = 0; // Slots released by the receiver
+    std::atomic<uint64_t> write_head = 0;    // Next slot to write
+    std::mutex write_mx;                     // Keeps slots written in order
+    std::chrono::steady_clock::time_point hello_ts; // CQ poller only
+    bool hello_answered = false;                    // CQ poller only
+
+    void hello_poll();
+    void write_cq_thread(context::Context& ctx);
+    int write_poll_cq(context::Context& ctx, bool drain = true);
+    void write_on_ctrl(WriteCtrl *msg);
+    uint32_t fill_slot(void *reg_buf, void *ptr, uint32_t sz);
+    int write_slot(context::Context& ctx, uint32_t idx, void *reg_buf, uint32_t len);
+    int write_slotv(context::Context& ctx, uint32_t idx, const struct iovec *iov,
+                    size_t count, void *reg_buf, void **region_descs);
+    void *write_desc(const void *ptr, uint32_t idx, void **region_descs) const;
+    void write_release(void *reg_buf);
+
+    // Segmented writes. A frame larger than the segment size is written to
+    // its slot in chunks, chunk k on endpoint (idx + k) % endpoints, each
+    // with its own immediate data. The context of chunk k is the buffer
+    // address plus k, and the buffer is returned once all chunks complete.
+    // A frame with chunks not posted or failed leaves a tombstone in its
+    // slot once the others complete.
+    struct WriteFrame {
+        std::atomic<uint16_t> pending; // Chunks in flight
+        std::atomic<uint16_t> lost;    // Chunks not written
+        uint16_t chunks;               // Chunks of the frame
+        uint32_t slot;                 // Slot of the receiver ring
+    };
+
+    uint32_t segment_size = 0;
+    std::unique_ptr<WriteFrame[]> write_frames; // Frames in flight by buffer slot
+
+    int write_segments(uint32_t idx, const struct iovec *iov, size_t count,
+                       void *reg_buf, void **region_descs, uint32_t slot, uint64_t addr);
+    void write_tombstone(uint32_t idx, uint32_t slot, uint32_t landed);
+    void *write_complete(void *op_ctx, bool failed = false);
+
+    // Flow control. With the send transport, the receiver grants one credit
+    // per receive posted, and the transmitter is unlimited until the first
+    // grant arrives. With the write transport, the credits are the free
+    // slots of the receiver ring. Without a credit, a frame is held for up
+    // to 1 second (block), dropped (drop-newest), or copied to a registered
+    // buffer and kept in a backlog sent in order as credits arrive, the
+    // oldest frame being dropped when the backlog is full (drop-oldest).
+    std::atomic<bool> credits_known = false;
+    std::atomic<uint64_t> credits_granted = 0; // Receives posted by the receiver
+    std::atomic<uint64_t> credits_used = 0;    // Frames sent
+    std::atomic<uint64_t> flow_dropped = 0;
+
+    struct BacklogEntry {
+        void *reg_buf;
+        uint32_t len;   // payload length, excluding the trailer
+    };
+    std::unique_ptr<BacklogEntry[]> backlog;
+    uint32_t backlog_cap = 0;
+    uint32_t backlog_head = 0;              // Oldest frame, under backlog_mx
+    std::atomic<uint32_t> backlog_len = 0;  // Modified under backlog_mx
+    std::mutex backlog_mx;
+
+    uint64_t credits_available() const;
+    void credits_take(uint32_t count);
+    Result credits_wait(context::Context& ctx);
+    Result flow_admit(context::Context& ctx, void *ptr, uint32_t sz, uint32_t& sent,
+                      bool& handled);
+    Result backlog_push(context::Context& ctx, void *ptr, uint32_t sz, uint32_t& sent);
+    void backlog_drain(context::Context& ctx);
+    void flow_drain(context::Context& ctx);
+
+    // Sequence number of the next frame. Numbers are contiguous per
+    // connection, so the receiver treats every gap as a reordered or
+    // lost frame.
+    std::atomic<uint64_t> tx_seq{0};
     std::atomic<uint32_t> next_tx_idx;
 };
 
@@ -0,0 +1,223 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef CONN_WORKER_H
+#define CONN_WORKER_H
+
+#include "logger.h"
+#include "sync.h"
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+
+namespace mesh::connection {
+
+/**
+ * ConnWorker
+ *
+ * Pool of worker threads polling many connections of one kind. Workers
+ * are created on first use, one per configured CPU core, and connections
+ * are assigned to the least loaded one. The thread is pinned to its core
+ * and sleeps while it has no connections to serve.
+ *
+ * The derived class provides:
+ *   static constexpr const char *name;             // Name used in logs
+ *   static const std::vector<int>& cpus();         // Cores of the workers
+ *   uint32_t poll(Conn *conn);                     // One pass, returns the work done
+ *   void idle(uint32_t work, int& idle_cycles);    // Called after every pass
+ * and calls start() from its constructor.
+ */
+template <typename Worker, typename Conn>
+class ConnWorker {
+public:
+    static Worker * attach(Conn *conn);
+    void detach(Conn *conn);
+
+    // Worker running on the calling thread, or nullptr.
+    static Worker * current() { return current_worker; }
+
+    int cpu() const { return core; }
+
+protected:
+    ConnWorker(int cpu) : core(cpu) {}
+
+    void start();
+
+private:
+    void update_hotpath();
+    void run(std::stop_token stoken);
+
+    int core;
+    std::list<Conn *> conns;
+    std::mutex conns_mx;
+    std::condition_variable_any conns_cv;
+
+    // Snapshot of the connections used by the worker thread.
+    sync::DataplaneAtomicPtr conns_ptr;
+
+    std::jthread th;
+
+    // Workers live until the process exits.
+    static inline std::vector<Worker *> workers;
+    static inline std::mutex workers_mx;
+    static inline thread_local Worker *current_worker = nullptr;
+};
+
+template <typename Worker, typename Conn>
+void ConnWorker<Worker, Conn>::start()
+{
+    th = std::jthread([this](std::stop_token stoken) { run(stoken); });
+}
+
+/**
+ * Attach the connection to the least loaded worker. Workers are started
+ * on first use. Returns nullptr if no worker could be started.
+ */
+template <typename Worker, typename Conn>
+Worker * ConnWorker<Worker, Conn>::attach(Conn *conn)
+{
+    Worker *worker = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(workers_mx);
+
+        if (workers.empty()) {
+            auto& cpus = Worker::cpus();
+
+            try {
+                if (cpus.empty())
+                    workers.emplace_back(new Worker(-1));
+                else
+                    for (auto cpu : cpus)
+                        workers.emplace_back(new Worker(cpu));
+            }
+            catch (const std::system_error& e) {
+                log::error("%s thread create failed", Worker::name)("error", e.what());
+            }
+
+            if (workers.empty())
+                return nullptr;
+        }
+
+        size_t min_conns = SIZE_MAX;
+
+        for (auto w : workers) {
+            std::lock_guard<std::mutex> lk(w->conns_mx);
+
+            if (w->conns.size() < min_conns) {
+                min_conns = w->conns.size();
+                worker = w;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(worker->conns_mx);
+
+        worker->conns.push_back(conn);
+        worker->update_hotpath();
+    }
+
+    worker->conns_cv.notify_all();
+
+    return worker;
+}
+
+/**
+ * Detach the connection from the worker. Returns after the worker thread
+ * stops referring to the connection. Must not be called by the worker.
+ */
+template <typename Worker, typename Conn>
+void ConnWorker<Worker, Conn>::detach(Conn *conn)
+{
+    {
+        std::lock_guard<std::mutex> lk(conns_mx);
+
+        conns.remove(conn);
+        update_hotpath();
+    }
+
+    conns_ptr.synchronize();
+}
+
+/**
+ * Publish a new snapshot of the connections to the worker thread.
+ * Must be called with the connections list locked.
+ */
+template <typename Worker, typename Conn>
+void ConnWorker<Worker, Conn>::update_hotpath()
+{
+    std::vector<Conn *> *snapshot = nullptr;
+
+    if (!conns.empty())
+        snapshot = new std::vector<Conn *>(conns.begin(), conns.end());
+
+    auto prev = static_cast<std::vector<Conn *> *>(conns_ptr.store(snapshot));
+    if (prev)
+        conns_ptr.retire([prev]() { delete prev; });
+}
+
+template <typename Worker, typename Conn>
+void ConnWorker<Worker, Conn>::run(std::stop_token stoken)
+{
+    if (core >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(core, &cpuset);
+
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        if (err)
+            log::warn("%s: can't pin thread to CPU core", Worker::name)
+                     ("cpu", core)("error", err);
+    }
+
+    auto self = static_cast<Worker *>(this);
+    current_worker = self;
+
+    log::info("%s worker started", Worker::name)("cpu", core);
+
+    int idle_cycles = 0;
+
+    while (!stoken.stop_requested()) {
+        // WARNING: This is the hot path of Data Plane.
+        // Avoid any unnecessary operations that can increase latency.
+
+        uint32_t work = 0;
+        size_t polled = 0;
+
+        // Every connection is polled in a critical section of its own, so
+        // a detach waits for the poll of a single connection, not for the
+        // whole pass. A connection attached or detached meanwhile may shift
+        // the others, which are then polled once more or one pass later.
+        for (;; polled++) {
+            auto snapshot = static_cast<std::vector<Conn *> *>(conns_ptr.load_next_lock());
+
+            if (!snapshot || polled >= snapshot->size()) {
+                conns_ptr.unlock();
+                break;
+            }
+
+            work += self->poll((*snapshot)[polled]);
+
+            conns_ptr.unlock();
+        }
+
+        if (!polled) {
+            // Sleep while there are no connections to serve.
+            std::unique_lock<std::mutex> lk(conns_mx);
+            conns_cv.wait(lk, stoken, [this]() { return !conns.empty(); });
+            continue;
+        }
+
+        self->idle(work, idle_cycles);
+    }
+}
+
+} // namespace mesh::connection
+
+#endif // CONN_WORKER_H
@@ -18,6 +18,7 @@ class LocalManager {
 public:
     int create_connection_sdk(context::Context& ctx, std::string& id,
                               mcm_conn_param *param, memif_conn_param *memif_param,
+                              std::string& relay_region_path,
                               const Config& conn_config, std::string& err_str);
 
     int activate_connection_sdk(context::Context& ctx, const std::string& id);
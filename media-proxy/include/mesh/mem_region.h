@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef MEM_REGION_H
+#define MEM_REGION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh::connection {
+
+/**
+ * MemoryRegion
+ *
+ * Shared memory region that ingress buffers point into, e.g. a memif
+ * region mapped by a local connection.
+ */
+class MemoryRegion {
+public:
+    uint64_t id;
+    void *addr;
+    size_t size;
+
+    bool contains(const void *ptr, size_t sz) const {
+        auto p = (const uint8_t *)ptr;
+        return p >= (const uint8_t *)addr && p + sz <= (const uint8_t *)addr + size;
+    }
+};
+
+/**
+ * MemoryRegionListener
+ *
+ * Told about the regions added to and removed from the registry, e.g. to
+ * register them with a NIC before any buffer pointing into them is sent.
+ * Called with the registry locked, in the control plane or by the thread
+ * releasing the last buffer handle of a region.
+ */
+class MemoryRegionListener {
+public:
+    virtual ~MemoryRegionListener() = default;
+
+    virtual void on_region_add(const MemoryRegion& region) = 0;
+    virtual void on_region_remove(const MemoryRegion& region) = 0;
+};
+
+/**
+ * MemoryRegions
+ *
+ * Registry of shared memory regions. Transports that can send from
+ * registered memory, e.g. RDMA, subscribe to the registry and register
+ * the regions ahead of the data plane, so buffers pointing into a region
+ * are sent without copying. Every region gets a unique id, so a region
+ * mapped later at the same address is never mistaken for a removed one.
+ * The owner of a region removes it before unmapping, after all buffer
+ * handles pointing into the region have been released.
+ */
+class MemoryRegions {
+public:
+    static uint64_t add(void *addr, size_t size);
+    static void remove(uint64_t id);
+
+    // The listener is told about the regions added before subscribing.
+    static void subscribe(MemoryRegionListener *listener);
+    static void unsubscribe(MemoryRegionListener *listener);
+};
+
+} // namespace mesh::connection
+
+#endif // MEM_REGION_H
@@ -7,6 +7,9 @@
 #ifndef METRICS_H
 #define METRICS_H
 
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <vector>
 #include <string>
 #include <variant>
@@ -75,6 +78,166 @@ protected:
     friend class MetricsCollector;
 };
 
+/**
+ * Counter shards
+ *
+ * Every thread updating sharded counters is assigned its own shard index on
+ * first use. The index is recycled when the thread exits. Threads beyond
+ * the limit share the overflow shard counter_shards_max.
+ */
+constexpr uint32_t counter_shards_max = 64;
+
+extern thread_local uint32_t counter_shard_id;
+uint32_t counter_shard_acquire();
+
+inline uint32_t counter_shard() {
+    auto id = counter_shard_id;
+    if (id == UINT32_MAX) [[unlikely]]
+        id = counter_shard_acquire();
+    return id;
+}
+
+/**
+ * ShardedCounters
+ *
+ * Set of N counters updated on the data plane hot path. Every thread
+ * writes to its own cache-line-padded shard with plain relaxed stores, so
+ * threads updating the same counters do not bounce cache lines. Readers
+ * aggregate the shards.
+ */
+template<size_t N>
+class ShardedCounters {
+public:
+    ShardedCounters() : shards(new Shard[counter_shards_max + 1]) {}
+
+    void add(size_t idx, uint64_t value) {
+        auto shard = counter_shard();
+        auto& v = shards[shard].values[idx];
+
+        if (shard < counter_shards_max) [[likely]]
+            v.store(v.load(std::memory_order_relaxed) + value,
+                    std::memory_order_relaxed);
+        else
+            v.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t load(size_t idx) const {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i <= counter_shards_max; i++)
+            sum += shards[i].values[idx].load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> values[N] = {};
+    };
+
+    std::unique_ptr<Shard[]> shards;
+};
+
+/**
+ * ShardedCounter
+ *
+ * Accessor to one counter of a ShardedCounters set, which keeps the syntax
+ * of an atomic integer counter.
+ */
+template<size_t N>
+class ShardedCounter {
+public:
+    ShardedCounter(ShardedCounters<N>& set, size_t idx) : set(set), idx(idx) {}
+
+    ShardedCounter& operator+=(uint64_t value) {
+        set.add(idx, value);
+        return *this;
+    }
+    void operator++() { set.add(idx, 1); }
+    void operator++(int) { set.add(idx, 1); }
+
+    operator uint64_t() const { return set.load(idx); }
+
+private:
+    ShardedCounters<N>& set;
+    size_t idx;
+};
+
+/**
+ * Monotonic clock in nanoseconds used for latency measurements
+ */
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Wall clock in nanoseconds used for timestamps compared across hosts
+ */
+inline int64_t realtime_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Histogram
+ *
+ * Fixed-bucket log-linear histogram of nanosecond values, in the spirit of
+ * HdrHistogram. Values are grouped by powers of two, and every group is
+ * split into 2^sub_bits linear sub-buckets, which bounds the relative error
+ * of reported percentiles by 1/2^sub_bits. Values above 2^max_exp ns
+ * (~18 minutes) fall into the last bucket.
+ *
+ * Recording is a relaxed atomic increment plus a rare max update, which is
+ * cheap enough for the data plane hot path and safe for several writers.
+ * Percentiles are computed by the metrics collector, which resets the
+ * histogram on every collection, so the values cover the last interval.
+ */
+class Histogram {
+public:
+    static constexpr uint32_t sub_bits = 5;
+    static constexpr uint32_t sub_count = 1 << sub_bits;
+    static constexpr uint32_t max_exp = 40;
+    static constexpr uint32_t bucket_count = (max_exp - sub_bits + 1) * sub_count;
+
+    void record(int64_t value_ns) {
+        uint64_t v = value_ns > 0 ? value_ns : 0;
+
+        buckets[bucket_index(v)].fetch_add(1, std::memory_order_relaxed);
+
+        auto prev_max = max.load(std::memory_order_relaxed);
+        while (v > prev_max &&
+               !max.compare_exchange_weak(prev_max, v, std::memory_order_relaxed));
+    }
+
+    static uint32_t bucket_index(uint64_t v) {
+        if (v < sub_count)
+            return v;
+
+        uint32_t exp = 63 - __builtin_clzll(v);
+        if (exp >= max_exp)
+            return bucket_count - 1;
+
+        uint32_t top = v >> (exp - sub_bits);
+        return (exp - sub_bits + 1) * sub_count + (top - sub_count);
+    }
+
+    static uint64_t bucket_value(uint32_t idx);
+
+    struct Summary {
+        uint64_t count;
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
+    };
+
+    Summary collect_reset();
+    void export_fields(Metric& metric, const std::string& prefix);
+
+private:
+    std::atomic<uint64_t> buckets[bucket_count] = {};
+    std::atomic<uint64_t> max = 0;
+};
+
 } // namespace mesh::telemetry
 
 #endif // METRICS_H
@@ -3,11 +3,20 @@
 
 #include "conn.h"
 #include <list>
+#include <vector>
 
 namespace mesh::multipoint {
 
 using namespace mesh::connection;
 
+/**
+ * Policy applied by a group output when its queue is full
+ */
+enum class DropPolicy {
+    drop_oldest, // evict the oldest queued frame to make room for the new one
+    drop_newest, // reject the new frame
+};
+
 class Group : public Connection {
 
 public:
@@ -21,10 +30,10 @@ public:
 
     Result assign_input(context::Context& ctx, Connection *input);
     Result add_output(context::Context& ctx, Connection *output);
+    Result add_output(context::Context& ctx, Connection *output,
+                      DropPolicy policy);
 
-    void delete_all_outputs() {
-        outputs.clear();
-    }
+    void delete_all_outputs();
 
     int outputs_num() {
         return outputs.size();
@@ -34,18 +43,74 @@ private:
     Result on_establish(context::Context& ctx) override;
     Result on_receive(context::Context& ctx, void *ptr, uint32_t sz,
                       uint32_t& sent) override;
+    Result on_receive(context::Context& ctx, BufferHandle *buf,
+                      uint32_t& sent) override;
+    Result on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                            uint32_t count, uint32_t& sent) override;
     Result on_shutdown(context::Context& ctx) override;
     void on_delete(context::Context& ctx) override;
 
-private:
-    std::list<Connection *> outputs;
+    Result fan_out(context::Context& ctx, void *ptr, uint32_t sz,
+                   BufferHandle *buf, uint32_t& sent);
+
+    /**
+     * Output
+     *
+     * Group output. In the parallel dispatch mode, the output connection
+     * is served by a dedicated worker thread fed from a bounded queue of
+     * buffer handles, so a slow output does not stall the ingress thread
+     * and other outputs of the group.
+     */
+    class Output {
+    public:
+        Output(Group *group, Connection *conn) : conn(conn), group(group) {}
+        ~Output();
+
+        Result start(size_t queue_depth, DropPolicy policy);
+        void dispatch(BufferHandle *buf);
+
+        bool is_parallel() const { return queue != nullptr; }
+
+        Connection *conn;
+
+    private:
+        void worker(context::Context& ctx);
+
+        Group *group;
+        DropPolicy policy = DropPolicy::drop_oldest;
+        std::unique_ptr<thread::Channel<BufferHandle *>> queue;
+        context::Context worker_ctx;
+        std::jthread th;
+        std::atomic<uint64_t> dropped = 0;
+    };
+
+    /**
+     * Immutable snapshot of the outputs used by the data plane, published
+     * as a contiguous array and reclaimed after an epoch grace period.
+     * In the parallel dispatch mode, the pool provides buffers to copy frames
+     * that do not arrive as buffer handles, and ingress ring slots, which
+     * must not wait in the output queues. The pool is shared by successive
+     * snapshots until it needs to grow.
+     */
+    struct Hotpath {
+        std::vector<Output *> outputs;
+        BufferPool *pool = nullptr;
+        uint32_t pool_capacity = 0;
+    };
+
+    std::list<Output *> outputs;
     std::mutex outputs_mx;
 
     sync::DataplaneAtomicPtr outputs_ptr;
 
-    std::list<Connection *> * get_hotpath_outputs_lock();
-    void hotpath_outputs_unlock();
-    void set_hotpath_outputs(std::list<Connection *> *new_outputs);
+    BufferPartitions input_parts = {};
+
+    Hotpath * get_hotpath_lock();
+    void hotpath_unlock();
+    void update_hotpath(bool clear = false);
+    BufferPool * hotpath_pool(Hotpath *prev, uint32_t& capacity);
+    static BufferHandle * hotpath_copy(Hotpath *hotpath, void *ptr, uint32_t sz,
+                                       BufferHandle *buf);
 };
 
 } // namespace mesh::multipoint
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace mesh::config {
 
@@ -25,9 +26,39 @@ public:
     struct {
         std::string dataplane_ip_addr;
         std::string dataplane_local_ports;
+        bool zero_copy_tx;
+        bool progress_engine;
+        std::vector<int> progress_cpus; // one progress worker per core
+        uint32_t reorder_timeout_us;    // max wait for a missing frame
+        size_t hugepage_size;           // buffer pool page size, 0 for regular pages
+        bool shared_rx;                 // receivers share receive buffers per domain
     } rdma = {
         .dataplane_ip_addr = "192.168.96.2",
         .dataplane_local_ports = "9100-9999",
+        .zero_copy_tx = false,
+        .progress_engine = false,
+        .reorder_timeout_us = 5000,
+        .hugepage_size = 0,
+        .shared_rx = false,
+    };
+
+    struct {
+        bool zero_copy_relay;
+        bool busy_poll;
+        std::vector<int> busy_poll_cpus; // one poller thread per core
+    } local = {
+        .zero_copy_relay = false,
+        .busy_poll = false,
+    };
+
+    struct {
+        bool parallel_fanout;
+        uint32_t fanout_queue_depth;
+        bool fanout_drop_oldest;
+    } multipoint = {
+        .parallel_fanout = false,
+        .fanout_queue_depth = 4,
+        .fanout_drop_oldest = true,
     };
 
     uint16_t sdk_api_port = 8002;
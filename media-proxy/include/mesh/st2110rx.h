@@ -99,7 +99,7 @@ class ST2110Rx : public ST2110<FRAME, HANDLE, OPS> {
         auto sysdata = (BufferSysData *)(buf + this->config.buf_parts.sysdata.offset);
         auto payload_ptr = (void *)(buf + this->config.buf_parts.payload.offset);
 
-        sysdata->timestamp_ms = 0;
+        sysdata->timestamp_ns = 0;
         sysdata->seq = 0;
         sysdata->payload_len = this->transfer_size;
         sysdata->metadata_len = 0;
@@ -110,6 +110,9 @@ class ST2110Rx : public ST2110<FRAME, HANDLE, OPS> {
             if (frame_ptr) {
                 std::memcpy(payload_ptr, get_frame_data_ptr(frame_ptr), this->transfer_size);
 
+                sysdata->timestamp_ns = telemetry::realtime_ns();
+                sysdata->seq++;
+
                 // Forward buffer to emulated receiver
                 this->transmit(this->_ctx, buf, buf_sz);
                 // Return used buffer to MTL
@@ -8,40 +8,141 @@
 #define SYNC_H
 
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "concurrency.h"
 
 namespace mesh::sync {
 
+/**
+ * EpochDomain
+ *
+ * Epoch-based (RCU-like) memory reclamation within one domain of readers,
+ * e.g. the readers of one shared pointer. Any number of threads can enter
+ * read-side critical sections concurrently. Critical sections can be nested,
+ * also across domains, and are left in the reverse order. A writer waits
+ * only for the readers of its own domain, so a reader blocked in one domain
+ * does not stall the writers of the others.
+ *
+ * A reader entering the critical section counts itself in one of the two
+ * reader counters of the domain, selected by the current phase, and leaves
+ * the same counter on exit. A grace period flips the phase twice, each time
+ * after the counter of the previous phase has drained, so all readers that
+ * were in critical sections when it started have left. The counters are
+ * sharded per thread like the telemetry counters, so readers on different
+ * threads do not bounce a shared cache line.
+ *
+ * A writer replaces a shared pointer, then either retires the old object
+ * with a deleter, or calls synchronize() to wait for a grace period.
+ * A retired object is deleted after a grace period by one of the next
+ * calls to retire(), reclaim() or synchronize(), so the writer does not
+ * wait. Objects still retired are deleted with the domain.
+ *
+ * Readers must not call synchronize() of their domain, which would never
+ * return.
+ */
+class EpochDomain {
+public:
+    EpochDomain();
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+    ~EpochDomain();
+
+    void enter();
+    void leave();
+
+    void retire(std::function<void()> deleter);
+    void synchronize();
+    void reclaim();
+
+private:
+    struct Retired {
+        uint64_t grace; // Grace periods to complete before the deletion
+        std::function<void()> deleter;
+    };
+
+    // Reader counters of both phases, written by the threads of one
+    // counter shard.
+    struct alignas(64) ReaderShard {
+        std::atomic<uint64_t> readers[2] = {};
+    };
+
+    bool advance();
+
+    std::unique_ptr<ReaderShard[]> shards;
+    alignas(64) std::atomic<uint32_t> phase = 0;
+    std::atomic<uint64_t> flips = 0;
+    std::vector<Retired> retired;
+    std::mutex mx;
+};
+
+/**
+ * Epoch
+ *
+ * Process-wide epoch domain, for readers that are not tied to a shared
+ * pointer of their own. The data plane uses the domain of every
+ * DataplaneAtomicPtr instead.
+ *
+ * Example:
+ *
+ * // Hotpath (one or many threads)
+ * sync::Epoch::enter();
+ * auto ptr = my_ptr.load(std::memory_order_acquire);
+ * ...
+ * sync::Epoch::leave();
+ *
+ * // Regular thread (one or many)
+ * auto old = my_ptr.exchange(new_ptr, std::memory_order_acq_rel);
+ * sync::Epoch::retire([old]() { delete old; });
+ */
+class Epoch {
+public:
+    static void enter();
+    static void leave();
+
+    static void retire(std::function<void()> deleter);
+    static void synchronize();
+    static void reclaim();
+};
+
 /**
  * DataplaneAtomicPtr
  * 
  * Custom atomic lock-free class to store a void memory pointer designed to
  * support prioritized access levels:
  *   - Hotpath access    Method(s): load_next_lock(), unlock()
- *   - Regular access    Method(s): load(), store_wait()
+ *   - Regular access    Method(s): load(), store(), store_wait()
  *
  * The hotpath access is the fastest possible lock-free approach to read
  * the memory pointer value. It is meant to be used in interrupts and callbacks
  * that happen when a new block of data appears on the network. The critical
  * section begins with an invokation of the load_next_lock() method that returns
- * the pointer value and locks the write access. To exit the critical section,
- * the unlock() method must be called, which unlocks the write access.
- * 
- * The hotpath access must be used in only one thread. Multiple threads calling
- * load_next_lock() and/or lock() will lead to undetermined behavior. 
+ * the pointer value and enters the read-side critical section of the epoch
+ * domain of the instance, so the writers of other instances never wait for
+ * a reader of this one. To exit
+ * the critical section, the unlock() method must be called. The hotpath access
+ * can be used in any number of threads concurrently.
  * 
- * The regular access is a normal mutex-protected way to read and write the
- * pointer value. The store_wait() method is used to write a new value to the
- * class instance. It blocks infinitely until the hotpath unlocks the write
- * access. The load() method returns the 64-bit value. Both methods can be
- * called from multiple threads.
+ * The regular access is a mutex-protected way to read and write the pointer
+ * value. The store_wait() method is used to write a new value to the class
+ * instance. It blocks until all hotpath critical sections that could have
+ * seen the previous value are exited, after which the previous value can be
+ * safely deleted. The store() method writes a new value without waiting,
+ * and the previous value is supposed to be retired via retire(). Objects
+ * reachable from the value, e.g. items of a snapshot, are retired or waited
+ * for the same way via retire() and synchronize().
+ * The load() method returns the last value written by a completed store.
+ * All methods can be called from multiple threads.
  * 
  * Example:
  * 
  * // Declaration
  * sync::DataplaneAtomicPtr myclass_ptr;
  * 
- * // Hotpath (single dedicated thread)
+ * // Hotpath (one or many threads)
  * ...
  * auto ptr = (MyClass *)myclass_ptr.load_next_lock();
  * if (ptr)
@@ -60,17 +161,69 @@ namespace mesh::sync {
 class DataplaneAtomicPtr {
     public:
         void * load();
+        void * store(void *new_ptr);
         void store_wait(void *new_ptr);
 
         void * load_next_lock();
         void unlock();
 
+        void retire(std::function<void()> deleter) { epoch.retire(std::move(deleter)); }
+        void synchronize() { epoch.synchronize(); }
+
     private:
-        std::atomic<uint64_t> current = 0;
-        std::atomic<uint64_t> next = 0;
+        std::atomic<void *> current = nullptr;   // value seen by the hotpath
+        std::atomic<void *> committed = nullptr; // value returned by load()
         std::mutex mx;
+        EpochDomain epoch;
     };
-    
+
+/**
+ * Ring
+ *
+ * Bounded lock-free multi-producer multi-consumer ring of pointers, e.g. of
+ * pre-registered buffers. Every cell carries a sequence number, so producers
+ * and consumers contend only on their own position, and an uncontended
+ * push() or pop() costs a single compare-and-swap.
+ *
+ * A consumer finding the ring empty can block in pop_wait() until a pointer
+ * is pushed, the timeout expires or the context is cancelled. Consumers
+ * sleep on a futex. Producers make the wake-up syscall only when there are
+ * sleeping consumers.
+ *
+ * The capacity is rounded up to a power of two. init() must not be called
+ * concurrently with other methods.
+ */
+class Ring {
+public:
+    explicit Ring(size_t capacity = 0);
+
+    bool init(size_t capacity);
+    bool push(void *ptr);
+    bool pop(void *& ptr);
+    bool pop_wait(context::Context& ctx, void *& ptr,
+                  std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max());
+
+    size_t size() const;
+    bool empty() const { return !size(); }
+    size_t capacity() const { return cells ? mask + 1 : 0; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        void *ptr;
+    };
+
+    void wake(int count);
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+
+    alignas(64) std::atomic<size_t> enqueue_pos = 0;
+    alignas(64) std::atomic<size_t> dequeue_pos = 0;
+    alignas(64) std::atomic<uint32_t> wake_seq = 0; // Futex word
+    std::atomic<uint32_t> waiters = 0;
+};
+
 } // namespace mesh::sync
 
 #endif // SYNC_H
@@ -57,6 +57,17 @@ int memif_buffer_alloc_timeout(memif_conn_handle_t conn, uint16_t qid,
                                memif_buffer_t * bufs, uint16_t count, uint16_t * count_out,
                                uint32_t size, uint32_t timeout_ms);
 
+/* Point the descriptor of an allocated tx buffer at an arbitrary slot of
+ * the buffer region. Used by the zero-copy relay to hand a slot received on
+ * one interface to another interface sharing the same region. */
+int memif_buffer_set_offset(memif_conn_handle_t conn, uint16_t qid,
+                            memif_buffer_t *buf, uint32_t offset);
+
+/* Get the index of the first tx descriptor not yet returned by the peer.
+ * All descriptors preceding the index have been consumed and refilled. */
+int memif_get_tx_released(memif_conn_handle_t conn, uint16_t qid,
+                          uint16_t *released);
+
 #ifdef __cplusplus
 }
 #endif
@@ -206,9 +206,13 @@ int rdma_cq_readerr(struct fid_cq *cq)
 
 int rdma_cq_open(ep_ctx_t *ep_ctx, size_t cq_size, enum cq_comp_method comp_method)
 {
-    struct fi_cq_attr cq_attr = {.wait_obj = FI_WAIT_NONE, .format = FI_CQ_FORMAT_CONTEXT};
+    /* Completions carry the length of received messages, and the immediate
+     * data of remote writes. */
+    struct fi_cq_attr cq_attr = {.wait_obj = FI_WAIT_NONE, .format = FI_CQ_FORMAT_DATA};
     int err;
 
+    ep_ctx->cq_ctx.cq_fd = -1;
+
     rdma_cq_set_wait_attr(&cq_attr, comp_method, NULL);
     if (cq_size)
         cq_attr.size = cq_size;
@@ -216,6 +220,11 @@ int rdma_cq_open(ep_ctx_t *ep_ctx, size_t cq_size, enum cq_comp_method comp_meth
         cq_attr.size = ep_ctx->rdma_ctx->info->tx_attr->size;
 
     err = fi_cq_open(ep_ctx->rdma_ctx->domain, &cq_attr, &ep_ctx->cq_ctx.cq, ep_ctx);
+    if (err && comp_method == RDMA_COMP_WAIT_FD) {
+        /* Not every provider has a file descriptor wait object. */
+        RDMA_WARN("CQ fd wait not supported, falling back to sread");
+        return rdma_cq_open(ep_ctx, cq_size, RDMA_COMP_SREAD);
+    }
     if (err) {
         RDMA_PRINTERR("fi_cq_open", err);
         return err;
@@ -223,8 +232,13 @@ int rdma_cq_open(ep_ctx_t *ep_ctx, size_t cq_size, enum cq_comp_method comp_meth
 
     if (comp_method == RDMA_COMP_WAIT_FD) {
         err = fi_control(&ep_ctx->cq_ctx.cq->fid, FI_GETWAIT, &ep_ctx->cq_ctx.cq_fd);
-        if (err)
+        if (err) {
             RDMA_PRINTERR("fi_control(FI_GETWAIT)", err);
+            RDMA_WARN("CQ fd wait not supported, falling back to sread");
+            fi_close(&ep_ctx->cq_ctx.cq->fid);
+            ep_ctx->cq_ctx.cq = NULL;
+            return rdma_cq_open(ep_ctx, cq_size, RDMA_COMP_SREAD);
+        }
     }
 
     switch (comp_method) {
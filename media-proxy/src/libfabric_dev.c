@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <getopt.h>
@@ -13,9 +15,29 @@
 #include <rdma/rdma_cma.h>
 
 #include "libfabric_dev.h"
+#include "libfabric_mr.h"
 
 const char *LIB_FABRIC_ATTR_PROV_NAME_TCP = "tcp";
 const char *LIB_FABRIC_ATTR_PROV_NAME_VERBS = "verbs";
+const char *LIB_FABRIC_ATTR_PROV_NAME_UDP = "udp";
+
+/*
+ * Fabric and domain opened for the contexts whose fi_info resolves to the
+ * same provider, domain and capabilities. Contexts hold a reference while
+ * they are initialized, so the domain and its registration cache outlive
+ * the connections that come and go on it.
+ */
+struct rdma_domain {
+    char key[256];
+    struct fid_fabric *fabric;
+    struct fid_domain *domain;
+    struct rdma_mr_cache *mr_cache;
+    unsigned int refcnt;
+    struct rdma_domain *next;
+};
+
+static struct rdma_domain *rdma_domains;
+static pthread_mutex_t rdma_domains_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /* We need to free any data that we allocated before freeing the
  * hints.
@@ -99,6 +121,136 @@ static int rdma_init_fabric(libfabric_ctx *rdma_ctx, struct fi_info *hints)
     return 0;
 }
 
+static const char *rdma_str(const char *s)
+{
+    return s ? s : "";
+}
+
+static int rdma_domain_open(struct fi_info *info, const char *key, struct rdma_domain **dom)
+{
+    struct rdma_domain *d;
+    int ret;
+
+    d = calloc(1, sizeof(*d));
+    if (!d)
+        return -FI_ENOMEM;
+    snprintf(d->key, sizeof(d->key), "%s", key);
+
+    ret = fi_fabric(info->fabric_attr, &d->fabric, NULL);
+    if (ret) {
+        printf("[rdma_init] ERROR: fi_fabric returned %d\n", ret);
+        goto err;
+    }
+
+    ret = fi_domain(d->fabric, info, &d->domain, NULL);
+    if (ret) {
+        printf("[rdma_init] ERROR: fi_domain returned %d\n", ret);
+        goto err_fabric;
+    }
+
+    ret = rdma_mr_cache_create(&d->mr_cache);
+    if (ret) {
+        printf("[rdma_init] ERROR: rdma_mr_cache_create returned %d\n", ret);
+        goto err_domain;
+    }
+
+    *dom = d;
+    return 0;
+
+err_domain:
+    fi_close(&d->domain->fid);
+err_fabric:
+    fi_close(&d->fabric->fid);
+err:
+    free(d);
+    return ret;
+}
+
+/*
+ * Attach the context to the domain its fi_info resolves to, opening it if
+ * no other context has. Domains serializing access across their endpoints
+ * are not shared, as the connections on them progress from threads of
+ * their own.
+ */
+static int rdma_domain_get(libfabric_ctx *rdma_ctx)
+{
+    struct fi_info *info = rdma_ctx->info;
+    struct rdma_domain *d;
+    char key[sizeof(d->key)];
+    bool shared = info->domain_attr->threading != FI_THREAD_DOMAIN &&
+                  info->domain_attr->threading != FI_THREAD_COMPLETION;
+    int ret;
+
+    snprintf(key, sizeof(key), "%s/%s/%s/%d/%" PRIx64 "/%zu/%zu",
+             rdma_str(info->fabric_attr->prov_name), rdma_str(info->fabric_attr->name),
+             rdma_str(info->domain_attr->name), (int)info->ep_attr->type, info->caps,
+             info->ep_attr->rx_ctx_cnt, info->domain_attr->cq_data_size);
+
+    pthread_mutex_lock(&rdma_domains_lock);
+
+    for (d = shared ? rdma_domains : NULL; d; d = d->next)
+        if (!strcmp(d->key, key))
+            break;
+
+    if (!d) {
+        ret = rdma_domain_open(info, key, &d);
+        if (ret) {
+            pthread_mutex_unlock(&rdma_domains_lock);
+            return ret;
+        }
+        if (shared) {
+            d->next = rdma_domains;
+            rdma_domains = d;
+        }
+    }
+    d->refcnt++;
+
+    pthread_mutex_unlock(&rdma_domains_lock);
+
+    rdma_ctx->shared_domain = d;
+    rdma_ctx->fabric = d->fabric;
+    rdma_ctx->domain = d->domain;
+    rdma_ctx->mr_cache = d->mr_cache;
+    return 0;
+}
+
+/*
+ * Release the reference of the context. The last one drops the idle
+ * registrations of the cache, then closes the domain and the fabric.
+ */
+static void rdma_domain_put(libfabric_ctx *rdma_ctx)
+{
+    struct rdma_domain *d = rdma_ctx->shared_domain;
+
+    if (!d)
+        return;
+
+    pthread_mutex_lock(&rdma_domains_lock);
+    if (--d->refcnt == 0) {
+        for (struct rdma_domain **p = &rdma_domains; *p; p = &(*p)->next) {
+            if (*p == d) {
+                *p = d->next;
+                break;
+            }
+        }
+    } else {
+        d = NULL;
+    }
+    pthread_mutex_unlock(&rdma_domains_lock);
+
+    if (d) {
+        rdma_mr_cache_destroy(&d->mr_cache);
+        RDMA_CLOSE_FID(d->domain);
+        RDMA_CLOSE_FID(d->fabric);
+        free(d);
+    }
+
+    rdma_ctx->shared_domain = NULL;
+    rdma_ctx->fabric = NULL;
+    rdma_ctx->domain = NULL;
+    rdma_ctx->mr_cache = NULL;
+}
+
 int rdma_init(libfabric_ctx **ctx)
 {
     printf("[rdma_init] Entering function\n");
@@ -142,11 +294,22 @@ int rdma_init(libfabric_ctx **ctx)
         /* Adjust capabilities based on the direction */
         if ((*ctx)->kind == FI_KIND_RECEIVER) {
             hints->caps = FI_MSG | FI_RECV | FI_RMA | FI_REMOTE_READ | FI_LOCAL_COMM;
+            /* The write transport exposes the buffers for remote writes.
+             * Credits are sent back to the transmitter. */
+            if ((*ctx)->rma_write)
+                hints->caps |= FI_REMOTE_WRITE;
+            if ((*ctx)->rma_write || (*ctx)->flow_credits)
+                hints->caps |= FI_SEND;
             if (hints->rx_attr) {
                 hints->rx_attr->size = 1024;  // Larger receive queue
             }
         } else {
             hints->caps = FI_MSG | FI_SEND | FI_RMA | FI_REMOTE_WRITE | FI_LOCAL_COMM;
+            /* Credits are received from the receiver. */
+            if ((*ctx)->rma_write)
+                hints->caps |= FI_WRITE;
+            if ((*ctx)->rma_write || (*ctx)->flow_credits)
+                hints->caps |= FI_RECV;
             if (hints->tx_attr) {
                 hints->tx_attr->size = 1024;  // Larger send queue
             }
@@ -154,10 +317,15 @@ int rdma_init(libfabric_ctx **ctx)
     } else {
         hints->domain_attr->mr_mode =
             FI_MR_LOCAL | FI_MR_VIRT_ADDR;
-        hints->ep_attr->type = FI_EP_RDM;
+        hints->ep_attr->type = (*ctx)->unreliable ? FI_EP_DGRAM : FI_EP_RDM;
         hints->caps = FI_MSG;
+        if ((*ctx)->rma_write)
+            hints->caps |= FI_RMA;
         hints->addr_format = FI_SOCKADDR_IN;
-        hints->fabric_attr->prov_name = strdup(LIB_FABRIC_ATTR_PROV_NAME_TCP);
+        /* The tcp provider has no datagram endpoints */
+        hints->fabric_attr->prov_name = strdup((*ctx)->unreliable ?
+                                               LIB_FABRIC_ATTR_PROV_NAME_UDP :
+                                               LIB_FABRIC_ATTR_PROV_NAME_TCP);
         hints->tx_attr->tclass = FI_TC_BULK_DATA;
         hints->domain_attr->resource_mgmt = FI_RM_ENABLED;
         hints->mode = FI_OPT_ENDPOINT;
@@ -166,6 +334,14 @@ int rdma_init(libfabric_ctx **ctx)
         hints->domain_attr->threading = FI_THREAD_UNSPEC;
     }
 
+    /* Receives are posted to a context shared by the endpoints of the domain */
+    if ((*ctx)->shared_rx)
+        hints->ep_attr->rx_ctx_cnt = FI_SHARED_CONTEXT;
+
+    /* Remote writes carry the buffer slot index as immediate data */
+    if ((*ctx)->rma_write)
+        hints->domain_attr->cq_data_size = sizeof(uint32_t);
+
     /* Store configuration for later endpoint use */
     (*ctx)->is_initialized = false;
     (*ctx)->ep_attr_type = hints->ep_attr->type;
@@ -240,17 +416,9 @@ int rdma_init(libfabric_ctx **ctx)
         goto err;
     }
 
-    ret = fi_fabric((*ctx)->info->fabric_attr, &(*ctx)->fabric, NULL);
-    if (ret) {
-        printf("[rdma_init] ERROR: fi_fabric returned %d\n", ret);
+    ret = rdma_domain_get(*ctx);
+    if (ret)
         goto err_info;
-    }
-
-    ret = fi_domain((*ctx)->fabric, (*ctx)->info, &(*ctx)->domain, NULL);
-    if (ret) {
-        printf("[rdma_init] ERROR: fi_domain returned %d\n", ret);
-        goto err_fabric;
-    }
 
     /* Clean up temporary resources */
     rdma_freeaddrinfo(rai_res);
@@ -260,9 +428,6 @@ int rdma_init(libfabric_ctx **ctx)
     printf("[rdma_init] Device context successfully initialized\n");
     return 0;
 
-err_fabric:
-    fi_close(&(*ctx)->fabric->fid);
-    
 err_info:
     fi_freeinfo((*ctx)->info);
     free(*ctx);
@@ -279,8 +444,7 @@ static void rdma_free_res(libfabric_ctx *rdma_ctx)
 {
     int ret;
 
-    RDMA_CLOSE_FID(rdma_ctx->domain);
-    RDMA_CLOSE_FID(rdma_ctx->fabric);
+    rdma_domain_put(rdma_ctx);
 
     if (rdma_ctx->info) {
         fi_freeinfo(rdma_ctx->info);
@@ -126,6 +126,15 @@ static int enable_ep(ep_ctx_t *ep_ctx)
         printf("[enable_ep] Note: No AV to bind (normal for some endpoint types)\n");
     }
 
+    // Receives are taken from the shared receive context if there is one
+    if (ep_ctx->srx) {
+        ret = fi_ep_bind(ep_ctx->ep, &ep_ctx->srx->fid, 0);
+        if (ret) {
+            RDMA_PRINTERR("fi_ep_bind (SRX)", ret);
+            return ret;
+        }
+    }
+
     // CQ binding is required for all endpoint types
     ret = fi_ep_bind(ep_ctx->ep, &ep_ctx->cq_ctx.cq->fid, FI_SEND | FI_RECV);
     if (ret) {
@@ -198,8 +207,8 @@ int ep_reg_mr(ep_ctx_t *ep_ctx, void *data_buf, size_t data_buf_size)
 {
     int ret;
 
-    /* TODO: I'm using address of ep_ctx as a key,
-     * maybe there is more elegant solution */
+    /* The address of ep_ctx is the key of uncached registrations;
+     * cached ones get theirs from the registration cache */
     ret = libfabric_mr_ops.rdma_reg_mr(
         ep_ctx->rdma_ctx, ep_ctx->ep, data_buf, data_buf_size,
         libfabric_mr_ops.rdma_info_to_mr_access(ep_ctx->rdma_ctx->info), (uint64_t)ep_ctx,
@@ -207,55 +216,295 @@ int ep_reg_mr(ep_ctx_t *ep_ctx, void *data_buf, size_t data_buf_size)
     return ret;
 }
 
+typedef ssize_t (*ep_post_fn)(ep_ctx_t *ep_ctx, void *arg);
+
+/**
+ * Post an operation, retrying while the provider is out of resources. The
+ * completion queue is progressed between the attempts, with a short capped
+ * back-off. Returns 0 on success, -ECANCELED if the endpoint is stopped,
+ * -ETIMEDOUT if the provider stays busy, or the error of the post.
+ */
+static int ep_post_retry(ep_ctx_t *ep_ctx, const char *op, ep_post_fn post, void *arg)
+{
+    const int max_retries   = 30;
+    const int backoff_us[5] = {  50, 100, 250, 500, 1000 };   /* capped */
+
+    int retry = 0;
+    int ret;
+
+    for (;;) {
+        if (ep_ctx->stop_flag)
+            return -ECANCELED;
+
+        ret = (int)post(ep_ctx, arg);
+        if (ret != -FI_EAGAIN && ret != -FI_ENODATA)
+            break;
+
+        /* Sends and injected messages are retired by progressing the CQ */
+        (void)fi_cq_read(ep_ctx->cq_ctx.cq, NULL, 0);
+
+        if (++retry > max_retries) {
+            RDMA_WARN("%s: provider busy, gave up after %d retries", op, max_retries);
+            return -ETIMEDOUT;
+        }
+
+        int idx = retry < 5 ? retry : 4;
+        usleep(backoff_us[idx]);
+    }
+
+    if (ret)
+        RDMA_ERR("%s failed: %s", op, fi_strerror(-ret));
+
+    return ret;
+}
+
+static int ep_check_dest(ep_ctx_t *ep_ctx, const char *op)
+{
+    if (ep_ctx->dest_av_entry == FI_ADDR_UNSPEC) {
+        RDMA_ERR("%s: invalid destination address", op);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+struct ep_send_args {
+    void *buf;
+    size_t buf_size;
+};
+
+static ssize_t ep_post_send(ep_ctx_t *ep_ctx, void *arg)
+{
+    struct ep_send_args *a = arg;
+
+    return fi_send(ep_ctx->ep, a->buf, a->buf_size, ep_ctx->data_desc,
+                   ep_ctx->dest_av_entry, a->buf);
+}
+
 int ep_send_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size)
 {
     if (!ep_ctx || !buf || buf_size == 0)
         return -EINVAL;
 
-    if (ep_ctx->dest_av_entry == FI_ADDR_UNSPEC) {
-        fprintf(stderr, "[ep_send_buf] ERROR: Invalid destination address\n");
+    if (ep_check_dest(ep_ctx, "fi_send"))
+        return -EINVAL;
+
+    struct ep_send_args args = { .buf = buf, .buf_size = buf_size };
+
+    return ep_post_retry(ep_ctx, "fi_send", ep_post_send, &args);
+}
+
+struct ep_sendmsg_args {
+    const struct fi_msg *msg;
+    uint64_t flags;
+};
+
+static ssize_t ep_post_sendmsg(ep_ctx_t *ep_ctx, void *arg)
+{
+    struct ep_sendmsg_args *a = arg;
+    ssize_t ret = fi_sendmsg(ep_ctx->ep, a->msg, a->flags);
+
+    /* Flush the sends posted so far before waiting. */
+    if (ret == -FI_EAGAIN || ret == -FI_ENODATA)
+        a->flags &= ~FI_MORE;
+
+    return ret;
+}
+
+/**
+ * Post sends of a burst of buffers. All sends but the last one carry FI_MORE,
+ * which allows the provider to ring the doorbell once for the whole burst.
+ * Returns the number of sends posted, or a negative error code if none was
+ * posted.
+ */
+int ep_send_burst(ep_ctx_t *ep_ctx, void **bufs, size_t *buf_sizes, int count)
+{
+    if (!ep_ctx || !bufs || !buf_sizes || count <= 0)
+        return -EINVAL;
+
+    if (ep_check_dest(ep_ctx, "fi_sendmsg"))
         return -EINVAL;
+
+    void *desc = ep_ctx->data_desc;
+    int   posted;
+    int   ret = 0;
+
+    for (posted = 0; posted < count; posted++) {
+        struct iovec iov = {
+            .iov_base = bufs[posted],
+            .iov_len = buf_sizes[posted],
+        };
+        struct fi_msg msg = {
+            .msg_iov = &iov,
+            .desc = &desc,
+            .iov_count = 1,
+            .addr = ep_ctx->dest_av_entry,
+            .context = bufs[posted],
+            .data = 0,
+        };
+        struct ep_sendmsg_args args = {
+            .msg = &msg,
+            .flags = FI_COMPLETION | (posted + 1 < count ? FI_MORE : 0),
+        };
+
+        ret = ep_post_retry(ep_ctx, "fi_sendmsg", ep_post_sendmsg, &args);
+        if (ret)
+            break;
     }
 
-    const int max_retries   = 30;
-    const int backoff_us[5] = {  50, 100, 250, 500, 1000 };   /* capped */
+    return posted ? posted : ret;
+}
 
-    void *desc = ep_ctx->data_desc ? ep_ctx->data_desc : NULL;
-    int   retry = 0;
-    int   ret;
+struct ep_sendv_args {
+    const struct iovec *iov;
+    void **desc;
+    size_t count;
+    void *buf_ctx;
+};
 
-    do {
-        if (ep_ctx->stop_flag)
-            return -ECANCELED;
+static ssize_t ep_post_sendv(ep_ctx_t *ep_ctx, void *arg)
+{
+    struct ep_sendv_args *a = arg;
 
-        ret = fi_send(ep_ctx->ep, buf, buf_size, desc,
-                      ep_ctx->dest_av_entry, buf);
-        if (ret == -FI_EAGAIN || ret == -FI_ENODATA) {
+    return fi_sendv(ep_ctx->ep, a->iov, a->desc, a->count, ep_ctx->dest_av_entry, a->buf_ctx);
+}
 
-            (void)fi_cq_read(ep_ctx->cq_ctx.cq, NULL, 0);
+/**
+ * Post a send gathered from several buffers, each registered memory with
+ * its own descriptor. The context is reported in the send completion.
+ */
+int ep_sendv(ep_ctx_t *ep_ctx, const struct iovec *iov, void **desc, size_t count,
+             void *buf_ctx)
+{
+    if (!ep_ctx || !iov || !desc || count == 0)
+        return -EINVAL;
 
-            if (retry == 0 || retry % 5 == 0)
-                fprintf(stderr,
-                        "[ep_send_buf] Connection not ready, retry %d/%d\n",
-                        retry, max_retries);
+    if (ep_check_dest(ep_ctx, "fi_sendv"))
+        return -EINVAL;
 
-            if (++retry > max_retries)
-                return -ETIMEDOUT;
+    struct ep_sendv_args args = {
+        .iov = iov,
+        .desc = desc,
+        .count = count,
+        .buf_ctx = buf_ctx,
+    };
 
-            /* short exponential back-off without polling the CQ */
-            int idx = retry < 5 ? retry : 4;
-            usleep(backoff_us[idx]);
-        }
-    } while (ret == -FI_EAGAIN || ret == -FI_ENODATA);
+    return ep_post_retry(ep_ctx, "fi_sendv", ep_post_sendv, &args);
+}
 
-    if (ret)
-        fprintf(stderr, "[ep_send_buf] fi_send failed: %s\n", fi_strerror(-ret));
+struct ep_inject_args {
+    const void *buf;
+    size_t buf_size;
+    uint64_t data;
+    uint64_t remote_addr;
+    uint64_t key;
+};
+
+static ssize_t ep_post_inject(ep_ctx_t *ep_ctx, void *arg)
+{
+    struct ep_inject_args *a = arg;
 
-    return ret;      /* 0 on success; <0 on error */
+    return fi_inject(ep_ctx->ep, a->buf, a->buf_size, ep_ctx->dest_av_entry);
 }
 
+/**
+ * Send a small message without a registered buffer and without a completion.
+ * The buffer can be reused as soon as the call returns. The message must not
+ * exceed the inject size of the provider.
+ */
+int ep_inject(ep_ctx_t *ep_ctx, const void *buf, size_t buf_size)
+{
+    if (!ep_ctx || !buf || buf_size == 0)
+        return -EINVAL;
 
-int ep_recv_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *buf_ctx)
+    if (ep_check_dest(ep_ctx, "fi_inject"))
+        return -EINVAL;
+
+    struct ep_inject_args args = { .buf = buf, .buf_size = buf_size };
+
+    return ep_post_retry(ep_ctx, "fi_inject", ep_post_inject, &args);
+}
+
+static ssize_t ep_post_inject_writedata(ep_ctx_t *ep_ctx, void *arg)
+{
+    struct ep_inject_args *a = arg;
+
+    return fi_inject_writedata(ep_ctx->ep, a->buf, a->buf_size, a->data,
+                               ep_ctx->dest_av_entry, a->remote_addr, a->key);
+}
+
+/**
+ * Write a small message to the remote memory without a registered buffer and
+ * without a local completion, carrying the immediate data reported in the
+ * completion on the remote side. A zero-length write carries the immediate
+ * data only.
+ */
+int ep_inject_writedata(ep_ctx_t *ep_ctx, const void *buf, size_t buf_size, uint64_t data,
+                        uint64_t remote_addr, uint64_t key)
+{
+    if (!ep_ctx || (!buf && buf_size))
+        return -EINVAL;
+
+    if (ep_check_dest(ep_ctx, "fi_inject_writedata"))
+        return -EINVAL;
+
+    struct ep_inject_args args = {
+        .buf = buf,
+        .buf_size = buf_size,
+        .data = data,
+        .remote_addr = remote_addr,
+        .key = key,
+    };
+
+    return ep_post_retry(ep_ctx, "fi_inject_writedata", ep_post_inject_writedata, &args);
+}
+
+static ssize_t ep_post_writemsg(ep_ctx_t *ep_ctx, void *arg)
+{
+    return fi_writemsg(ep_ctx->ep, (const struct fi_msg_rma *)arg,
+                       FI_COMPLETION | FI_REMOTE_CQ_DATA);
+}
+
+/**
+ * Post a write gathered from several buffers to the remote memory, carrying
+ * the immediate data reported in the completion on the remote side. The
+ * context is reported in the local completion.
+ */
+int ep_writedata(ep_ctx_t *ep_ctx, const struct iovec *iov, void **desc, size_t count,
+                 uint64_t data, uint64_t remote_addr, uint64_t key, void *buf_ctx)
+{
+    if (!ep_ctx || !iov || !desc || count == 0)
+        return -EINVAL;
+
+    if (ep_check_dest(ep_ctx, "fi_writemsg"))
+        return -EINVAL;
+
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++)
+        len += iov[i].iov_len;
+
+    struct fi_rma_iov rma_iov = {
+        .addr = remote_addr,
+        .len = len,
+        .key = key,
+    };
+    struct fi_msg_rma msg = {
+        .msg_iov = iov,
+        .desc = desc,
+        .iov_count = count,
+        .addr = ep_ctx->dest_av_entry,
+        .rma_iov = &rma_iov,
+        .rma_iov_count = 1,
+        .context = buf_ctx,
+        .data = data,
+    };
+
+    return ep_post_retry(ep_ctx, "fi_writemsg", ep_post_writemsg, &msg);
+}
+
+/**
+ * Post a receive to a buffer registered apart from the data buffers.
+ */
+int ep_recv_desc(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *desc, void *buf_ctx)
 {
     int ret;
 
@@ -266,7 +515,7 @@ int ep_recv_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *buf_ctx)
             return -ECANCELED;
         }
 
-        ret = fi_recv(ep_ctx->ep, buf, buf_size, ep_ctx->data_desc, FI_ADDR_UNSPEC, buf_ctx);
+        ret = fi_recv(ep_ctx->ep, buf, buf_size, desc, FI_ADDR_UNSPEC, buf_ctx);
         if (ret == -FI_EAGAIN)
             (void)fi_cq_read(ep_ctx->cq_ctx.cq, NULL, 0);
     } while (ret == -FI_EAGAIN);
@@ -274,6 +523,11 @@ int ep_recv_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *buf_ctx)
     return ret;
 }
 
+int ep_recv_buf(ep_ctx_t *ep_ctx, void *buf, size_t buf_size, void *buf_ctx)
+{
+    return ep_recv_desc(ep_ctx, buf, buf_size, ep_ctx->data_desc, buf_ctx);
+}
+
 int ep_cq_read(ep_ctx_t *ep_ctx, void **buf_ctx, int timeout)
 {
     struct fi_cq_err_entry entry;
@@ -325,6 +579,8 @@ int ep_init(ep_ctx_t **ep_ctx, ep_cfg_t *cfg)
 
     // Store reference to device context
     (*ep_ctx)->rdma_ctx = cfg->rdma_ctx;
+    (*ep_ctx)->srx = cfg->srx;
+    (*ep_ctx)->dest_av_entry = FI_ADDR_UNSPEC;
     (*ep_ctx)->stop_flag = false;
 
     // Create the endpoint using the domain from the device context
@@ -338,9 +594,10 @@ int ep_init(ep_ctx_t **ep_ctx, ep_cfg_t *cfg)
     if (cfg->shared_rx_cq) {
         (*ep_ctx)->cq_ctx.cq = cfg->shared_rx_cq;
         (*ep_ctx)->cq_ctx.external = true; // Indicate this CQ is owned by the caller
+        (*ep_ctx)->cq_ctx.cq_fd = -1;
         /* NOTE: do NOT close in ep_destroy – caller owns it */
     } else {
-        ret = libfabric_cq_ops.rdma_cq_open(*ep_ctx, 0, RDMA_COMP_SREAD);
+        ret = libfabric_cq_ops.rdma_cq_open(*ep_ctx, 0, cfg->comp_method);
         if (ret) {
             fprintf(stderr, "[ep_init] ERROR: rdma_cq_open returned %d\n", ret);
             goto err_ep;
@@ -410,6 +667,108 @@ err:
     return ret;
 }
 
+/**
+ * Re-create the endpoint and its address vector in place, e.g. after the
+ * connection was reset. The CQ, the memory registrations and the device
+ * context of the endpoint are kept. On error, the endpoint is left closed
+ * and the call can be repeated.
+ */
+int ep_reinit(ep_ctx_t *ep_ctx, ep_cfg_t *cfg)
+{
+    libfabric_ctx *rdma_ctx;
+    int ret;
+
+    if (!ep_ctx || !cfg || !ep_ctx->rdma_ctx || !ep_ctx->cq_ctx.cq)
+        return -EINVAL;
+
+    rdma_ctx = ep_ctx->rdma_ctx;
+
+    RDMA_CLOSE_FID(ep_ctx->ep);
+    RDMA_CLOSE_FID(ep_ctx->av);
+    ep_ctx->dest_av_entry = FI_ADDR_UNSPEC;
+
+    ret = fi_endpoint(rdma_ctx->domain, rdma_ctx->info, &ep_ctx->ep, NULL);
+    if (ret) {
+        RDMA_PRINTERR("fi_endpoint", ret);
+        ep_ctx->ep = NULL;
+        return ret;
+    }
+
+    if (rdma_ctx->ep_attr_type == FI_EP_RDM || rdma_ctx->ep_attr_type == FI_EP_DGRAM) {
+        struct fi_av_attr av_attr = {.type = FI_AV_MAP, .count = 1};
+
+        ret = fi_av_open(rdma_ctx->domain, &av_attr, &ep_ctx->av, NULL);
+        if (ret) {
+            RDMA_PRINTERR("fi_av_open", ret);
+            ep_ctx->av = NULL;
+            goto err;
+        }
+    }
+
+    ret = enable_ep(ep_ctx);
+    if (ret)
+        goto err;
+
+    if (cfg->dir == TX && rdma_ctx->info->dest_addr) {
+        ret = ep_av_insert(rdma_ctx, ep_ctx->av, rdma_ctx->info->dest_addr, 1,
+                           &ep_ctx->dest_av_entry, 0, NULL);
+        if (ret)
+            goto err;
+    }
+
+    ep_ctx->stop_flag = false;
+    return 0;
+
+err:
+    RDMA_CLOSE_FID(ep_ctx->av);
+    RDMA_CLOSE_FID(ep_ctx->ep);
+    return ret;
+}
+
+/**
+ * Get the address of the endpoint, to be sent to the peer. On input,
+ * addrlen is the size of addr, on output the length of the address.
+ */
+int ep_getname(ep_ctx_t *ep_ctx, void *addr, size_t *addrlen)
+{
+    int ret;
+
+    if (!ep_ctx || !ep_ctx->ep || !addr || !addrlen)
+        return -EINVAL;
+
+    ret = fi_getname(&ep_ctx->ep->fid, addr, addrlen);
+    if (ret)
+        RDMA_PRINTERR("fi_getname", ret);
+
+    return ret;
+}
+
+/**
+ * Make the endpoint address of the peer the destination of the endpoint,
+ * replacing the previous one. The address is the one from ep_getname() on
+ * the peer side.
+ */
+int ep_set_peer(ep_ctx_t *ep_ctx, const void *addr)
+{
+    fi_addr_t fi_addr;
+    int ret;
+
+    if (!ep_ctx || !ep_ctx->av || !addr)
+        return -EINVAL;
+
+    if (ep_ctx->dest_av_entry != FI_ADDR_UNSPEC) {
+        fi_av_remove(ep_ctx->av, &ep_ctx->dest_av_entry, 1, 0);
+        ep_ctx->dest_av_entry = FI_ADDR_UNSPEC;
+    }
+
+    ret = ep_av_insert(ep_ctx->rdma_ctx, ep_ctx->av, (void *)addr, 1, &fi_addr, 0, NULL);
+    if (ret)
+        return ret;
+
+    ep_ctx->dest_av_entry = fi_addr;
+    return 0;
+}
+
 int ep_destroy(ep_ctx_t **ep_ctx)
 {
     if (!ep_ctx || !(*ep_ctx))
@@ -436,6 +795,8 @@ int ep_destroy(ep_ctx_t **ep_ctx)
     /* 4. Address vector always owned by the EP */
     RDMA_CLOSE_FID(ctx->av);
 
+    /* The shared receive context, if any, is owned by the caller */
+
     /* 5. finally free the context struct */
     free(ctx);
     *ep_ctx = NULL;
@@ -446,8 +807,17 @@ int ep_destroy(ep_ctx_t **ep_ctx)
 struct libfabric_ep_ops_t libfabric_ep_ops = {
     .ep_reg_mr = ep_reg_mr,
     .ep_send_buf = ep_send_buf,
+    .ep_send_burst = ep_send_burst,
+    .ep_sendv = ep_sendv,
+    .ep_writedata = ep_writedata,
+    .ep_inject = ep_inject,
+    .ep_inject_writedata = ep_inject_writedata,
     .ep_recv_buf = ep_recv_buf,
+    .ep_recv_desc = ep_recv_desc,
     .ep_cq_read = ep_cq_read,
     .ep_init = ep_init,
+    .ep_reinit = ep_reinit,
+    .ep_getname = ep_getname,
+    .ep_set_peer = ep_set_peer,
     .ep_destroy = ep_destroy
 };
\ No newline at end of file
@@ -36,6 +36,10 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <rdma/fi_cm.h>
 #include <rdma/fi_domain.h>
@@ -48,6 +52,48 @@
 
 #include "libfabric_mr.h"
 
+/* Idle registrations kept per domain before the least recently used is closed */
+#define RDMA_MR_CACHE_MAX_IDLE 64
+
+/*
+ * A cached registration. Its address range is [start, end). Idle entries
+ * are on the LRU list. A stale entry has been dropped from the map by an
+ * invalidation or a wider registration, and is kept on the stale list until
+ * its last release closes it.
+ */
+struct rdma_mr_entry {
+    struct rdma_mr_cache *cache;
+    uintptr_t start;
+    uintptr_t end;
+    uint64_t access;
+    struct fid_mr *mr;
+    void *desc;
+    unsigned int refcnt;
+    bool stale;
+    struct rdma_mr_entry *prev;
+    struct rdma_mr_entry *next;
+};
+
+struct rdma_mr_list {
+    struct rdma_mr_entry *head;
+    struct rdma_mr_entry *tail;
+    size_t len;
+};
+
+/*
+ * Registration cache of a domain. The map is sorted by start address and
+ * holds no two entries where one contains the other. The head of the LRU
+ * list is the least recently used idle entry.
+ */
+struct rdma_mr_cache {
+    pthread_mutex_t lock;
+    struct rdma_mr_entry **map;
+    size_t count;
+    size_t capacity;
+    struct rdma_mr_list lru;
+    struct rdma_mr_list stale;
+};
+
 static void rdma_fill_mr_attr(struct iovec *iov, struct fi_mr_dmabuf *dmabuf, int iov_count,
                               uint64_t access, uint64_t key, enum fi_hmem_iface iface,
                               uint64_t device, struct fi_mr_attr *attr, uint64_t flags)
@@ -78,8 +124,9 @@ static void rdma_fill_mr_attr(struct iovec *iov, struct fi_mr_dmabuf *dmabuf, in
     }
 }
 
-int rdma_reg_mr(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t size, uint64_t access,
-                uint64_t key, enum fi_hmem_iface iface, uint64_t device, struct fid_mr **mr, void **desc)
+static int rdma_reg_mr_uncached(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t size,
+                                uint64_t access, uint64_t key, enum fi_hmem_iface iface,
+                                uint64_t device, void *context, struct fid_mr **mr, void **desc)
 {
     struct fi_mr_dmabuf dmabuf = { 0 };
     struct fi_mr_attr attr = { 0 };
@@ -95,6 +142,7 @@ int rdma_reg_mr(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t si
     flags = (iface) ? FI_HMEM_DEVICE_ONLY : 0;
 
     rdma_fill_mr_attr(&iov, &dmabuf, 1, access, key, iface, device, &attr, flags);
+    attr.context = context;
     ret = fi_mr_regattr(rdma_ctx->domain, &attr, flags, mr);
     if (ret)
         return ret;
@@ -115,6 +163,271 @@ int rdma_reg_mr(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t si
     return 0;
 }
 
+
+static size_t mr_cache_upper(struct rdma_mr_cache *cache, uintptr_t addr)
+{
+    size_t lo = 0, hi = cache->count;
+
+    /* First entry starting above addr */
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cache->map[mid]->start <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static struct rdma_mr_entry *mr_cache_find(struct rdma_mr_cache *cache, uintptr_t start,
+                                           uintptr_t end, uint64_t access)
+{
+    for (size_t i = mr_cache_upper(cache, start); i > 0; i--) {
+        struct rdma_mr_entry *e = cache->map[i - 1];
+        if (e->end >= end && (e->access & access) == access)
+            return e;
+    }
+    return NULL;
+}
+
+static int mr_cache_insert(struct rdma_mr_cache *cache, struct rdma_mr_entry *e)
+{
+    if (cache->count == cache->capacity) {
+        size_t capacity = cache->capacity ? cache->capacity * 2 : 16;
+        struct rdma_mr_entry **map = realloc(cache->map, capacity * sizeof(*map));
+        if (!map)
+            return -FI_ENOMEM;
+        cache->map = map;
+        cache->capacity = capacity;
+    }
+
+    size_t i = mr_cache_upper(cache, e->start);
+    memmove(&cache->map[i + 1], &cache->map[i], (cache->count - i) * sizeof(*cache->map));
+    cache->map[i] = e;
+    cache->count++;
+    return 0;
+}
+
+static void mr_cache_remove(struct rdma_mr_cache *cache, struct rdma_mr_entry *e)
+{
+    for (size_t i = 0; i < cache->count; i++) {
+        if (cache->map[i] == e) {
+            memmove(&cache->map[i], &cache->map[i + 1],
+                    (cache->count - i - 1) * sizeof(*cache->map));
+            cache->count--;
+            return;
+        }
+    }
+}
+
+static void mr_list_push(struct rdma_mr_list *list, struct rdma_mr_entry *e)
+{
+    e->next = NULL;
+    e->prev = list->tail;
+    if (list->tail)
+        list->tail->next = e;
+    else
+        list->head = e;
+    list->tail = e;
+    list->len++;
+}
+
+static void mr_list_unlink(struct rdma_mr_list *list, struct rdma_mr_entry *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        list->head = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        list->tail = e->prev;
+    e->prev = e->next = NULL;
+    list->len--;
+}
+
+static void mr_cache_close(struct rdma_mr_entry *e)
+{
+    RDMA_CLOSE_FID(e->mr);
+    free(e);
+}
+
+/* Drop an entry from the map, closing it now if idle or on its last release */
+static void mr_cache_retire(struct rdma_mr_cache *cache, struct rdma_mr_entry *e)
+{
+    mr_cache_remove(cache, e);
+    if (e->refcnt) {
+        e->stale = true;
+        mr_list_push(&cache->stale, e);
+        return;
+    }
+    mr_list_unlink(&cache->lru, e);
+    mr_cache_close(e);
+}
+
+static void mr_cache_evict(struct rdma_mr_cache *cache, size_t keep)
+{
+    while (cache->lru.len > keep)
+        mr_cache_retire(cache, cache->lru.head);
+}
+
+/*
+ * Registers the range through the cache of the domain. A registration
+ * covering the range with the requested access is shared. Otherwise the
+ * range is widened over the registrations it overlaps, which are retired,
+ * so that later lookups in any of them hit the new one.
+ */
+static int rdma_reg_mr_cached(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t size,
+                              uint64_t access, uint64_t key, struct fid_mr **mr, void **desc)
+{
+    struct rdma_mr_cache *cache = rdma_ctx->mr_cache;
+    uintptr_t start = (uintptr_t)buf;
+    uintptr_t end = start + size;
+    struct rdma_mr_entry *e;
+    bool widened;
+    int ret;
+
+    pthread_mutex_lock(&cache->lock);
+
+    e = mr_cache_find(cache, start, end, access);
+    if (e) {
+        if (e->refcnt++ == 0)
+            mr_list_unlink(&cache->lru, e);
+        goto out;
+    }
+
+    do {
+        widened = false;
+        for (size_t i = 0; i < mr_cache_upper(cache, end - 1); i++) {
+            struct rdma_mr_entry *o = cache->map[i];
+            if (o->end <= start)
+                continue;
+            if (o->start < start || o->end > end || (o->access | access) != access) {
+                start = o->start < start ? o->start : start;
+                end = o->end > end ? o->end : end;
+                access |= o->access;
+                widened = true;
+            }
+        }
+    } while (widened);
+
+    e = calloc(1, sizeof(*e));
+    if (!e) {
+        ret = -FI_ENOMEM;
+        goto err;
+    }
+    e->cache = cache;
+    e->start = start;
+    e->end = end;
+    e->access = access;
+
+    ret = rdma_reg_mr_uncached(rdma_ctx, ep, (void *)start, end - start, access, key,
+                               FI_HMEM_SYSTEM, 0, e, &e->mr, &e->desc);
+    if (ret && cache->lru.len) {
+        /* Unpin the idle registrations, which also frees their keys, and try again */
+        RDMA_CLOSE_FID(e->mr);
+        mr_cache_evict(cache, 0);
+        ret = rdma_reg_mr_uncached(rdma_ctx, ep, (void *)start, end - start, access, key,
+                                   FI_HMEM_SYSTEM, 0, e, &e->mr, &e->desc);
+    }
+    if (ret) {
+        RDMA_CLOSE_FID(e->mr);
+        free(e);
+        goto err;
+    }
+
+    for (size_t i = mr_cache_upper(cache, end - 1); i > 0; i--) {
+        struct rdma_mr_entry *o = cache->map[i - 1];
+        if (o->start >= start && o->end <= end)
+            mr_cache_retire(cache, o);
+    }
+
+    ret = mr_cache_insert(cache, e);
+    if (ret) {
+        mr_cache_close(e);
+        goto err;
+    }
+    e->refcnt = 1;
+
+out:
+    *mr = e->mr;
+    if (desc)
+        *desc = e->desc;
+    pthread_mutex_unlock(&cache->lock);
+    return 0;
+
+err:
+    pthread_mutex_unlock(&cache->lock);
+    return ret;
+}
+
+int rdma_reg_mr(libfabric_ctx *rdma_ctx, struct fid_ep *ep, void *buf, size_t size, uint64_t access,
+                uint64_t key, enum fi_hmem_iface iface, uint64_t device, struct fid_mr **mr, void **desc)
+{
+    /* Registrations bound to an endpoint cannot be shared */
+    if (rdma_ctx->mr_cache && iface == FI_HMEM_SYSTEM && size &&
+        !(rdma_ctx->info->domain_attr->mr_mode & FI_MR_ENDPOINT))
+        return rdma_reg_mr_cached(rdma_ctx, ep, buf, size, access, key, mr, desc);
+
+    return rdma_reg_mr_uncached(rdma_ctx, ep, buf, size, access, key, iface, device, NULL, mr,
+                                desc);
+}
+
+int rdma_mr_cache_create(struct rdma_mr_cache **cache)
+{
+    *cache = calloc(1, sizeof(**cache));
+    if (!*cache)
+        return -FI_ENOMEM;
+
+    pthread_mutex_init(&(*cache)->lock, NULL);
+    return 0;
+}
+
+void rdma_mr_cache_destroy(struct rdma_mr_cache **cachep)
+{
+    struct rdma_mr_cache *cache = *cachep;
+    if (!cache)
+        return;
+
+    /* Registrations still in use are detached and closed by their owners */
+    for (size_t i = 0; i < cache->count; i++) {
+        struct rdma_mr_entry *e = cache->map[i];
+        if (e->refcnt)
+            e->cache = NULL;
+        else
+            mr_cache_close(e);
+    }
+    for (struct rdma_mr_entry *e = cache->stale.head; e; e = e->next)
+        e->cache = NULL;
+
+    if (cache->count + cache->stale.len > cache->lru.len)
+        RDMA_WARN("%zu memory registrations still in use at domain teardown",
+                  cache->count + cache->stale.len - cache->lru.len);
+
+    free(cache->map);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+    *cachep = NULL;
+}
+
+void rdma_mr_cache_invalidate(libfabric_ctx *rdma_ctx, void *buf, size_t size)
+{
+    struct rdma_mr_cache *cache = rdma_ctx ? rdma_ctx->mr_cache : NULL;
+    uintptr_t start = (uintptr_t)buf;
+    uintptr_t end = start + size;
+
+    if (!cache || !size)
+        return;
+
+    pthread_mutex_lock(&cache->lock);
+    for (size_t i = mr_cache_upper(cache, end - 1); i > 0; i--) {
+        struct rdma_mr_entry *e = cache->map[i - 1];
+        if (e->end > start)
+            mr_cache_retire(cache, e);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
 static inline int rdma_rma_write_target_allowed(uint64_t caps)
 {
     if (caps & (FI_RMA | FI_ATOMIC)) {
@@ -173,11 +486,36 @@ uint64_t rdma_info_to_mr_access(struct fi_info *info)
 }
 
 void rdma_unreg_mr(struct fid_mr *data_mr) {
-    RDMA_CLOSE_FID(data_mr);
+    /* Cached registrations carry their entry as the context */
+    struct rdma_mr_entry *e = data_mr ? data_mr->fid.context : NULL;
+    if (!e) {
+        RDMA_CLOSE_FID(data_mr);
+        return;
+    }
+
+    struct rdma_mr_cache *cache = e->cache;
+    if (!cache) {
+        if (--e->refcnt == 0)
+            mr_cache_close(e);
+        return;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    if (--e->refcnt == 0) {
+        if (e->stale) {
+            mr_list_unlink(&cache->stale, e);
+            mr_cache_close(e);
+        } else {
+            mr_list_push(&cache->lru, e);
+            mr_cache_evict(cache, RDMA_MR_CACHE_MAX_IDLE);
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
 }
 
 struct libfabric_mr_ops_t libfabric_mr_ops = {
     .rdma_reg_mr = rdma_reg_mr,
     .rdma_info_to_mr_access = rdma_info_to_mr_access,
     .rdma_unreg_mr = rdma_unreg_mr,
+    .rdma_mr_cache_invalidate = rdma_mr_cache_invalidate,
 };
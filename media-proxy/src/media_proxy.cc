@@ -54,11 +54,69 @@ void usage(FILE* fp, const char* path)
                 "IP address for SMPTE 2110 (default: %s)\n",
             config::proxy.st2110.dataplane_ip_addr.c_str());
     fprintf(fp, "-r, --rdma_ip=ip_address\t"
-                "IP address for RDMA (default: %s)\n",
+                "IP address for RDMA, or a comma-separated list of addresses\n"
+                "\t\t\t\ton several NICs to stripe traffic across (default: %s)\n",
             config::proxy.rdma.dataplane_ip_addr.c_str());
     fprintf(fp, "-p, --rdma_ports=ports_ranges\t"
                 "Local port ranges for incoming RDMA connections (default: %s)\n",
             config::proxy.rdma.dataplane_local_ports.c_str());
+    fprintf(fp, "-x, --rdma_zero_copy\t\t"
+                "Send frames received from local connections over RDMA without\n"
+                "\t\t\t\tcopying\n");
+    fprintf(fp, "-e, --rdma_progress=cpus\t"
+                "Poll RDMA completion queues from shared progress threads pinned\n"
+                "\t\t\t\tto the CPU cores, one thread per core (comma-separated list,\n"
+                "\t\t\t\tor 'any')\n");
+    fprintf(fp, "-g, --rdma_reorder_timeout=us\t"
+                "Max time an RDMA receiver waits for a missing frame before\n"
+                "\t\t\t\tskipping it as lost (default: %u)\n",
+            config::proxy.rdma.reorder_timeout_us);
+    fprintf(fp, "-m, --rdma_hugepages=size\t"
+                "Back RDMA buffer pools with hugepages of the size (2M|1G),\n"
+                "\t\t\t\tfalling back to regular pages if none are free\n");
+    fprintf(fp, "-s, --rdma_shared_rx\t\t"
+                "Share receive buffers between the RDMA receivers of a NIC\n"
+                "\t\t\t\tthrough shared receive contexts\n");
+    fprintf(fp, "-z, --zero_copy_relay\t\t"
+                "Relay frames between local connections without copying\n");
+    fprintf(fp, "-b, --busy_poll=cpus\t\t"
+                "Busy-poll memif ingress rings from threads pinned to the CPU\n"
+                "\t\t\t\tcores, one thread per core (comma-separated list, or 'any')\n");
+    fprintf(fp, "-f, --fanout=drop_policy\t"
+                "Dispatch frames to multipoint outputs in parallel, dropping the\n"
+                "\t\t\t\toldest or newest frame on queue overflow (oldest|newest)\n");
+    fprintf(fp, "-q, --fanout_queue=depth\t"
+                "Queue depth per output for parallel fan-out (default: %u)\n",
+            config::proxy.multipoint.fanout_queue_depth);
+}
+
+/* parse a comma-separated list of CPU cores, or 'any' for no pinning */
+static bool parse_cpus(const std::string& str, std::vector<int>& cpus)
+{
+    cpus.clear();
+
+    if (str == "any")
+        return true;
+
+    try {
+        size_t pos = 0;
+        while (pos < str.size()) {
+            auto end = str.find(',', pos);
+            if (end == std::string::npos)
+                end = str.size();
+
+            auto cpu = std::stoi(str.substr(pos, end - pos));
+            if (cpu < 0)
+                throw std::out_of_range("cpu");
+            cpus.push_back(cpu);
+            pos = end + 1;
+        }
+    } catch (...) {
+        cpus.clear();
+        return false;
+    }
+
+    return true;
 }
 
 void PrintStackTrace() {
@@ -107,6 +165,12 @@ int main(int argc, char* argv[])
     std::string st2110_ip_addr = config::proxy.st2110.dataplane_ip_addr;
     std::string rdma_ip_addr = config::proxy.rdma.dataplane_ip_addr;
     std::string rdma_ports = config::proxy.rdma.dataplane_local_ports;
+    std::string fanout_policy;
+    std::string fanout_queue;
+    std::string busy_poll;
+    std::string rdma_progress;
+    std::string rdma_reorder_timeout;
+    std::string rdma_hugepages;
     int help_flag = 0;
 
     int opt;
@@ -118,12 +182,21 @@ int main(int argc, char* argv[])
         { "st2110_ip", required_argument, NULL, 'i' },
         { "rdma_ip", required_argument, NULL, 'r' },
         { "rdma_ports", required_argument, NULL, 'p' },
+        { "rdma_zero_copy", no_argument, NULL, 'x' },
+        { "rdma_progress", required_argument, NULL, 'e' },
+        { "rdma_reorder_timeout", required_argument, NULL, 'g' },
+        { "rdma_hugepages", required_argument, NULL, 'm' },
+        { "rdma_shared_rx", no_argument, NULL, 's' },
+        { "zero_copy_relay", no_argument, NULL, 'z' },
+        { "busy_poll", required_argument, NULL, 'b' },
+        { "fanout", required_argument, NULL, 'f' },
+        { "fanout_queue", required_argument, NULL, 'q' },
         { 0 }
     };
 
     /* infinite loop, to be broken when we are done parsing options */
     while (1) {
-        opt = getopt_long(argc, argv, "h?t:a:d:i:r:p:", longopts, 0);
+        opt = getopt_long(argc, argv, "h?t:a:d:i:r:p:xe:g:m:szb:f:q:", longopts, 0);
         if (opt == -1)
             break;
 
@@ -150,6 +223,33 @@ int main(int argc, char* argv[])
         case 'p':
             rdma_ports = optarg;
             break;
+        case 'x':
+            config::proxy.rdma.zero_copy_tx = true;
+            break;
+        case 'e':
+            rdma_progress = optarg;
+            break;
+        case 'g':
+            rdma_reorder_timeout = optarg;
+            break;
+        case 'm':
+            rdma_hugepages = optarg;
+            break;
+        case 's':
+            config::proxy.rdma.shared_rx = true;
+            break;
+        case 'z':
+            config::proxy.local.zero_copy_relay = true;
+            break;
+        case 'b':
+            busy_poll = optarg;
+            break;
+        case 'f':
+            fanout_policy = optarg;
+            break;
+        case 'q':
+            fanout_queue = optarg;
+            break;
         }
     }
 
@@ -179,6 +279,63 @@ int main(int argc, char* argv[])
                   config::proxy.sdk_api_port);
     }
 
+    if (!fanout_policy.empty()) {
+        if (fanout_policy == "oldest" || fanout_policy == "newest") {
+            config::proxy.multipoint.parallel_fanout = true;
+            config::proxy.multipoint.fanout_drop_oldest = fanout_policy == "oldest";
+        } else {
+            log::warn("Unknown fan-out drop policy: %s. Using serial fan-out",
+                      fanout_policy.c_str());
+        }
+    }
+
+    if (!fanout_queue.empty()) {
+        try {
+            auto depth = std::stoi(fanout_queue);
+            if (depth <= 0)
+                throw std::out_of_range("depth");
+            config::proxy.multipoint.fanout_queue_depth = depth;
+        } catch (...) {
+            log::warn("Can't parse fan-out queue depth. Using default depth: %u",
+                      config::proxy.multipoint.fanout_queue_depth);
+        }
+    }
+
+    if (!busy_poll.empty()) {
+        config::proxy.local.busy_poll = true;
+
+        if (!parse_cpus(busy_poll, config::proxy.local.busy_poll_cpus))
+            log::warn("Can't parse busy-poll CPU cores. Using one unpinned thread");
+    }
+
+    if (!rdma_progress.empty()) {
+        config::proxy.rdma.progress_engine = true;
+
+        if (!parse_cpus(rdma_progress, config::proxy.rdma.progress_cpus))
+            log::warn("Can't parse RDMA progress CPU cores. Using one unpinned thread");
+    }
+
+    if (!rdma_reorder_timeout.empty()) {
+        try {
+            auto timeout = std::stoi(rdma_reorder_timeout);
+            if (timeout <= 0)
+                throw std::out_of_range("timeout");
+            config::proxy.rdma.reorder_timeout_us = timeout;
+        } catch (...) {
+            log::warn("Can't parse RDMA reorder timeout. Using default timeout: %u us",
+                      config::proxy.rdma.reorder_timeout_us);
+        }
+    }
+
+    if (!rdma_hugepages.empty()) {
+        if (rdma_hugepages == "2M")
+            config::proxy.rdma.hugepage_size = 2UL << 20;
+        else if (rdma_hugepages == "1G")
+            config::proxy.rdma.hugepage_size = 1UL << 30;
+        else
+            log::warn("Can't parse RDMA hugepage size. Using regular pages");
+    }
+
     log::info("SDK API port: %u", config::proxy.sdk_api_port);
     log::info("MCM Agent Proxy API addr: %s", config::proxy.agent_addr.c_str());
     log::info("ST2110 device port BDF: %s",
@@ -189,6 +346,34 @@ int main(int argc, char* argv[])
               config::proxy.rdma.dataplane_ip_addr.c_str());
     log::info("RDMA dataplane local port ranges: %s",
               config::proxy.rdma.dataplane_local_ports.c_str());
+    log::info("RDMA zero-copy transmit: %s",
+              config::proxy.rdma.zero_copy_tx ? "on" : "off");
+    if (config::proxy.rdma.progress_engine)
+        log::info("RDMA progress: shared, %zu thread(s)",
+                  std::max<size_t>(config::proxy.rdma.progress_cpus.size(), 1));
+    else
+        log::info("RDMA progress: threads per connection");
+    log::info("RDMA reorder timeout: %u us", config::proxy.rdma.reorder_timeout_us);
+    if (config::proxy.rdma.hugepage_size)
+        log::info("RDMA buffer pools: %zu MiB hugepages",
+                  config::proxy.rdma.hugepage_size >> 20);
+    else
+        log::info("RDMA buffer pools: regular pages");
+    log::info("RDMA shared receive: %s",
+              config::proxy.rdma.shared_rx ? "on" : "off");
+    log::info("Local zero-copy relay: %s",
+              config::proxy.local.zero_copy_relay ? "on" : "off");
+    if (config::proxy.local.busy_poll)
+        log::info("Local ingress: busy-poll, %zu thread(s)",
+                  std::max<size_t>(config::proxy.local.busy_poll_cpus.size(), 1));
+    else
+        log::info("Local ingress: interrupt");
+    if (config::proxy.multipoint.parallel_fanout)
+        log::info("Multipoint fan-out: parallel, drop %s, queue depth %u",
+                  config::proxy.multipoint.fanout_drop_oldest ? "oldest" : "newest",
+                  config::proxy.multipoint.fanout_queue_depth);
+    else
+        log::info("Multipoint fan-out: serial");
 
     // Intercept shutdown signals to cancel the main context
     auto signal_handler = [](int sig) {
@@ -5,6 +5,8 @@
  */
 
 #include "buf.h"
+#include <algorithm>
+#include <new>
 
 namespace mesh::connection {
 
@@ -12,4 +14,170 @@ size_t BufferPartitions::total_size() const {
     return payload.size + metadata.size + sysdata.size;
 }
 
+/**
+ * Return the number of leading bytes of the buffer that carry data, as told
+ * by the payload and metadata lengths in the system data. The unused tails
+ * of the partitions at the end of the buffer are excluded. Returns the size
+ * unchanged if the buffer does not have the full partitioning.
+ */
+size_t BufferPartitions::used_size(const void *data, size_t size) const
+{
+    if (size != total_size() || sysdata.size < sizeof(BufferSysData) ||
+        sysdata.offset + sizeof(BufferSysData) > size)
+        return size;
+
+    auto sys = (const BufferSysData *)((const uint8_t *)data + sysdata.offset);
+
+    size_t used = sysdata.offset + sysdata.size;
+    used = std::max<size_t>(used, payload.offset +
+                                  std::min(sys->payload_len, payload.size));
+    if (sys->metadata_len)
+        used = std::max<size_t>(used, metadata.offset +
+                                      std::min(sys->metadata_len, metadata.size));
+
+    return std::min(used, size);
+}
+
+void BufferHandle::retain()
+{
+    refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BufferHandle::release()
+{
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    if (on_release)
+        on_release(this);
+
+    pool->put(this);
+}
+
+const BufferPartitions& BufferHandle::parts() const
+{
+    return pool->parts;
+}
+
+/**
+ * Return a pointer to the system data partition of the buffer, or nullptr
+ * if the partition does not fit the system data structure.
+ */
+BufferSysData * BufferHandle::sysdata() const
+{
+    auto& sys = pool->parts.sysdata;
+
+    if (!data || sys.size < sizeof(BufferSysData) ||
+        sys.offset + sizeof(BufferSysData) > pool->parts.total_size())
+        return nullptr;
+
+    return (BufferSysData *)((uint8_t *)data + sys.offset);
+}
+
+bool BufferPool::init(uint32_t capacity, bool with_storage)
+{
+    handles.reset(new(std::nothrow) BufferHandle[capacity]);
+    if (!handles)
+        return false;
+
+    size_t buf_size = parts.total_size();
+
+    if (with_storage) {
+        storage.reset(new(std::nothrow) uint8_t[buf_size * capacity]);
+        if (!storage)
+            return false;
+    }
+
+    free_list.reserve(capacity);
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        auto buf = &handles[i];
+        buf->pool = this;
+        buf->data = with_storage ? storage.get() + buf_size * i : nullptr;
+        free_list.push_back(buf);
+    }
+
+    this->capacity = capacity;
+    return true;
+}
+
+BufferPool::~BufferPool()
+{
+    for (auto it = destroy_fns.rbegin(); it != destroy_fns.rend(); ++it)
+        (*it)();
+}
+
+void BufferPool::destroy()
+{
+    {
+        std::lock_guard<std::mutex> lk(mx);
+        destroying = true;
+
+        if (free_list.size() < capacity)
+            return;
+    }
+    delete this;
+}
+
+/**
+ * Register a callback called when the pool is deleted, after destroy() and
+ * the release of the last handle. Callbacks are called in the reverse order
+ * of registration, so memory is freed after the objects registered in it.
+ */
+void BufferPool::on_destroy(std::function<void()> fn)
+{
+    std::lock_guard<std::mutex> lk(mx);
+    destroy_fns.push_back(std::move(fn));
+}
+
+BufferHandle * BufferPool::alloc()
+{
+    BufferHandle *buf;
+    {
+        std::lock_guard<std::mutex> lk(mx);
+
+        if (free_list.empty())
+            return nullptr;
+
+        buf = free_list.back();
+        free_list.pop_back();
+    }
+
+    buf->refs.store(1, std::memory_order_relaxed);
+    if (!storage)
+        buf->data = nullptr;
+    buf->size = 0;
+    buf->ingress_ns = 0;
+    buf->ring_slot = false;
+    buf->on_release = nullptr;
+    buf->owner = nullptr;
+    buf->cookie = 0;
+
+    return buf;
+}
+
+uint32_t BufferPool::available()
+{
+    std::lock_guard<std::mutex> lk(mx);
+    return free_list.size();
+}
+
+uint32_t BufferPool::outstanding()
+{
+    std::lock_guard<std::mutex> lk(mx);
+    return capacity - free_list.size();
+}
+
+void BufferPool::put(BufferHandle *buf)
+{
+    {
+        std::lock_guard<std::mutex> lk(mx);
+        free_list.push_back(buf);
+
+        if (!destroying || free_list.size() < capacity)
+            return;
+    }
+    delete this;
+}
+
 } // namespace mesh::connection
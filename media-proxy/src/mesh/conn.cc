@@ -10,9 +10,12 @@
 
 namespace mesh::connection {
 
+// Time the frame being transmitted by the current thread entered Media Proxy.
+// Used to measure the end-to-end latency of frames passed as raw pointers.
+static thread_local int64_t dp_ingress_ns;
+
 Connection::Connection()
 {
-    std::memset(&metrics, 0, sizeof(metrics));
 }
 
 Connection::~Connection()
@@ -245,11 +248,67 @@ Result Connection::transmit(context::Context& ctx, void *ptr, uint32_t sz)
 
     metrics.inbound_bytes += sz;
 
+    auto& sys = config.buf_parts.sysdata;
+    if (sys.size >= sizeof(BufferSysData) &&
+        sys.offset + sizeof(BufferSysData) <= sz)
+        track_ingress((BufferSysData *)((uint8_t *)ptr + sys.offset));
+
     uint32_t sent = 0;
     Result res;
 
+    dp_ingress_ns = telemetry::now_ns();
+
     res = _link->do_receive(ctx, ptr, sz, sent);
 
+    dp_ingress_ns = 0;
+
+    dp_link.unlock();
+
+    metrics.outbound_bytes += sent;
+
+    if (res == Result::success)
+        metrics.transactions_succeeded++;
+    else
+        metrics.transactions_failed++;
+
+    return res;
+}
+
+/**
+ * Transmit a buffer handle to the linked connection. The caller keeps its
+ * reference to the handle. The receiving side retains the handle if it needs
+ * the buffer after returning from the call.
+ */
+Result Connection::transmit(context::Context& ctx, BufferHandle *buf)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (state() != State::active)
+        return set_result(Result::error_wrong_state);
+
+    if (!buf || !buf->data || !buf->size)
+        return set_result(Result::error_no_buffer);
+
+    auto _link = (Connection *)dp_link.load_next_lock();
+
+    if (!_link) {
+        dp_link.unlock();
+        return set_result(Result::error_no_link_assigned);
+    }
+
+    metrics.inbound_bytes += buf->size;
+
+    track_ingress(buf->sysdata());
+
+    uint32_t sent = 0;
+    Result res;
+
+    if (!buf->ingress_ns)
+        buf->ingress_ns = telemetry::now_ns();
+
+    res = _link->do_receive(ctx, buf, sent);
+
     dp_link.unlock();
 
     metrics.outbound_bytes += sent;
@@ -262,6 +321,76 @@ Result Connection::transmit(context::Context& ctx, void *ptr, uint32_t sz)
     return res;
 }
 
+/**
+ * Transmit a burst of buffer handles to the linked connection in one call,
+ * which amortizes the per-call overhead of the data plane over the burst.
+ * The caller keeps its references to the handles.
+ */
+Result Connection::transmit_burst(context::Context& ctx, BufferHandle **bufs,
+                                  uint32_t count)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (state() != State::active)
+        return set_result(Result::error_wrong_state);
+
+    if (!bufs || !count)
+        return set_result(Result::error_no_buffer);
+
+    auto _link = (Connection *)dp_link.load_next_lock();
+
+    if (!_link) {
+        dp_link.unlock();
+        return set_result(Result::error_no_link_assigned);
+    }
+
+    uint64_t in = 0;
+    auto now = telemetry::now_ns();
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto buf = bufs[i];
+
+        in += buf->size;
+        track_ingress(buf->sysdata());
+
+        if (!buf->ingress_ns)
+            buf->ingress_ns = now;
+    }
+
+    metrics.inbound_bytes += in;
+
+    uint32_t sent = 0;
+    Result res;
+
+    res = _link->do_receive_burst(ctx, bufs, count, sent);
+
+    dp_link.unlock();
+
+    metrics.outbound_bytes += sent;
+
+    if (res == Result::success)
+        metrics.transactions_succeeded += count;
+    else
+        metrics.transactions_failed += count;
+
+    return res;
+}
+
+/**
+ * Check the sequence number and capture timestamp set by the sender.
+ * Buffers without a timestamp come from senders that do not fill in
+ * the system data and are ignored.
+ */
+void Connection::track_ingress(const BufferSysData *sysdata)
+{
+    if (_kind != Kind::receiver || !sysdata || !sysdata->timestamp_ns)
+        return;
+
+    metrics.seq.update(sysdata->seq);
+    metrics.capture_ns.record(telemetry::realtime_ns() - sysdata->timestamp_ns);
+}
+
 Result Connection::do_receive(context::Context& ctx, void *ptr, uint32_t sz,
                               uint32_t& sent)
 {
@@ -276,8 +405,15 @@ Result Connection::do_receive(context::Context& ctx, void *ptr, uint32_t sz,
     if (state() != State::active)
         return Result::error_wrong_state;
 
+    auto start_ns = telemetry::now_ns();
+
     Result res = on_receive(ctx, ptr, sz, sent);
 
+    auto end_ns = telemetry::now_ns();
+    metrics.receive_ns.record(end_ns - start_ns);
+    if (dp_ingress_ns)
+        metrics.e2e_ns.record(end_ns - dp_ingress_ns);
+
     metrics.outbound_bytes += sent;
     if (res == Result::success)
         metrics.transactions_succeeded++;
@@ -287,6 +423,76 @@ Result Connection::do_receive(context::Context& ctx, void *ptr, uint32_t sz,
     return res;
 }
 
+Result Connection::do_receive(context::Context& ctx, BufferHandle *buf,
+                              uint32_t& sent)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (!buf || !buf->data || !buf->size)
+        return set_result(Result::error_no_buffer);
+
+    metrics.inbound_bytes += buf->size;
+
+    if (state() != State::active)
+        return Result::error_wrong_state;
+
+    auto start_ns = telemetry::now_ns();
+
+    Result res = on_receive(ctx, buf, sent);
+
+    auto end_ns = telemetry::now_ns();
+    metrics.receive_ns.record(end_ns - start_ns);
+    if (buf->ingress_ns)
+        metrics.e2e_ns.record(end_ns - buf->ingress_ns);
+
+    metrics.outbound_bytes += sent;
+    if (res == Result::success)
+        metrics.transactions_succeeded++;
+    else
+        metrics.transactions_failed++;
+
+    return res;
+}
+
+Result Connection::do_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                                    uint32_t count, uint32_t& sent)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (!bufs || !count)
+        return set_result(Result::error_no_buffer);
+
+    uint64_t in = 0;
+    for (uint32_t i = 0; i < count; i++)
+        in += bufs[i]->size;
+
+    metrics.inbound_bytes += in;
+
+    if (state() != State::active)
+        return Result::error_wrong_state;
+
+    auto start_ns = telemetry::now_ns();
+
+    Result res = on_receive_burst(ctx, bufs, count, sent);
+
+    auto end_ns = telemetry::now_ns();
+    metrics.receive_ns.record(end_ns - start_ns);
+    for (uint32_t i = 0; i < count; i++) {
+        if (bufs[i]->ingress_ns)
+            metrics.e2e_ns.record(end_ns - bufs[i]->ingress_ns);
+    }
+
+    metrics.outbound_bytes += sent;
+    if (res == Result::success)
+        metrics.transactions_succeeded += count;
+    else
+        metrics.transactions_failed += count;
+
+    return res;
+}
+
 Result Connection::on_receive(context::Context& ctx, void *ptr, uint32_t sz,
                               uint32_t& sent)
 {
@@ -300,6 +506,47 @@ Result Connection::on_receive(context::Context& ctx, void *ptr, uint32_t sz,
     return Result::error_not_supported;
 }
 
+Result Connection::on_receive(context::Context& ctx, BufferHandle *buf,
+                              uint32_t& sent)
+{
+    // This is the default implementation for connections that consume
+    // the buffer synchronously. Derived classes that need the buffer after
+    // returning from the call must override this method and retain the handle.
+    //
+    // WARNING: This is the hot path of Data Plane.
+    // The method must return as soon as possible.
+    // Avoid any unnecessary operations that can increase latency.
+
+    return on_receive(ctx, buf->data, buf->size, sent);
+}
+
+Result Connection::on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                                    uint32_t count, uint32_t& sent)
+{
+    // This is the default implementation, which passes the buffers one by
+    // one. Derived classes that can process a burst at once, e.g. with one
+    // ring update, should override this method.
+    //
+    // WARNING: This is the hot path of Data Plane.
+    // The method must return as soon as possible.
+    // Avoid any unnecessary operations that can increase latency.
+
+    auto res = Result::success;
+    sent = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t buf_sent = 0;
+
+        auto r = on_receive(ctx, bufs[i], buf_sent);
+        if (r != Result::success)
+            res = r;
+
+        sent += buf_sent;
+    }
+
+    return res;
+}
+
 Result Connection::set_link(context::Context& ctx, Connection *new_link,
                             Connection *requester)
 {
@@ -339,7 +586,7 @@ void Connection::collect(telemetry::Metric& metric, const int64_t& timestamp_ms)
 {
     uint64_t in = metrics.inbound_bytes;
     uint64_t out = metrics.outbound_bytes;
-    uint32_t strn = metrics.transactions_succeeded;
+    uint64_t strn = metrics.transactions_succeeded;
 
     metric.addFieldString("state", state2str(state()));
     metric.addFieldBool("link", link() != nullptr);
@@ -377,6 +624,16 @@ void Connection::collect(telemetry::Metric& metric, const int64_t& timestamp_ms)
     auto errors_delta = metrics.errors - metrics.prev_errors;
     metrics.prev_errors = metrics.errors;
     metric.addFieldUint64("errd", errors_delta);
+
+    metrics.receive_ns.export_fields(metric, "rxlat");
+    metrics.e2e_ns.export_fields(metric, "e2elat");
+
+    if (_kind == Kind::receiver) {
+        metric.addFieldUint64("lost", metrics.seq.lost);
+        metric.addFieldUint64("dup", metrics.seq.duplicated);
+        metric.addFieldUint64("reord", metrics.seq.reordered);
+        metrics.capture_ns.export_fields(metric, "caplat");
+    }
 }
 
 static const char str_unknown[] = "?unknown?";
@@ -590,6 +847,10 @@ Result Config::assign_from_pb(const sdk::ConnectionConfig& config)
             const sdk::ConnectionOptionsRDMA& options_rdma = conn_options.rdma();
             options.rdma.provider = options_rdma.provider();
             options.rdma.num_endpoints = options_rdma.num_endpoints();
+            options.rdma.transport = options_rdma.transport();
+            options.rdma.completion = options_rdma.completion();
+            options.rdma.segment_size = options_rdma.segment_size();
+            options.rdma.flow_control = options_rdma.flow_control();
         }
     }
 
@@ -663,6 +924,10 @@ void Config::assign_to_pb(sdk::ConnectionConfig& config) const
     auto options_rdma = new sdk::ConnectionOptionsRDMA();
     options_rdma->set_provider(options.rdma.provider);
     options_rdma->set_num_endpoints(options.rdma.num_endpoints);
+    options_rdma->set_transport(options.rdma.transport);
+    options_rdma->set_completion(options.rdma.completion);
+    options_rdma->set_segment_size(options.rdma.segment_size);
+    options_rdma->set_flow_control(options.rdma.flow_control);
     conn_options->set_allocated_rdma(options_rdma);
 
     if (payload_type == PayloadType::PAYLOAD_TYPE_VIDEO) {
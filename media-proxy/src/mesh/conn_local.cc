@@ -6,11 +6,22 @@
 
 #include "conn_local.h"
 #include "logger.h"
+#include "proxy_config.h"
 #include <bsd/string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 namespace mesh::connection {
 
+// Set in the rx buffer handle cookie if the slot belongs to the relay region.
+static constexpr uint64_t rx_cookie_relay = 1ULL << 32;
+
+Local::~Local()
+{
+    rx_close();
+    relay_detach();
+}
+
 Result Local::configure_memif(context::Context& ctx, memif_ops_t *ops,
                               size_t frame_size, uint8_t log2_ring_size)
 {
@@ -48,6 +59,25 @@ Result Local::configure_memif(context::Context& ctx, memif_ops_t *ops,
              sizeof(memif_conn_args.interface_name), "%s", ops->interface_name);
     memif_conn_args.is_master = 1;
 
+    if (config::proxy.local.zero_copy_relay) {
+        bool producer = _kind == Kind::receiver;
+
+        relay = RelayRegion::attach(config.conn.multipoint_group.urn,
+                                    memif_conn_args.buffer_size,
+                                    1 << memif_conn_args.log2_ring_size,
+                                    producer);
+        if (relay && !producer) {
+            relay_slots = std::make_unique<uint32_t[]>(relay->ring_size);
+            std::fill_n(relay_slots.get(), relay->ring_size,
+                        RelayRegion::no_slot);
+        }
+    }
+
+    if (_kind == Kind::receiver) {
+        rx_ring_size = 1 << memif_conn_args.log2_ring_size;
+        rx_pending = std::make_unique<PendingSlot[]>(rx_ring_size);
+    }
+
     set_state(ctx, State::configured);
     return Result::success;
 }
@@ -79,6 +109,12 @@ Result Local::on_establish(context::Context& ctx)
 
     memif_conn_args.socket = memif_socket;
 
+    // Map the buffer region of the peer onto the relay region.
+    if (relay)
+        memif_register_external_region(memif_socket, NULL,
+                                       Local::callback_get_region_addr,
+                                       Local::callback_del_region, NULL);
+
     // log::debug("Create memif interface.");
     ret = memif_create(&memif_conn, &memif_conn_args,
                        Local::callback_on_connect,
@@ -93,9 +129,17 @@ Result Local::on_establish(context::Context& ctx)
     try {
         th = std::jthread([this]() {
             for (;;) {
-                int err = memif_poll_event(memif_socket, -1);
+                // Wake up periodically while ingress slots are held by
+                // consumers of the buffer handles. In the busy-poll mode,
+                // the poller returns the slots to the ring.
+                int timeout = rx_pending_count && !poller ? 1 : -1;
+
+                int err = memif_poll_event(memif_socket, timeout);
                 if (err)
                     break;
+
+                if (rx_pending_count && ready && !poller)
+                    rx_refill(0);
             }
         });
     }
@@ -114,6 +158,9 @@ int Local::callback_on_connect(memif_conn_handle_t conn, void *private_ctx)
     if (!_this)
         return MEMIF_ERR_INVAL_ARG;
 
+    if (_this->_kind == Kind::receiver && !_this->rx_open())
+        return MEMIF_ERR_NOMEM;
+
     int err = memif_refill_queue(_this->memif_conn, 0, -1, 0);
     if (err != MEMIF_ERR_SUCCESS) {
         log::error("memif_refill_queue: %s", memif_strerror(err));
@@ -123,6 +170,20 @@ int Local::callback_on_connect(memif_conn_handle_t conn, void *private_ctx)
 
     _this->ready = true;
 
+    // Disable interrupts and hand the ingress ring over to a poller.
+    if (config::proxy.local.busy_poll && _this->_kind == Kind::receiver) {
+        err = memif_set_rx_mode(_this->memif_conn, MEMIF_RX_MODE_POLLING, 0);
+        if (err == MEMIF_ERR_SUCCESS)
+            _this->poller = LocalPoller::attach(_this);
+        else
+            log::error("memif_set_rx_mode: %s", memif_strerror(err));
+
+        if (!_this->poller) {
+            memif_set_rx_mode(_this->memif_conn, MEMIF_RX_MODE_INTERRUPT, 0);
+            log::warn("Local conn: busy-poll unavailable, using interrupts");
+        }
+    }
+
     print_memif_details(_this->memif_conn);
 
     // log::debug("Memif ready");
@@ -139,8 +200,17 @@ int Local::callback_on_disconnect(memif_conn_handle_t conn, void *private_ctx)
     if (!_this->ready)
         return MEMIF_ERR_SUCCESS;
 
+    if (_this->poller) {
+        _this->poller->detach(_this);
+        _this->poller = nullptr;
+    }
+
     _this->ready = false;
 
+    // The ring memory is unmapped after this callback returns. The buffer
+    // handles still held by consumers point into the session's own mappings.
+    _this->rx_close();
+
     auto err = memif_cancel_poll_event(_this->memif_socket);
     if (err != MEMIF_ERR_SUCCESS) {
         log::error("on_disconnect memif_cancel_poll_event: %s",
@@ -158,39 +228,365 @@ int Local::callback_on_interrupt(memif_conn_handle_t conn, void *private_ctx,
     if (!_this)
         return MEMIF_ERR_INVAL_ARG;
 
-    int err = 0;
-    memif_buffer_t shm_bufs = { 0 };
-    uint16_t buf_num = 0;
-
     if (!_this->ready) {
         log::warn("Memif conn already stopped.");
         return -1;
     }
 
-    // Receive packets from the shared memory
-    err = memif_rx_burst(_this->memif_conn, qid, &shm_bufs, 1, &buf_num);
+    // An interrupt signalled before the rx mode has been switched.
+    // The poller clears it on the next empty poll.
+    if (_this->poller)
+        return 0;
+
+    uint16_t received;
+    return _this->rx_burst(qid, received);
+}
+
+/**
+ * Called by the poller thread to drain the ingress ring without waiting
+ * for an interrupt. Returns the number of buffers received.
+ */
+uint16_t Local::poll_rx()
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    uint16_t received = 0;
+
+    rx_burst(0, received);
+
+    // Return the slots released by consumers meanwhile.
+    if (!received && rx_pending_count)
+        rx_refill(0);
+
+    return received;
+}
+
+/**
+ * Receive a burst of buffers from the ingress ring, pass it to the link,
+ * and return the released slots to the ring.
+ */
+int Local::rx_burst(uint16_t qid, uint16_t& received)
+{
+    int err = 0;
+    memif_buffer_t shm_bufs[burst_max] = {};
+    BufferHandle *bufs[burst_max];
+    uint16_t buf_num = 0;
+    uint16_t count = 0;
+
+    received = 0;
+
+    // Receive a burst of packets from the shared memory
+    err = memif_rx_burst(memif_conn, qid, shm_bufs, burst_max, &buf_num);
     if (err != MEMIF_ERR_SUCCESS && err != MEMIF_ERR_NOBUF) {
         log::error("memif_rx_burst: %s", memif_strerror(err));
-        _this->metrics.errors++;
+        metrics.errors++;
         return err;
     }
 
-    if (shm_bufs.data && shm_bufs.len)
-        _this->on_memif_receive(shm_bufs.data, shm_bufs.len);
+    if (!buf_num)
+        return 0;
+
+    received = buf_num;
+
+    auto now = telemetry::now_ns();
+
+    for (uint16_t i = 0; i < buf_num; i++) {
+        auto& shm_buf = shm_bufs[i];
+
+        // Hold the ring slot until all consumers release the buffer handle.
+        // With the zero-copy relay, the slot is also held by the egress
+        // connections that point their descriptors at it.
+        auto& pending = rx_pending[(rx_pending_head + rx_pending_count) %
+                                   rx_ring_size];
+        rx_pending_count++;
+
+        // Relay slots are held by the relay region itself. Other buffers
+        // are passed in the session's own mapping of the memif region.
+        bool relay_slot = false;
+        void *data = nullptr;
+        if (shm_buf.data && shm_buf.len) {
+            relay_slot = relay_active() && relay->is_slot(shm_buf.data, shm_buf.len);
+            data = relay_slot ? shm_buf.data : rx_map(shm_buf.data, shm_buf.len);
+            if (!data) {
+                log::error("Local conn: rx buffer outside memif regions");
+                metrics.errors++;
+            }
+        }
+
+        auto buf = data ? rx_pool->alloc() : nullptr;
+        if (!buf) {
+            if (data) {
+                log::error("Local conn: rx buffer pool exhausted");
+                metrics.errors++;
+            }
+
+            // Return the slot to the ring in order with the other slots.
+            pending.slot = shm_buf.desc_index & (rx_ring_size - 1);
+            pending.relay = false;
+            rx_refs[pending.slot].store(0, std::memory_order_release);
+            continue;
+        }
+
+        buf->data = data;
+        buf->size = shm_buf.len;
+        buf->ingress_ns = now;
+        buf->ring_slot = true;
+        buf->on_release = Local::on_rx_buffer_release;
+
+        if (relay_slot) {
+            pending.slot = relay->slot_of(shm_buf.data);
+            pending.relay = true;
+            relay->hold(pending.slot);
+            buf->owner = relay;
+            buf->cookie = pending.slot | rx_cookie_relay;
+        } else {
+            pending.slot = shm_buf.desc_index & (rx_ring_size - 1);
+            pending.relay = false;
+            rx_refs[pending.slot].store(1, std::memory_order_release);
+            buf->owner = &rx_refs[pending.slot];
+            buf->cookie = pending.slot;
+        }
+
+        bufs[count++] = buf;
+    }
 
-    err = memif_refill_queue(_this->memif_conn, qid, buf_num, 0);
+    if (count)
+        on_memif_receive(bufs, count);
+
+    for (uint16_t i = 0; i < count; i++)
+        bufs[i]->release();
+
+    rx_refill(qid);
+
+    return 0;
+}
+
+void Local::on_rx_buffer_release(BufferHandle *buf)
+{
+    if (buf->cookie & rx_cookie_relay)
+        static_cast<RelayRegion *>(buf->owner)->release((uint32_t)buf->cookie);
+    else
+        static_cast<std::atomic<uint32_t> *>(buf->owner)->fetch_sub(1,
+                                                std::memory_order_acq_rel);
+}
+
+/**
+ * Return the ring slots released by all consumers to the memif ring,
+ * preserving the order in which they were received.
+ */
+void Local::rx_refill(uint16_t qid)
+{
+    if (relay_active())
+        relay->reclaim_consumers();
+
+    uint16_t count = 0;
+    while (rx_pending_count) {
+        auto& pending = rx_pending[rx_pending_head];
+
+        bool released = pending.relay ?
+                        relay->is_released(pending.slot) :
+                        rx_refs[pending.slot].load(std::memory_order_acquire) == 0;
+        if (!released)
+            break;
+
+        rx_pending_head = (rx_pending_head + 1) % rx_ring_size;
+        rx_pending_count--;
+        count++;
+    }
+
+    if (!count)
+        return;
+
+    int err = memif_refill_queue(memif_conn, qid, count, 0);
     if (err != MEMIF_ERR_SUCCESS) {
         log::error("memif_refill_queue: %s", memif_strerror(err));
-        _this->metrics.errors++;
+        metrics.errors++;
     }
+}
 
-    return 0;
+/**
+ * Open a session of the ingress ring. The memif regions are mapped once more,
+ * so the buffer handles held by consumers stay valid after libmemif unmaps
+ * the regions on disconnect. The mappings, the slot reference counters and
+ * the regions published for zero-copy transmission are freed with the
+ * buffer pool of the session, after the last handle is released.
+ */
+bool Local::rx_open()
+{
+    rx_close();
+
+    memif_details_t md = {};
+    std::vector<char> buf(2048);
+
+    int err = memif_get_details(memif_conn, &md, buf.data(), buf.size());
+    if (err != MEMIF_ERR_SUCCESS) {
+        log::error("memif_get_details: %s", memif_strerror(err));
+        return false;
+    }
+
+    rx_pool = new(std::nothrow) BufferPool(config.buf_parts);
+    if (!rx_pool || !rx_pool->init(rx_ring_size)) {
+        log::error("Local conn: rx buffer pool alloc failed")
+                  ("ring_size", rx_ring_size);
+        if (rx_pool)
+            rx_pool->destroy();
+        rx_pool = nullptr;
+        return false;
+    }
+
+    auto refs = new(std::nothrow) std::atomic<uint32_t>[rx_ring_size]();
+    if (!refs) {
+        rx_close();
+        return false;
+    }
+    rx_pool->on_destroy([refs]() { delete[] refs; });
+    rx_refs = refs;
+
+    if (relay) {
+        relay->attach_ref();
+        rx_pool->on_destroy([region = relay]() { region->detach(false); });
+    }
+
+    for (int i = 0; i < md.regions_num; i++) {
+        auto& region = md.regions[i];
+        if (!region.addr || !region.size)
+            continue;
+
+        void *addr = region.addr;
+
+        if (!relay || region.addr != relay->addr) {
+            addr = mmap(NULL, region.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        region.fd, 0);
+            if (addr == MAP_FAILED) {
+                log::error("Local conn: memif region mapping failed")
+                          ("size", region.size)("error", strerror(errno));
+                rx_close();
+                return false;
+            }
+
+            auto size = region.size;
+            rx_pool->on_destroy([addr, size]() { munmap(addr, size); });
+            rx_maps.push_back({ (uint8_t *)region.addr, (uint8_t *)addr, size });
+        }
+
+        // Publish the region, so the RDMA transmitter can register it
+        // and send the received buffers without copying.
+        if (config::proxy.rdma.zero_copy_tx) {
+            auto id = MemoryRegions::add(addr, region.size);
+            rx_pool->on_destroy([id]() { MemoryRegions::remove(id); });
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Close the session of the ingress ring. Its resources are freed when the
+ * consumers release the last buffer handle, which may be right away.
+ */
+void Local::rx_close()
+{
+    if (!rx_pool)
+        return;
+
+    rx_pool->destroy();
+    rx_pool = nullptr;
+    rx_refs = nullptr;
+    rx_maps.clear();
+
+    rx_pending_head = 0;
+    rx_pending_count = 0;
+}
+
+/**
+ * Translate the address of a buffer in a memif region to the session's own
+ * mapping of the region. Returns nullptr if the buffer is outside the regions.
+ */
+void * Local::rx_map(void *data, uint32_t len) const
+{
+    auto ptr = static_cast<uint8_t *>(data);
+
+    for (auto& map : rx_maps) {
+        if (ptr >= map.memif_addr && ptr + len <= map.memif_addr + map.size)
+            return map.addr + (ptr - map.memif_addr);
+    }
+
+    return nullptr;
+}
+
+void * Local::callback_get_region_addr(uint32_t size, int fd,
+                                       void *private_ctx)
+{
+    auto _this = static_cast<Local *>(private_ctx);
+    if (!_this || !_this->relay)
+        return NULL;
+
+    if (size == _this->relay->size && _this->relay->is_same_file(fd)) {
+        {
+            std::lock_guard<std::mutex> lk(_this->relay_mx);
+            _this->relay_connected = true;
+        }
+        if (_this->_kind == Kind::transmitter)
+            _this->relay->add_consumer(_this);
+
+        return _this->relay->addr;
+    }
+
+    // The peer has not mapped the relay region, e.g. an older SDK.
+    // Map the peer's own region and fall back to copying.
+    log::warn("Local %s conn: relay region not mapped by peer",
+              kind2str(_this->_kind, true))("size", size);
+
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+int Local::callback_del_region(void *addr, uint32_t size, int fd,
+                               void *private_ctx)
+{
+    auto _this = static_cast<Local *>(private_ctx);
+    if (!_this)
+        return MEMIF_ERR_INVAL_ARG;
+
+    if (_this->_kind == Kind::transmitter)
+        _this->relay->remove_consumer(_this);
+
+    {
+        std::lock_guard<std::mutex> lk(_this->relay_mx);
+
+        if (_this->relay_connected)
+            _this->on_relay_disconnect();
+        else if (addr)
+            munmap(addr, size);
+
+        _this->relay_connected = false;
+    }
+
+    if (fd >= 0)
+        close(fd);
+
+    return MEMIF_ERR_SUCCESS;
+}
+
+void Local::relay_detach()
+{
+    if (!relay)
+        return;
+
+    relay->detach(_kind == Kind::receiver);
+    relay = nullptr;
 }
 
 Result Local::on_shutdown(context::Context& ctx)
 {
     // log::debug("Memif shutdown");
 
+    if (poller) {
+        poller->detach(this);
+        poller = nullptr;
+    }
+
     auto err = memif_cancel_poll_event(memif_socket);
     if (err != MEMIF_ERR_SUCCESS) {
         log::error("on_shutdown memif_cancel_poll_event: %s",
@@ -204,6 +600,9 @@ Result Local::on_shutdown(context::Context& ctx)
     memif_delete(&memif_conn);
     memif_delete_socket(&memif_socket);
 
+    rx_close();
+    relay_detach();
+
     // Unlink socket file
     if (memif_socket_args.path[0] != '@')
         unlink(memif_socket_args.path);
@@ -0,0 +1,30 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "conn_local_poller.h"
+#include "conn_local.h"
+#include "proxy_config.h"
+#include <immintrin.h>
+
+namespace mesh::connection {
+
+const std::vector<int>& LocalPoller::cpus()
+{
+    return config::proxy.local.busy_poll_cpus;
+}
+
+uint32_t LocalPoller::poll(Local *conn)
+{
+    return conn->poll_rx();
+}
+
+void LocalPoller::idle(uint32_t work, int& idle_cycles)
+{
+    if (!work)
+        _mm_pause();
+}
+
+} // namespace mesh::connection
@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "conn_local_relay.h"
+#include "conn_local.h"
+#include "logger.h"
+#include "uuid.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unordered_map>
+
+namespace mesh::connection {
+
+static std::unordered_map<std::string, RelayRegion *> relay_regions;
+static std::mutex relay_regions_mx;
+
+RelayRegion::RelayRegion(const std::string& urn, uint32_t buffer_size,
+                         uint32_t ring_size)
+    : addr(MAP_FAILED), buffer_size(buffer_size), ring_size(ring_size),
+      urn(urn), base(nullptr), fd(-1), next_pool_slot(0), attached(0),
+      has_producer(false)
+{
+    // Two rings, slave-to-master and master-to-slave, as laid out by libmemif.
+    uint32_t num_slots = ring_size * 2;
+    size = buffer_size * num_slots;
+
+    refs = std::make_unique<std::atomic<uint32_t>[]>(num_slots);
+
+    path = "/run/mcm/relay_" + generate_uuid_v4() + ".shm";
+
+    auto err = mkdir("/run/mcm", 0666);
+    if (err && errno != EEXIST) {
+        log::error("Relay region mkdir failed (%d)", errno);
+        return;
+    }
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) {
+        log::error("Relay region open failed (%d)", errno)("path", path);
+        return;
+    }
+
+    if (ftruncate(fd, size) < 0) {
+        log::error("Relay region ftruncate failed (%d)", errno)("size", size);
+        return;
+    }
+
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        log::error("Relay region mmap failed (%d)", errno)("size", size);
+        return;
+    }
+
+    base = (uint8_t *)addr;
+}
+
+RelayRegion::~RelayRegion()
+{
+    if (addr != MAP_FAILED)
+        munmap(addr, size);
+    if (fd >= 0) {
+        close(fd);
+        unlink(path.c_str());
+    }
+}
+
+/**
+ * Attach to the relay region of the multipoint group identified by the urn.
+ * A new region is created if the group has none. Returns nullptr if the
+ * existing region has a different geometry or already has a producer,
+ * which makes the connection fall back to copying.
+ */
+RelayRegion * RelayRegion::attach(const std::string& urn, uint32_t buffer_size,
+                                  uint32_t ring_size, bool producer)
+{
+    if (urn.empty() || !buffer_size || !ring_size)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lk(relay_regions_mx);
+
+    RelayRegion *region;
+
+    auto it = relay_regions.find(urn);
+    if (it != relay_regions.end()) {
+        region = it->second;
+        if (region->buffer_size != buffer_size ||
+            region->ring_size != ring_size ||
+            (producer && region->has_producer)) {
+            log::warn("Relay region mismatch, fall back to copying")
+                     ("urn", urn)("buffer_size", buffer_size)
+                     ("ring_size", ring_size)("producer", producer);
+            return nullptr;
+        }
+    } else {
+        region = new(std::nothrow) RelayRegion(urn, buffer_size, ring_size);
+        if (!region)
+            return nullptr;
+
+        if (!region->base) {
+            delete region;
+            return nullptr;
+        }
+        relay_regions[urn] = region;
+    }
+
+    region->attached++;
+    if (producer)
+        region->has_producer = true;
+
+    return region;
+}
+
+void RelayRegion::detach(bool producer)
+{
+    std::lock_guard<std::mutex> lk(relay_regions_mx);
+
+    if (producer)
+        has_producer = false;
+
+    if (--attached > 0)
+        return;
+
+    relay_regions.erase(urn);
+    delete this;
+}
+
+/**
+ * Take one more attachment of a region the caller is attached to, dropped
+ * by detach(false). Keeps the region while buffer handles point into it.
+ */
+void RelayRegion::attach_ref()
+{
+    std::lock_guard<std::mutex> lk(relay_regions_mx);
+    attached++;
+}
+
+void RelayRegion::add_consumer(Local *conn)
+{
+    std::lock_guard<std::mutex> lk(consumers_mx);
+    consumers.push_back(conn);
+}
+
+void RelayRegion::remove_consumer(Local *conn)
+{
+    std::lock_guard<std::mutex> lk(consumers_mx);
+    consumers.remove(conn);
+}
+
+/**
+ * Collect the slots returned by the slaves of all egress connections.
+ * Called by the ingress connection while it has slots waiting for release.
+ */
+void RelayRegion::reclaim_consumers()
+{
+    std::lock_guard<std::mutex> lk(consumers_mx);
+    for (auto conn : consumers)
+        conn->relay_reclaim();
+}
+
+bool RelayRegion::is_same_file(int other_fd) const
+{
+    struct stat a, b;
+    if (fstat(fd, &a) || fstat(other_fd, &b))
+        return false;
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+void RelayRegion::hold(uint32_t slot)
+{
+    refs[slot].store(1, std::memory_order_release);
+}
+
+void RelayRegion::retain(uint32_t slot)
+{
+    refs[slot].fetch_add(1, std::memory_order_acq_rel);
+}
+
+void RelayRegion::release(uint32_t slot)
+{
+    refs[slot].fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool RelayRegion::is_released(uint32_t slot) const
+{
+    return refs[slot].load(std::memory_order_acquire) == 0;
+}
+
+/**
+ * Allocate a slot from the pool in the upper half of the region.
+ * The allocated slot is returned with one reference held.
+ */
+bool RelayRegion::alloc_slot(uint32_t& slot)
+{
+    for (uint32_t i = 0; i < ring_size; i++) {
+        auto idx = ring_size +
+                   next_pool_slot.fetch_add(1, std::memory_order_relaxed) % ring_size;
+        uint32_t expected = 0;
+        if (refs[idx].compare_exchange_strong(expected, 1,
+                                              std::memory_order_acq_rel)) {
+            slot = idx;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace mesh::connection
@@ -23,20 +23,20 @@ void LocalRx::default_memif_ops(memif_ops_t *ops)
     strncpy(ops->socket_path, "/run/mcm/mcm_tx_memif.sock", sizeof(ops->socket_path));
 }
 
-int LocalRx::on_memif_receive(void *ptr, uint32_t sz)
+int LocalRx::on_memif_receive(BufferHandle **bufs, uint16_t count)
 {
     if (!link() && !no_link_reported) {
         no_link_reported = true;
         log::warn("Local %s conn: no link", kind2str(_kind, true));
     }
 
-    auto res = transmit(context::Background(), ptr, sz);
+    auto res = transmit_burst(context::Background(), bufs, count);
     switch (res) {
     case Result::error_no_link_assigned:
     case Result::success:
         return 0;
     default:
-        log::error("Local Rx conn transmit err: %s", result2str(res))("sz", sz);
+        log::error("Local Rx conn transmit err: %s", result2str(res))("count", count);
         return -1;
     }
 }
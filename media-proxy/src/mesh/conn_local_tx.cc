@@ -6,6 +6,7 @@
 
 #include "conn_local_tx.h"
 #include <string.h>
+#include <algorithm>
 #include "logger.h"
 
 namespace mesh::connection {
@@ -22,44 +23,188 @@ void LocalTx::default_memif_ops(memif_ops_t *ops)
     strncpy(ops->socket_path, "/run/mcm/mcm_rx_memif.sock", sizeof(ops->socket_path));
 }
 
-int LocalTx::on_memif_receive(void *ptr, uint32_t sz)
+int LocalTx::on_memif_receive(BufferHandle **bufs, uint16_t count)
 {
-    log::warn("SHOULD NEVER HAPPEN on_memif_receive %d", sz);
+    log::warn("SHOULD NEVER HAPPEN on_memif_receive %d", count);
     return 0;
 }
 
+/**
+ * Release the relay slots of the tx descriptors the peer has consumed.
+ * Must be called with relay_mx locked.
+ */
+void LocalTx::reclaim_slots()
+{
+    uint16_t released;
+    int err = memif_get_tx_released(memif_conn, 0, &released);
+    if (err != MEMIF_ERR_SUCCESS)
+        return;
+
+    uint32_t mask = relay->ring_size - 1;
+
+    while ((int16_t)(released - relay_reclaimed) > 0) {
+        auto& slot = relay_slots[relay_reclaimed & mask];
+        if (slot != RelayRegion::no_slot) {
+            relay->release(slot);
+            slot = RelayRegion::no_slot;
+        }
+        relay_reclaimed++;
+    }
+}
+
+void LocalTx::relay_reclaim()
+{
+    std::lock_guard<std::mutex> lk(relay_mx);
+
+    if (relay_active())
+        reclaim_slots();
+}
+
+void LocalTx::on_relay_disconnect()
+{
+    for (uint32_t i = 0; i < relay->ring_size; i++) {
+        if (relay_slots[i] != RelayRegion::no_slot) {
+            relay->release(relay_slots[i]);
+            relay_slots[i] = RelayRegion::no_slot;
+        }
+    }
+    relay_reclaimed = 0;
+}
+
 Result LocalTx::on_receive(context::Context& ctx, void *ptr, uint32_t sz,
                            uint32_t& sent)
+{
+    return send_burst(&ptr, &sz, 1, sent);
+}
+
+Result LocalTx::on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                                 uint32_t count, uint32_t& sent)
+{
+    void *ptrs[burst_max];
+    uint32_t sizes[burst_max];
+
+    count = std::min(count, burst_max);
+
+    for (uint32_t i = 0; i < count; i++) {
+        ptrs[i] = bufs[i]->data;
+        sizes[i] = bufs[i]->size;
+    }
+
+    return send_burst(ptrs, sizes, count, sent);
+}
+
+/**
+ * Send a burst of frames to the microservice application with a single
+ * descriptor allocation and a single ring update.
+ */
+Result LocalTx::send_burst(void **ptrs, uint32_t *sizes, uint16_t count,
+                           uint32_t& sent)
 {
     uint16_t qid = 0;
-    uint16_t buf_num = 1;
-    uint16_t rx_buf_num = 0, rx = 0;
+    uint16_t alloc_num = 0, tx = 0;
     uint32_t buf_size = frame_size;
-    memif_buffer_t shm_bufs = {};
+    memif_buffer_t shm_bufs[burst_max] = {};
+    uint32_t slots[burst_max];
+    bool copy[burst_max];
+
+    sent = 0;
+
+    // Zero-copy relay. If a frame resides in a slot of the relay region,
+    // the tx descriptor is pointed at the slot. Otherwise, the frame is
+    // copied to a slot allocated from the pool of the region.
+    std::unique_lock<std::mutex> lk(relay_mx, std::defer_lock);
+    bool relay_on = false;
+
+    if (relay) {
+        lk.lock();
+        relay_on = relay_active();
+        if (relay_on)
+            reclaim_slots();
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        slots[i] = RelayRegion::no_slot;
+        copy[i] = true;
+
+        if (!relay_on)
+            continue;
+
+        if (relay->is_slot(ptrs[i], sizes[i])) {
+            slots[i] = relay->slot_of(ptrs[i]);
+            relay->retain(slots[i]);
+            copy[i] = false;
+        } else if (!relay->alloc_slot(slots[i])) {
+            log::error("Local Tx: relay pool exhausted");
+            release_slots(slots, i);
+            return set_result(Result::error_no_buffer);
+        }
+    }
 
-    int err = memif_buffer_alloc_timeout(memif_conn, qid, &shm_bufs, buf_num,
-                                         &rx_buf_num, buf_size, 10);
+    int err = memif_buffer_alloc_timeout(memif_conn, qid, shm_bufs, count,
+                                         &alloc_num, buf_size, 10);
     if (err != MEMIF_ERR_SUCCESS) {
         log::error("Failed to alloc memif buffer: %s", memif_strerror(err));
+        release_slots(slots, count);
         return set_result(Result::error_general_failure);
     }
 
-    if (!shm_bufs.data) {
-        log::error("Local Tx: shm_bufs.data == NULL");
-        return set_result(Result::error_general_failure);
+    // Frames that did not get a descriptor are dropped.
+    if (alloc_num < count) {
+        release_slots(slots + alloc_num, count - alloc_num);
+        metrics.errors += count - alloc_num;
     }
 
-    memcpy(shm_bufs.data, ptr, sz);
-    sent = sz;
+    for (uint16_t i = 0; i < alloc_num; i++) {
+        auto& shm_buf = shm_bufs[i];
+        auto slot = slots[i];
+
+        if (slot != RelayRegion::no_slot) {
+            err = memif_buffer_set_offset(memif_conn, qid, &shm_buf,
+                                          relay->offset_of(slot));
+            if (err != MEMIF_ERR_SUCCESS) {
+                log::error("Local Tx: relay set offset: %s", memif_strerror(err));
+                relay->release(slot);
+                slot = RelayRegion::no_slot;
+                copy[i] = true;
+            }
+        }
+
+        if (relay_on) {
+            auto& held = relay_slots[shm_buf.desc_index & (relay->ring_size - 1)];
+            if (held != RelayRegion::no_slot)
+                relay->release(held);
+            held = slot;
+        }
+
+        if (!shm_buf.data) {
+            log::error("Local Tx: shm_bufs.data == NULL");
+            return set_result(Result::error_general_failure);
+        }
+
+        if (copy[i])
+            memcpy(shm_buf.data, ptrs[i], sizes[i]);
+        sent += sizes[i];
+    }
 
     // Send to microservice application
-    err = memif_tx_burst(memif_conn, qid, &shm_bufs, rx_buf_num, &rx);
+    err = memif_tx_burst(memif_conn, qid, shm_bufs, alloc_num, &tx);
     if (err != MEMIF_ERR_SUCCESS) {
         log::error("Error in memif_tx_burst: %s", memif_strerror(err));
         metrics.errors++;
     }
 
+    if (alloc_num < count)
+        return set_result(Result::error_no_buffer);
+
     return set_result(Result::success);
 }
 
+void LocalTx::release_slots(uint32_t *slots, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        if (slots[i] != RelayRegion::no_slot)
+            relay->release(slots[i]);
+    }
+}
+
 } // namespace mesh::connection
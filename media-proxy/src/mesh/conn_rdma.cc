@@ -1,12 +1,68 @@
-#include <queue>
 #include "conn_rdma.h"
+#include "conn_rdma_progress.h"
+#include "conn_rdma_srx.h"
+#include "proxy_config.h"
 #include <netinet/in.h>   // for sockaddr_in
 #include <arpa/inet.h>    // for ntohs/htons
+#include <immintrin.h>
+#include <poll.h>
+#include <fstream>
+#include <cerrno>
+#include <cstddef>
+#include <net/if.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <unistd.h>
+
+#ifndef MFD_HUGE_2MB
+#define MFD_HUGE_2MB (21U << 26)
+#define MFD_HUGE_1GB (30U << 26)
+#endif
 
 namespace mesh::connection {
 
 std::atomic<int> Rdma::active_connections(0);
 
+// Split a comma-separated list of addresses
+static std::vector<std::string> split_addrs(const char *list)
+{
+    std::vector<std::string> addrs;
+
+    if (!list)
+        return addrs;
+
+    std::string str(list);
+    size_t pos = 0;
+    while (pos <= str.size()) {
+        auto end = str.find(',', pos);
+        if (end == std::string::npos)
+            end = str.size();
+        if (end > pos)
+            addrs.push_back(str.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    return addrs;
+}
+
+// Get the NUMA node of the network interface having the address, or -1
+int Rdma::nic_numa_node(const char *ip)
+{
+    char if_name[IF_NAMESIZE];
+
+    if (!ip || !*ip || get_interface_name_by_ip(ip, if_name, sizeof(if_name)))
+        return -1;
+
+    std::ifstream f(std::string("/sys/class/net/") + if_name + "/device/numa_node");
+    int node = -1;
+    if (!(f >> node))
+        return -1;
+
+    return node;
+}
+
 Rdma::Rdma()
   : ep_ctxs{}    
   , init(false)
@@ -30,7 +86,7 @@ void Rdma::deinit_rdma_if_needed(libfabric_ctx *m_dev_handle)
     static std::mutex deinit_mutex;
     std::lock_guard<std::mutex> lock(deinit_mutex);
 
-    if (active_connections == 0 && m_dev_handle) {
+    if (m_dev_handle) {
         int ret = libfabric_dev_ops.rdma_deinit(&m_dev_handle);
         if (ret) {
             log::error("Failed to deinitialize RDMA device")("error", fi_strerror(-ret));
@@ -51,8 +107,9 @@ void Rdma::init_buf_available() { buf_available = false; }
 
 void Rdma::notify_buf_available()
 {
-    buf_available.store(true, std::memory_order_release);
-    buf_available.notify_one();
+    // Skip the wake-up syscall if the flag is already raised.
+    if (!buf_available.exchange(true, std::memory_order_release))
+        buf_available.notify_one();
 }
 
 void Rdma::wait_buf_available()
@@ -61,38 +118,60 @@ void Rdma::wait_buf_available()
     buf_available = false;
 }
 
-// Add to queue
+// Add to queue. Wakes up a thread blocked in consume_from_queue().
 Result Rdma::add_to_queue(void *element)
 {
     if (!element) {
         return set_result(Result::error_bad_argument);
     }
 
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-        buffer_queue.push(element);
+    if (buf_posted) {
+        size_t slot = (static_cast<char *>(element) - static_cast<char *>(buffer_block)) /
+                      ring_slot_size();
+        buf_posted[slot].store(false, std::memory_order_relaxed);
+    }
+
+    if (!buffer_ring.push(element)) {
+        log::error("RDMA buffer queue overflow")("capacity", buffer_ring.capacity());
+        return set_result(Result::error_general_failure);
     }
-    notify_buf_available(); // Notify availability
 
     return Result::success;
 }
 
-// Consume from queue
+// Consume from queue without blocking
 Result Rdma::consume_from_queue(context::Context& ctx, void **element)
 {
-    std::unique_lock<std::mutex> lock(queue_mutex);
-
     if (ctx.cancelled()) {
         *element = nullptr; // Ensure element remains nullptr
         return Result::error_context_cancelled;
     }
 
-    if (buffer_queue.empty()) {
+    if (!buffer_ring.pop(*element)) {
         return Result::error_no_buffer;
     }
 
-    *element = buffer_queue.front();
-    buffer_queue.pop();
+    return Result::success;
+}
+
+/**
+ * Consume from queue, blocking while the queue is empty. The caller is
+ * woken up as soon as a buffer is returned to the queue or the context
+ * is cancelled. The maximum timeout value means no timeout.
+ */
+Result Rdma::consume_from_queue(context::Context& ctx, void **element,
+                                std::chrono::nanoseconds timeout)
+{
+    if (ctx.cancelled()) {
+        *element = nullptr;
+        return Result::error_context_cancelled;
+    }
+
+    if (!buffer_ring.pop_wait(ctx, *element, timeout)) {
+        *element = nullptr;
+        return ctx.cancelled() ? Result::error_context_cancelled :
+                                 Result::error_timeout;
+    }
 
     return Result::success;
 }
@@ -116,20 +195,23 @@ Result Rdma::init_queue_with_elements(size_t capacity, size_t trx_sz)
         return Result::error_bad_argument;
     }
 
-    std::lock_guard<std::mutex> lock(queue_mutex);
-
     // Check if already initialized
-    if (!buffer_queue.empty()) {
+    if (!buffer_ring.empty()) {
         log::error("RDMA buffer queue already initialized");
         return Result::error_already_initialized;
     }
 
+    if (capacity > buffer_ring.capacity() && !buffer_ring.init(capacity)) {
+        log::error("RDMA failed to allocate the buffer queue")("capacity", capacity);
+        return Result::error_out_of_memory;
+    }
+
     // Calculate total memory size needed and align to page size
     size_t aligned_trx_sz = ((trx_sz + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
     size_t total_size = capacity * aligned_trx_sz;
 
     // Allocate a single contiguous memory block
-    void *memory_block = std::aligned_alloc(PAGE_SIZE, total_size);
+    void *memory_block = alloc_block(total_size);
     if (!memory_block) {
         log::error("RDMA failed to allocate a single memory block")("total_size", total_size);
         return Result::error_out_of_memory;
@@ -142,7 +224,7 @@ Result Rdma::init_queue_with_elements(size_t capacity, size_t trx_sz)
     char *base_ptr = static_cast<char *>(memory_block);
     for (size_t i = 0; i < capacity; ++i) {
         void *buf = base_ptr + i * aligned_trx_sz;
-        buffer_queue.push(buf);
+        buffer_ring.push(buf);
     }
 
     // Store the base memory block for cleanup
@@ -154,13 +236,162 @@ Result Rdma::init_queue_with_elements(size_t capacity, size_t trx_sz)
 // Cleanup the buffer queue
 void Rdma::cleanup_queue()
 {
-    if (buffer_block) {
-        // Free the entire memory block
-        std::free(buffer_block);
-        buffer_block = nullptr;
+    // Free the entire memory block
+    free_block();
+
+    void *buf;
+    while (buffer_ring.pop(buf)) {
+    }
+}
+
+/**
+ * @brief Maps the buffer block on the NUMA node of the NIC, backed by
+ * hugepages if configured.
+ *
+ * Hugepages are reserved with fallocate() under a memory policy bound to
+ * the node, so a shortage of hugepages fails here rather than faulting later.
+ * It falls back to regular pages, which prefer the node and are placed when
+ * first touched.
+ *
+ * @return The block, or nullptr if out of memory.
+ */
+void *Rdma::alloc_block(size_t size)
+{
+    int node = nic_numa_node(ep_cfg.local_addr.ip);
+    unsigned long nodemask = node >= 0 && node < 64 ? 1UL << node : 0;
+    size_t page = config::proxy.rdma.hugepage_size;
+    void *block = MAP_FAILED;
+
+    if (page) {
+        size_t mapped = (size + page - 1) / page * page;
+        unsigned int flags = MFD_CLOEXEC | MFD_HUGETLB |
+                             (page == 1UL << 30 ? MFD_HUGE_1GB : MFD_HUGE_2MB);
+
+        int fd = memfd_create("mcm-rdma-pool", flags);
+        if (fd >= 0) {
+            if (nodemask)
+                syscall(SYS_set_mempolicy, MPOL_BIND, &nodemask, 64);
+
+            if (!fallocate(fd, 0, 0, mapped))
+                block = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, 0);
+
+            if (nodemask)
+                syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+            close(fd);
+        }
+
+        if (block != MAP_FAILED) {
+            size = mapped;
+        } else {
+            log::warn("RDMA hugepages not available, using regular pages")
+                     ("page_size", page)("size", mapped)("numa_node", node)
+                     ("kind", kind2str(_kind));
+            page = 0;
+        }
     }
-    while (!buffer_queue.empty()) {
-        buffer_queue.pop();
+
+    if (block == MAP_FAILED) {
+        page = PAGE_SIZE;
+        size = (size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+
+        block = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (block == MAP_FAILED)
+            return nullptr;
+
+        if (nodemask && syscall(SYS_mbind, block, size, MPOL_PREFERRED, &nodemask, 64, 0))
+            log::warn("RDMA failed to bind buffer pool to NUMA node")
+                     ("numa_node", node)("error", strerror(errno))
+                     ("kind", kind2str(_kind));
+    }
+
+    buffer_block_size = size;
+    buffer_block_page = page;
+    buffer_block_node = node;
+
+    log::debug("RDMA buffer pool mapped")("size", size)("page_size", page)
+              ("numa_node", node)("kind", kind2str(_kind));
+
+    return block;
+}
+
+void Rdma::free_block()
+{
+    if (!buffer_block)
+        return;
+
+    for (auto& rail : rails)
+        libfabric_mr_ops.rdma_mr_cache_invalidate(rail.dev, buffer_block, buffer_block_size);
+
+    auto block = buffer_block;
+    auto size = buffer_block_size;
+    retire([block, size]() { munmap(block, size); });
+
+    buffer_block = nullptr;
+    buffer_block_size = 0;
+}
+
+/**
+ * @brief Registers the buffer block once per rail.
+ *
+ * The first endpoint of every rail registers the block. The other endpoints
+ * of the rail share its descriptor, since they share its domain. Providers
+ * that bind memory regions to endpoints get one registration per endpoint.
+ */
+Result Rdma::register_block()
+{
+    size_t aligned_sz = (((trx_sz + TRAILER) + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
+    size_t total_size = queue_size * aligned_sz;
+    size_t num_rails = std::max<size_t>(rails.size(), 1);
+
+    for (size_t i = 0; i < ep_ctxs.size(); i++) {
+        ep_ctx_t *ep = ep_ctxs[i];
+        auto dev = ep->rdma_ctx;
+        bool per_ep = dev && dev->info &&
+                      (dev->info->domain_attr->mr_mode & FI_MR_ENDPOINT);
+
+        if (i >= num_rails && !per_ep) {
+            ep->data_desc = ep_ctxs[i % num_rails]->data_desc;
+            continue;
+        }
+
+        int rc = libfabric_ep_ops.ep_reg_mr(ep, buffer_block, total_size);
+        if (rc) {
+            log::error("Memory registration failed on endpoint #%zu", i)
+                ("error", fi_strerror(-rc))
+                ("kind", kind2str(_kind));
+            return Result::error_memory_registration_failed;
+        }
+    }
+
+    return Result::success;
+}
+
+/**
+ * Get the registration of the buffer block used by the endpoint.
+ */
+struct fid_mr *Rdma::block_mr(size_t ep_idx) const
+{
+    auto mr = ep_ctxs[ep_idx]->data_mr;
+    if (mr)
+        return mr;
+
+    return ep_ctxs[ep_idx % std::max<size_t>(rails.size(), 1)]->data_mr;
+}
+
+void Rdma::collect(telemetry::Metric& metric, const int64_t& timestamp_ms)
+{
+    Connection::collect(metric, timestamp_ms);
+
+    metric.addFieldUint64("rdpool", buffer_block_size);
+    metric.addFieldUint64("rdpoolpg", buffer_block_page);
+    if (buffer_block_node >= 0)
+        metric.addFieldUint64("rdpoolnuma", buffer_block_node);
+
+    if (!rma_write) {
+        metric.addFieldUint64("rdreconn", reconnects.load(std::memory_order_relaxed));
+        metric.addFieldUint64("rdlinkdrop", link_dropped.load(std::memory_order_relaxed));
     }
 }
 
@@ -175,12 +406,13 @@ void Rdma::cleanup_queue()
  * @param ctx The operation context.
  * @param request The connection parameters including addresses and RDMA arguments.
  * @param dev_handle Reference to the RDMA device handle.
+ * @param options The RDMA options set by the proxy.
  * @param kind The type of connection (receiver or transmitter).
  * @param dir The data transfer direction (RX or TX).
  * @return Result::success on successful configuration, or an error result if arguments are invalid.
  */
 Result Rdma::configure(context::Context& ctx, const mcm_conn_param& request,
-                       libfabric_ctx *& dev_handle)
+                       libfabric_ctx *& dev_handle, const RdmaOptions& options)
 {
 
     trx_sz = request.payload_args.rdma_args.transfer_size;
@@ -213,10 +445,84 @@ Result Rdma::configure(context::Context& ctx, const mcm_conn_param& request,
     
     ep_cfg.dir = _kind == Kind::receiver ? direction::RX : direction::TX;
 
+    // --- one rail per pair of local and remote addresses ---
+    auto local_ips = split_addrs(options.local_ips.c_str());
+    auto remote_ips = split_addrs(options.remote_ips.c_str());
+    size_t num_rails = std::min({ local_ips.size(), remote_ips.size(),
+                                  (size_t)RDMA_MAX_EPS });
+
+    rails.assign(std::max<size_t>(num_rails, 1), Rail{});
+    for (size_t r = 0; r < rails.size(); r++) {
+        rails[r].local_addr = ep_cfg.local_addr;
+        rails[r].remote_addr = ep_cfg.remote_addr;
+        if (!num_rails)
+            continue;
+        snprintf(rails[r].local_addr.ip, sizeof(rails[r].local_addr.ip), "%s",
+                 local_ips[r].c_str());
+        snprintf(rails[r].remote_addr.ip, sizeof(rails[r].remote_addr.ip), "%s",
+                 remote_ips[r].c_str());
+    }
+    ep_cfg.local_addr = rails[0].local_addr;
+    ep_cfg.remote_addr = rails[0].remote_addr;
+
+    // Every rail needs at least one endpoint
+    if (rdma_num_eps < rails.size()) {
+        log::info("RDMA endpoints raised to the number of rails")
+                 ("num_endpoints", rdma_num_eps)("rails", rails.size());
+        rdma_num_eps = rails.size();
+    }
+
     m_dev_handle = dev_handle;
 
     queue_size = request.payload_args.rdma_args.queue_size;
 
+    rma_write = options.rma_write;
+
+    flow_control = options.flow_control;
+    if (flow_control > RDMA_FLOW_DROP_NEWEST)
+        flow_control = RDMA_FLOW_NONE;
+
+    ep_type = options.ep_type;
+    if (ep_type > RDMA_EP_UNRELIABLE)
+        ep_type = RDMA_EP_RELIABLE;
+
+    // Datagrams can't be written to remote memory
+    if (ep_type == RDMA_EP_UNRELIABLE && rma_write) {
+        log::error("RDMA write transport requires a reliable connection mode")
+                  ("kind", kind2str(_kind));
+        return Result::error_conn_config_invalid;
+    }
+
+    // The verbs endpoints are reliable datagrams layered on RC queue pairs,
+    // with no UD queue pairs behind them. The tcp provider has no datagram
+    // endpoints either, and the udp provider takes its place.
+    if (ep_type == RDMA_EP_UNRELIABLE) {
+        if (rdma_provider == "verbs") {
+            log::error("RDMA unreliable connection mode not supported by the verbs provider")
+                      ("kind", kind2str(_kind));
+            return Result::error_conn_config_invalid;
+        }
+        if (rdma_provider == "tcp")
+            log::info("RDMA unreliable connection mode uses the udp provider instead of tcp")
+                     ("kind", kind2str(_kind));
+    }
+
+    max_latency_ns = options.max_latency_ns;
+
+    cq_strategy = options.cq_strategy;
+    switch (cq_strategy) {
+    case RDMA_CQ_BUSY_POLL:
+        ep_cfg.comp_method = RDMA_COMP_SPIN;
+        break;
+    case RDMA_CQ_FD_WAIT:
+        ep_cfg.comp_method = RDMA_COMP_WAIT_FD;
+        break;
+    default:
+        cq_strategy = RDMA_CQ_HYBRID;
+        ep_cfg.comp_method = RDMA_COMP_SREAD;
+        break;
+    }
+
     set_state(ctx, State::configured);
     return Result::success;
 }
@@ -247,7 +553,10 @@ Result Rdma::on_establish(context::Context& ctx)
     int    ret;
     Result res;
 
-    // 3) Initialize the RDMA device if needed
+    // 3) Receivers sharing a receive context use a clone of its domain
+    shared_rx_attach();
+
+    // 3a) Initialize the RDMA device if needed
     if (!m_dev_handle) {
         m_dev_handle = (libfabric_ctx*)calloc(1, sizeof(libfabric_ctx));
         if (!m_dev_handle) {
@@ -263,6 +572,9 @@ Result Rdma::on_establish(context::Context& ctx)
         m_dev_handle->remote_ip   = ep_cfg.remote_addr.ip;
         m_dev_handle->remote_port = ep_cfg.remote_addr.port;
         m_dev_handle->provider_name = strdup(rdma_provider.c_str());
+        m_dev_handle->rma_write   = rma_write;
+        m_dev_handle->flow_credits = flow_credits();
+        m_dev_handle->unreliable  = ep_type == RDMA_EP_UNRELIABLE;
         ret = libfabric_dev_ops.rdma_init(&m_dev_handle);
 
         if (ret) {
@@ -276,6 +588,24 @@ Result Rdma::on_establish(context::Context& ctx)
         log::info("RDMA device successfully initialized");
     }
 
+    // A datagram carries a whole frame, and can't be larger than the MTU
+    if (m_dev_handle->ep_attr_type == FI_EP_DGRAM &&
+        trx_sz + TRAILER > m_dev_handle->info->ep_attr->max_msg_size) {
+        log::error("RDMA frame too large for the UD connection mode")
+                  ("size", trx_sz + TRAILER)
+                  ("max_msg_size", m_dev_handle->info->ep_attr->max_msg_size)
+                  ("kind", kind2str(_kind));
+        set_state(ctx, State::closed);
+        return Result::error_conn_config_invalid;
+    }
+
+    // 3b) Initialize the devices of the other rails
+    res = rails_init();
+    if (res != Result::success) {
+        set_state(ctx, State::closed);
+        return res;
+    }
+
     auto bump_sock = [](sockaddr_in* sa, uint32_t delta)
     {
         unsigned short p = ntohs(sa->sin_port);
@@ -315,13 +645,15 @@ Result Rdma::on_establish(context::Context& ctx)
     devs[0] = m_dev_handle;            // never null
     info_dups[0] = m_dev_handle->info; // keep for uniform cleanup
 
-    /* create clones for EP-1 … EP-N */
+    /* create clones for EP-1 … EP-N, each from the device of its rail */
     for (uint32_t i = 1; i < rdma_num_eps; ++i) {
-        fi_info* dup = fi_dupinfo(m_dev_handle->info);
+        libfabric_ctx *rail_dev = rails[rail_of(i)].dev;
+        fi_info* dup = fi_dupinfo(rail_dev->info);
         if (!dup) {
             log::error("fi_dupinfo failed for EP %u", i)("kind", kind2str(_kind));
             // free any earlier clones
             cleanup_clones(i);
+            rails_deinit();
             set_state(ctx, State::closed);
             return Result::error_initialization_failed;
         }
@@ -339,28 +671,32 @@ Result Rdma::on_establish(context::Context& ctx)
             fi_freeinfo(dup);
             // free any earlier clones
             cleanup_clones(i);
+            rails_deinit();
             set_state(ctx, State::closed);
             return Result::error_out_of_memory;
         }
-        *devs[i] = *m_dev_handle; // shallow copy
+        *devs[i] = *rail_dev; // shallow copy
         devs[i]->info = dup;
         devs[i]->is_initialized = true;
     }
 
     /* ---------- cfgs ---------------------------------------------------- */
     std::vector<ep_cfg_t> cfgs(rdma_num_eps, ep_cfg);
-    for (uint32_t i = 1; i < rdma_num_eps; ++i) {
-        bump_port_str(cfgs[i].local_addr.port,  cfgs[0].local_addr.port,  i);
-        bump_port_str(cfgs[i].remote_addr.port, cfgs[0].remote_addr.port, i);
+    for (uint32_t i = 0; i < rdma_num_eps; ++i) {
+        cfgs[i].local_addr = rails[rail_of(i)].local_addr;
+        cfgs[i].remote_addr = rails[rail_of(i)].remote_addr;
+        bump_port_str(cfgs[i].local_addr.port,  ep_cfg.local_addr.port,  i);
+        bump_port_str(cfgs[i].remote_addr.port, ep_cfg.remote_addr.port, i);
     }
 
     /* ---------- bring up endpoints ------------------------------------- */
     for (uint32_t i = 0; i < rdma_num_eps; ++i) {
         cfgs[i].rdma_ctx = devs[i];
-        if (i > 0) {
-            cfgs[i].shared_rx_cq = ep_ctxs[0]->cq_ctx.cq; // use EP-0 CQ for RX
+        if (i >= rails.size()) {
+            // use the CQ of the first EP of the rail
+            cfgs[i].shared_rx_cq = ep_ctxs[rail_of(i)]->cq_ctx.cq;
         } else {
-            cfgs[i].shared_rx_cq = nullptr; // no shared CQ for EP-0
+            cfgs[i].shared_rx_cq = nullptr; // no shared CQ for the first EP of a rail
         }
         int ret = libfabric_ep_ops.ep_init(&ep_ctxs[i], &cfgs[i]);
         if (ret) {
@@ -373,13 +709,23 @@ Result Rdma::on_establish(context::Context& ctx)
                 }
             }
             cleanup_clones(i + 1);
+            rails_deinit();
             set_state(ctx, State::closed);
             return Result::error_initialization_failed;
         }
     }
 
+    cq_eps.assign(ep_ctxs.begin(), ep_ctxs.begin() + rails.size());
+    ep_cfgs = cfgs;
+
+    if (rails.size() > 1)
+        log::info("RDMA endpoints striped across rails")("rails", rails.size())
+                 ("num_endpoints", rdma_num_eps)("kind", kind2str(_kind));
+
     /* ---------- queue & MR section (no duplicate ‘res’) ----------------- */
-    res = init_queue_with_elements(queue_size, trx_sz + TRAILER);
+    // Receivers sharing a receive context take its buffers
+    res = shared_rx ? Result::success :
+                      init_queue_with_elements(queue_size, trx_sz + TRAILER);
     if (res != Result::success) {
         log::error("Failed to initialise RDMA buffer queue")("trx_sz", trx_sz);
         for (auto &e : ep_ctxs) {
@@ -387,34 +733,42 @@ Result Rdma::on_establish(context::Context& ctx)
                 libfabric_ep_ops.ep_destroy(&e);
             }
         }
-        cleanup_clones(rdma_num_eps);        
+        cleanup_clones(rdma_num_eps);
+        rails_deinit();
         set_state(ctx, State::closed);
         return res;
     }
 
+    // Buffers posted on the endpoints are tracked to be recycled on reconnect
+    if (!rma_write && !shared_rx)
+        buf_posted = std::make_unique<std::atomic<bool>[]>(queue_size);
+    link_down = false;
+    reconnect_attempt = 0;
+    reconnect_ts = {};
+
     /* ------------------------------------------------------------------
-    * 8) Register the **same** memory block on every endpoint
+    * 8) Register the **same** memory block once per rail
     * -----------------------------------------------------------------*/
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-
-        std::size_t aligned_sz =                               /* one slot */
-            (((trx_sz + TRAILER) + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
-        std::size_t total_size = queue_size * aligned_sz;
-
-        for (auto* ep : ep_ctxs) {
-            int rc = libfabric_ep_ops.ep_reg_mr(ep, buffer_block, total_size);
-            if (rc) {
-                log::error("Memory registration failed")("error", fi_strerror(-rc));
-            for (auto &ee : ep_ctxs) {
-                if (ee) {
-                    libfabric_ep_ops.ep_destroy(&ee);
-                }
-            }
+    res = shared_rx ? Result::success : register_block();
+    if (res != Result::success) {
+        for (auto &e : ep_ctxs) if (e) libfabric_ep_ops.ep_destroy(&e);
+        cleanup_clones(rdma_num_eps);
+        rails_deinit();
+        set_state(ctx, State::closed);
+        return res;
+    }
+
+    /* ------------------------------------------------------------------
+    * 8a) Control messages carrying the credits
+    * -----------------------------------------------------------------*/
+    if (flow_credits()) {
+        res = ctrl_init();
+        if (res != Result::success) {
+            for (auto &e : ep_ctxs) if (e) libfabric_ep_ops.ep_destroy(&e);
             cleanup_clones(rdma_num_eps);
-                set_state(ctx, State::closed);
-                return Result::error_memory_registration_failed;
-            }
+            rails_deinit();
+            set_state(ctx, State::closed);
+            return res;
         }
     }
 
@@ -430,6 +784,7 @@ Result Rdma::on_establish(context::Context& ctx)
             if (info_dups[i]) fi_freeinfo(info_dups[i]);
             if (devs[i])      free(devs[i]);
         }
+        rails_deinit();
         set_state(ctx, State::closed);
         return res;
     }
@@ -458,6 +813,9 @@ Result Rdma::on_shutdown(context::Context& ctx)
 {
     // Note: this is a blocking call
     
+    // Stop the progress engine worker from polling the connection
+    progress_detach();
+
     // Cancel `rdma_cq_thread` context
     rdma_cq_thread_ctx.cancel();
     // Cancel `process_buffers_thread` context
@@ -491,6 +849,9 @@ Result Rdma::on_shutdown(context::Context& ctx)
         cleanup_resources(ctx);
     }
 
+    // Also after a failed establish, whose endpoints are destroyed
+    shared_rx_detach();
+
     set_state(ctx, State::closed);
 
     return Result::success;
@@ -530,37 +891,21 @@ Result Rdma::configure_endpoint(context::Context& ctx)
         }
     }
 
-    std::lock_guard<std::mutex> lock(queue_mutex);
-
     if (!buffer_block) {
         log::error("Memory block for RDMA buffer queue is not allocated")
             ("kind", kind2str(_kind));
         return Result::error_out_of_memory;
     }
 
-    // Total size in bytes of the contiguous buffer pool
-    size_t buf_count    = buffer_queue.size();
-    size_t aligned_sz = (((trx_sz + TRAILER) + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
-    size_t total_size   = buf_count * aligned_sz;
-
-    // Register the entire buffer block with each endpoint (QP)
-    for (size_t i = 0; i < ep_ctxs.size(); ++i) {
-        ep_ctx_t* e = ep_ctxs[i];
-        int ret = libfabric_ep_ops.ep_reg_mr(e, buffer_block, total_size);
-        if (ret) {
-            log::error("Memory registration failed on endpoint #%zu", i)
-                ("error", fi_strerror(-ret))
-                ("kind", kind2str(_kind));
-            return Result::error_memory_registration_failed;
-        }
-    }
-
-    return Result::success;
+    // Register the entire buffer block once per rail
+    return register_block();
 }
 
 
 Result Rdma::cleanup_resources(context::Context& ctx)
 {
+    ctrl_cleanup();
+
     // Destroy each endpoint (QP)
     for (size_t i = ep_ctxs.size(); i >= 1; --i) {
         ep_ctx_t*& e = ep_ctxs[i-1];
@@ -576,7 +921,13 @@ Result Rdma::cleanup_resources(context::Context& ctx)
         }
     }
 
+    cq_eps.clear();
+    ep_cfgs.clear();
+    on_cleanup();
+    rails_deinit();
+
     // Free and clear our buffer queue
+    buf_posted.reset();
     cleanup_queue();
 
     // Mark as uninitialized so we can re-establish if needed
@@ -584,5 +935,684 @@ Result Rdma::cleanup_resources(context::Context& ctx)
     return Result::success;
 }
 
+/**
+ * @brief Attaches a receiver to the shared receive context of its domain, if
+ * enabled. The receiver keeps a buffer block of its own if it can't share it.
+ */
+void Rdma::shared_rx_attach()
+{
+    if (!config::proxy.rdma.shared_rx || _kind != Kind::receiver || m_dev_handle)
+        return;
+
+    const char *reason = nullptr;
+    if (rma_write)
+        reason = "write transport";
+    else if (flow_credits())
+        reason = "flow control";
+    else if (rails.size() > 1)
+        reason = "multiple rails";
+
+    if (reason) {
+        log::info("RDMA rx not sharing the receive context")("reason", reason)
+                 ("kind", kind2str(_kind));
+        return;
+    }
+
+    libfabric_ctx want = {};
+    want.kind          = FI_KIND_RECEIVER;
+    want.local_ip      = ep_cfg.local_addr.ip;
+    want.local_port    = ep_cfg.local_addr.port;
+    want.provider_name = rdma_provider.c_str();
+    want.unreliable    = ep_type == RDMA_EP_UNRELIABLE;
+
+    shared_rx = RdmaSharedRx::attach(want, ring_slot_size(), queue_size, &m_dev_handle);
+    if (!shared_rx) {
+        log::info("RDMA rx not sharing the receive context")
+                 ("reason", "shared receive context unavailable")("kind", kind2str(_kind));
+        return;
+    }
+
+    ep_cfg.srx = shared_rx->context();
+}
+
+/**
+ * @brief Detaches the receiver from the shared receive context once its
+ * endpoints are destroyed, and frees its clone of the domain context. The
+ * detach is deferred while consumers hold buffers of the context.
+ */
+void Rdma::shared_rx_detach()
+{
+    if (!shared_rx)
+        return;
+
+    auto srx = shared_rx;
+    auto dev = m_dev_handle;
+    uint32_t size = queue_size;
+    retire([srx, dev, size]() { srx->detach(dev, size); });
+
+    shared_rx = nullptr;
+    m_dev_handle = nullptr;
+    ep_cfg.srx = nullptr;
+}
+
+/**
+ * @brief Initializes the device contexts of the rails after the first one,
+ * each bound to the addresses of its rail. The first rail uses the device
+ * context of the connection.
+ */
+Result Rdma::rails_init()
+{
+    if (rails.empty())
+        rails.assign(1, Rail{ ep_cfg.local_addr, ep_cfg.remote_addr });
+
+    rails[0].dev = m_dev_handle;
+
+    for (size_t r = 1; r < rails.size(); r++) {
+        auto dev = (libfabric_ctx *)calloc(1, sizeof(libfabric_ctx));
+        if (!dev) {
+            log::error("Failed to allocate RDMA rail context")("error", strerror(errno));
+            rails_deinit();
+            return Result::error_out_of_memory;
+        }
+
+        dev->kind          = m_dev_handle->kind;
+        dev->local_ip      = rails[r].local_addr.ip;
+        dev->local_port    = rails[r].local_addr.port;
+        dev->remote_ip     = rails[r].remote_addr.ip;
+        dev->remote_port   = rails[r].remote_addr.port;
+        dev->provider_name = m_dev_handle->provider_name;
+        dev->rma_write     = rma_write;
+        dev->unreliable    = m_dev_handle->unreliable;
+
+        int ret = libfabric_dev_ops.rdma_init(&dev);
+        if (ret) {
+            free(dev); // may have been freed and reset by rdma_init()
+            log::error("Failed to initialize RDMA rail device")("rail", r)
+                      ("local_ip", rails[r].local_addr.ip)
+                      ("remote_ip", rails[r].remote_addr.ip)
+                      ("error", fi_strerror(-ret));
+            rails_deinit();
+            return Result::error_initialization_failed;
+        }
+
+        rails[r].dev = dev;
+        log::info("RDMA rail device initialized")("rail", r)
+                 ("local_ip", rails[r].local_addr.ip)
+                 ("remote_ip", rails[r].remote_addr.ip);
+    }
+
+    return Result::success;
+}
+
+/**
+ * @brief Releases the device contexts of the rails after the first one.
+ * Must be called after the endpoints of the rails are destroyed.
+ */
+void Rdma::rails_deinit()
+{
+    for (size_t r = 1; r < rails.size(); r++) {
+        if (!rails[r].dev)
+            continue;
+
+        int ret = libfabric_dev_ops.rdma_deinit(&rails[r].dev);
+        if (ret)
+            log::error("Failed to deinitialize RDMA rail device")("rail", r)
+                      ("error", fi_strerror(-ret));
+        rails[r].dev = nullptr;
+    }
+}
+
+/**
+ * @brief Backs off after a poll of the completion queue found no work.
+ *
+ * Spins briefly first, which is the cheapest path at high packet rates,
+ * then yields, and finally sleeps when nothing happened for a while.
+ */
+void Rdma::cq_backoff(bool did_work, int& idle_cycles)
+{
+    static constexpr int SPIN_LIMIT  =  50;   // ≈ 1–2 µs of busy-wait
+    static constexpr int YIELD_LIMIT = 200;   // then ~200 sched_yield() calls
+    constexpr int CQ_RETRY_DELAY_US = 100;
+
+    if (did_work) {
+        idle_cycles = 0;             // reset after we did useful work
+        return;
+    }
+
+    if (idle_cycles < SPIN_LIMIT) {
+        /* short spin: cheapest path at high packet rate */
+        _mm_pause();             // pause instruction = 40–100 ns
+    } else if (idle_cycles < SPIN_LIMIT + YIELD_LIMIT) {
+        /* medium wait: let other threads run */
+        std::this_thread::yield();
+    } else {
+        /* long wait: nothing for a while – real sleep */
+        std::this_thread::sleep_for(std::chrono::microseconds(CQ_RETRY_DELAY_US));
+    }
+    ++idle_cycles;               // back-off gets longer
+}
+
+/**
+ * @brief Waits for work after a poll of the completion queue, according to
+ * the completion strategy of the connection.
+ *
+ * Busy-poll spins continuously. Fd-wait spins briefly, then blocks on the
+ * completion queue file descriptors. Hybrid backs off with cq_backoff().
+ */
+void Rdma::cq_idle(bool did_work, int& idle_cycles)
+{
+    static constexpr int FD_SPIN_LIMIT = 50;
+
+    switch (cq_strategy) {
+    case RDMA_CQ_BUSY_POLL:
+        if (!did_work)
+            _mm_pause();
+        break;
+
+    case RDMA_CQ_FD_WAIT:
+        if (did_work) {
+            idle_cycles = 0;
+        } else if (idle_cycles < FD_SPIN_LIMIT) {
+            _mm_pause();
+            ++idle_cycles;
+        } else {
+            cq_wait_fd(std::chrono::milliseconds(10));
+        }
+        break;
+
+    default:
+        cq_backoff(did_work, idle_cycles);
+        break;
+    }
+}
+
+/**
+ * @brief Blocks on the file descriptors of the completion queues until a
+ * completion arrives or the timeout expires. The timeout bounds the delay
+ * of cancellation and of the timers of the write transport.
+ *
+ * Returns at once if fi_trywait() reports that completions may be pending.
+ * Sleeps if the provider gave no file descriptors.
+ */
+void Rdma::cq_wait_fd(std::chrono::nanoseconds timeout)
+{
+    constexpr int CQ_RETRY_DELAY_US = 100;
+    struct fid *fids[8];
+    struct pollfd pfds[8];
+    int n = 0;
+
+    for (auto ep : cq_eps) {
+        if (n == 8)
+            break;
+        if (!ep || ep->cq_ctx.external || ep->cq_ctx.cq_fd < 0)
+            continue;
+
+        // Blocking is only safe after fi_trywait() succeeded. The rails
+        // may belong to different fabrics.
+        fids[n] = &ep->cq_ctx.cq->fid;
+        if (fi_trywait(ep->rdma_ctx->fabric, &fids[n], 1) != FI_SUCCESS)
+            return;
+
+        pfds[n] = { .fd = ep->cq_ctx.cq_fd, .events = POLLIN, .revents = 0 };
+        n++;
+    }
+
+    if (!n) {
+        std::this_thread::sleep_for(std::chrono::microseconds(CQ_RETRY_DELAY_US));
+        return;
+    }
+
+    auto sec = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec ts = {
+        .tv_sec = sec.count(),
+        .tv_nsec = (timeout - sec).count(),
+    };
+
+    ppoll(pfds, n, &ts, nullptr);
+}
+
+/**
+ * @brief Attaches the connection to the progress engine, if enabled.
+ * Returns false if the connection should start its own threads.
+ */
+bool Rdma::progress_attach()
+{
+    // Connections asking for busy-poll or fd-wait keep their own threads.
+    if (!config::proxy.rdma.progress_engine || cq_strategy != RDMA_CQ_HYBRID)
+        return false;
+
+    progress_stopped = false;
+    progress = RdmaProgress::attach(this);
+    if (!progress) {
+        log::warn("RDMA progress engine unavailable, using threads")
+                 ("kind", kind2str(_kind));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Detaches the connection from the progress engine. Returns after
+ * the worker stops polling the connection.
+ */
+void Rdma::progress_detach()
+{
+    if (!progress)
+        return;
+
+    progress->detach(this);
+    progress = nullptr;
+
+    stop_endpoints();
+}
+
+/**
+ * @brief Returns true if called by the progress worker serving the
+ * connection. The worker can't poll the connection while it waits for a
+ * buffer or a credit, so the caller must poll inline.
+ */
+bool Rdma::progress_inline() const
+{
+    return progress && progress == RdmaProgress::current();
+}
+
+/**
+ * @brief Called by the progress worker to make one pass over the completion
+ * queue. A connection that hit a fatal error is not polled anymore.
+ */
+uint32_t Rdma::progress_poll()
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (progress_stopped)
+        return 0;
+
+    int ret = poll(rdma_cq_thread_ctx);
+    if (ret < 0) {
+        progress_stopped = true;
+        stop_endpoints();
+        log::info("RDMA progress stopped.")("kind", kind2str(_kind));
+        return 0;
+    }
+
+    return ret;
+}
+
+// Signal all endpoints to stop
+void Rdma::stop_endpoints()
+{
+    for (auto *ep : ep_ctxs) {
+        if (ep) ep->stop_flag = true;
+    }
+}
+
+/**
+ * @brief Keeps the endpoints alive while the data plane posts on them.
+ * Returns false if the link is down, in which case the caller must not
+ * touch the endpoints. Every successful call is paired with ep_exit().
+ */
+bool Rdma::ep_enter()
+{
+    ep_users.fetch_add(1);
+    if (!link_down.load())
+        return true;
+
+    ep_users.fetch_sub(1);
+    return false;
+}
+
+void Rdma::ep_exit()
+{
+    ep_users.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * Mark the buffer posted on an endpoint, before posting it. The mark is
+ * cleared when the buffer completes or returns to the queue.
+ */
+void Rdma::mark_posted(void *buf, bool posted)
+{
+    if (!buf_posted)
+        return;
+
+    size_t slot = (static_cast<char *>(buf) - static_cast<char *>(buffer_block)) /
+                  ring_slot_size();
+    buf_posted[slot].store(posted, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Takes the link down on a connection reset seen by the CQ poller.
+ * The endpoints are re-created by reconnect_poll(), at once, or after a
+ * backoff if the link was reconnected less than a second ago.
+ */
+void Rdma::link_lost(int err)
+{
+    constexpr auto STABLE = std::chrono::seconds(1);
+    constexpr auto MIN_DELAY = std::chrono::microseconds(100);
+    constexpr auto MAX_DELAY = std::chrono::milliseconds(8);
+
+    if (rma_write || !buf_posted || link_down.load(std::memory_order_relaxed))
+        return;
+
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::microseconds delay{0};
+
+    if (now - reconnect_ts < STABLE) {
+        delay = std::min<std::chrono::microseconds>(
+            MIN_DELAY * (1u << std::min(reconnect_attempt, 7u)), MAX_DELAY);
+        reconnect_attempt++;
+    } else {
+        reconnect_attempt = 0;
+    }
+
+    reconnect_due = now + delay;
+    link_down_ts = now;
+
+    // Sends retrying on the old endpoints give up
+    link_down.store(true);
+    stop_endpoints();
+
+    log::warn("RDMA link lost, reconnecting")("error", fi_strerror(-err))
+             ("attempt", reconnect_attempt)("delay_us", delay.count())
+             ("kind", kind2str(_kind));
+}
+
+/**
+ * @brief Re-creates the endpoints once the link is down, the backoff has
+ * expired and the data plane has left the endpoints. Called by the CQ
+ * poller after every pass. A failed attempt is retried after the maximum
+ * backoff.
+ *
+ * Completions of the old endpoints still queued are discarded, and the
+ * buffers posted on the old endpoints are recycled into the pool.
+ */
+void Rdma::reconnect_poll()
+{
+    constexpr auto RETRY_DELAY = std::chrono::milliseconds(8);
+
+    if (!link_down.load(std::memory_order_relaxed))
+        return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < reconnect_due || ep_users.load())
+        return;
+
+    int rc = reconnect_endpoints();
+    if (rc) {
+        log::error("RDMA reconnect failed, retrying")("error", fi_strerror(-rc))
+                  ("kind", kind2str(_kind));
+        reconnect_due = now + RETRY_DELAY;
+        return;
+    }
+
+    for (auto *ep : cq_eps)
+        cq_discard(ep->cq_ctx.cq);
+
+    uint32_t recycled = 0;
+    for (int i = 0; i < queue_size; i++) {
+        if (!buf_posted[i].exchange(false, std::memory_order_acq_rel))
+            continue;
+        recycle_posted(static_cast<char *>(buffer_block) + i * ring_slot_size());
+        recycled++;
+    }
+
+    if (ctrl_block) {
+        ctrl_sends_pending = 0;
+        rc = ctrl_post_recvs();
+        if (rc)
+            log::error("RDMA failed to post control message receive")
+                      ("error", fi_strerror(-rc))("kind", kind2str(_kind));
+    }
+
+    on_reconnect();
+
+    reconnect_ts = std::chrono::steady_clock::now();
+    reconnects.fetch_add(1, std::memory_order_relaxed);
+    link_down.store(false, std::memory_order_release);
+
+    auto down_us = std::chrono::duration_cast<std::chrono::microseconds>(reconnect_ts -
+                                                                         link_down_ts);
+    log::info("RDMA link reconnected")("down_us", down_us.count())
+             ("recycled", recycled)("kind", kind2str(_kind));
+}
+
+/**
+ * @brief Re-creates every endpoint in place. Registrations bound to the old
+ * endpoints by the provider are made again.
+ *
+ * @return 0 on success, or the error of the first endpoint that failed.
+ */
+int Rdma::reconnect_endpoints()
+{
+    size_t block_size = queue_size * ring_slot_size();
+
+    for (size_t i = 0; i < ep_ctxs.size(); i++) {
+        ep_ctx_t *ep = ep_ctxs[i];
+        auto dev = ep->rdma_ctx;
+        bool per_ep = dev->info->domain_attr->mr_mode & FI_MR_ENDPOINT;
+
+        if (per_ep) {
+            if (ep->data_mr)
+                libfabric_mr_ops.rdma_unreg_mr(ep->data_mr);
+            ep->data_mr = nullptr;
+            ep->data_desc = nullptr;
+
+            if (!i && ctrl_mr) {
+                libfabric_mr_ops.rdma_unreg_mr(ctrl_mr);
+                ctrl_mr = nullptr;
+                ctrl_desc = nullptr;
+            }
+        }
+
+        int rc = libfabric_ep_ops.ep_reinit(ep, &ep_cfgs[i]);
+        if (rc)
+            return rc;
+
+        if (per_ep) {
+            rc = libfabric_ep_ops.ep_reg_mr(ep, buffer_block, block_size);
+            if (!rc && !i && ctrl_block)
+                rc = ctrl_reg();
+            if (rc)
+                return rc;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Discard the completions queued on the CQ.
+ */
+void Rdma::cq_discard(struct fid_cq *cq)
+{
+    struct fi_cq_data_entry entries[CQ_BATCH_SIZE];
+
+    for (;;) {
+        int ret = fi_cq_read(cq, entries, CQ_BATCH_SIZE);
+        if (ret > 0)
+            continue;
+
+        if (ret != -FI_EAVAIL)
+            break;
+
+        fi_cq_err_entry err {};
+        if (fi_cq_readerr(cq, &err, 0) < 0)
+            break;
+    }
+}
+
+/**
+ * Return a buffer posted on an old endpoint to the queue.
+ */
+void Rdma::recycle_posted(void *buf)
+{
+    add_to_queue(buf);
+}
+
+size_t Rdma::ring_slot_size() const
+{
+    return (((trx_sz + TRAILER) + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
+}
+
+/**
+ * @brief Allocates and registers the control message block, and posts
+ * receives for the control messages on the first endpoint. The receiver of
+ * the send transport posts none, since they would take frames; it only
+ * sends credits.
+ */
+Result Rdma::ctrl_init()
+{
+    constexpr size_t ctrl_size = (WRITE_CTRL_RECVS + WRITE_CTRL_SENDS) * sizeof(WriteCtrl);
+    static_assert(ctrl_size <= PAGE_SIZE, "control block exceeds a page");
+    static_assert(offsetof(WriteCtrl, seq) + TRAILER == sizeof(WriteCtrl),
+                  "control message sequence number is not in the trailer");
+
+    ctrl_block = static_cast<WriteCtrl *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+    if (!ctrl_block) {
+        log::error("RDMA failed to allocate control block")("kind", kind2str(_kind));
+        return Result::error_out_of_memory;
+    }
+    std::memset(ctrl_block, 0, PAGE_SIZE);
+
+    int rc = ctrl_reg();
+    if (rc) {
+        log::error("RDMA control block registration failed")("error", fi_strerror(-rc))
+                  ("kind", kind2str(_kind));
+        ctrl_cleanup();
+        return Result::error_memory_registration_failed;
+    }
+
+    ctrl_next_send = 0;
+    ctrl_sends_pending = 0;
+
+    rc = ctrl_post_recvs();
+    if (rc) {
+        log::error("RDMA failed to post control message receive")
+                  ("error", fi_strerror(-rc))("kind", kind2str(_kind));
+        ctrl_cleanup();
+        return Result::error_general_failure;
+    }
+
+    return Result::success;
+}
+
+/**
+ * Register the control block with the domain, or with the first endpoint if
+ * the provider binds memory regions to endpoints.
+ */
+int Rdma::ctrl_reg()
+{
+    auto info = m_dev_handle->info;
+
+    return libfabric_mr_ops.rdma_reg_mr(m_dev_handle, ep_ctxs[0]->ep, ctrl_block, PAGE_SIZE,
+                                        libfabric_mr_ops.rdma_info_to_mr_access(info),
+                                        (uint64_t)ctrl_block, FI_HMEM_SYSTEM, 0,
+                                        &ctrl_mr, &ctrl_desc);
+}
+
+/**
+ * Post the receives for the control messages on the first endpoint. The
+ * receiver of the send transport posts none, since they would take frames.
+ */
+int Rdma::ctrl_post_recvs()
+{
+    if (!rma_write && _kind == Kind::receiver)
+        return 0;
+
+    for (size_t i = 0; i < WRITE_CTRL_RECVS; i++) {
+        int rc = ctrl_post_recv(&ctrl_block[i]);
+        if (rc)
+            return rc;
+    }
+
+    return 0;
+}
+
+void Rdma::ctrl_cleanup()
+{
+    if (ctrl_mr)
+        libfabric_mr_ops.rdma_unreg_mr(ctrl_mr);
+
+    ctrl_mr = nullptr;
+    ctrl_desc = nullptr;
+
+    if (ctrl_block)
+        libfabric_mr_ops.rdma_mr_cache_invalidate(m_dev_handle, ctrl_block, PAGE_SIZE);
+
+    std::free(ctrl_block);
+    ctrl_block = nullptr;
+}
+
+bool Rdma::is_ctrl(const void *ptr) const
+{
+    auto p = static_cast<const WriteCtrl *>(ptr);
+    return ctrl_block && p >= ctrl_block &&
+           p < ctrl_block + WRITE_CTRL_RECVS + WRITE_CTRL_SENDS;
+}
+
+int Rdma::ctrl_post_recv(WriteCtrl *msg)
+{
+    return libfabric_ep_ops.ep_recv_desc(ep_ctxs[0], msg, sizeof(*msg), ctrl_desc, msg);
+}
+
+/**
+ * @brief Sends a control message on the first endpoint. Returns -EAGAIN if
+ * all control send buffers are in flight. Called by the CQ thread only.
+ */
+int Rdma::ctrl_send(WriteCtrlType type, const WriteCtrl& msg)
+{
+    if (ctrl_sends_pending >= WRITE_CTRL_SENDS)
+        return -EAGAIN;
+
+    auto slot = &ctrl_block[WRITE_CTRL_RECVS + ctrl_next_send % WRITE_CTRL_SENDS];
+
+    *slot = msg;
+    slot->magic = WRITE_CTRL_MAGIC;
+    slot->type = type;
+    slot->seq = CTRL_SEQ;
+
+    struct iovec iov = { .iov_base = slot, .iov_len = sizeof(*slot) };
+    void *desc = ctrl_desc;
+
+    int rc = libfabric_ep_ops.ep_sendv(ep_ctxs[0], &iov, &desc, 1, slot);
+    if (rc)
+        return rc;
+
+    ctrl_next_send++;
+    ctrl_sends_pending++;
+    return 0;
+}
+
+void Rdma::ctrl_on_send_completion()
+{
+    if (ctrl_sends_pending)
+        ctrl_sends_pending--;
+}
+
+/**
+ * @brief Sends the control messages of the first endpoint to the address of
+ * the transmitter carried by its hello message.
+ *
+ * @return True if the address was inserted into the address vector.
+ */
+bool Rdma::ctrl_set_peer(const WriteCtrl *msg)
+{
+    if (!msg->src_len || msg->src_len > sizeof(msg->src)) {
+        log::error("RDMA bad transmitter address")("len", msg->src_len)
+                  ("kind", kind2str(_kind));
+        return false;
+    }
+
+    int err = libfabric_ep_ops.ep_set_peer(ep_ctxs[0], msg->src);
+    if (err) {
+        log::error("RDMA failed to insert the transmitter address")
+                  ("error", fi_strerror(-err))("kind", kind2str(_kind));
+        return false;
+    }
+
+    return true;
+}
 
 } // namespace mesh::connection
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "conn_rdma_progress.h"
+#include "conn_rdma.h"
+#include "proxy_config.h"
+
+namespace mesh::connection {
+
+const std::vector<int>& RdmaProgress::cpus()
+{
+    return config::proxy.rdma.progress_cpus;
+}
+
+uint32_t RdmaProgress::poll(Rdma *conn)
+{
+    return conn->progress_poll();
+}
+
+void RdmaProgress::idle(uint32_t work, int& idle_cycles)
+{
+    Rdma::cq_backoff(work, idle_cycles);
+}
+
+} // namespace mesh::connection
@@ -1,7 +1,9 @@
 #include "conn_rdma_rx.h"
+#include "conn_rdma_srx.h"
+#include "proxy_config.h"
 #include <stdexcept>
 #include <queue>
-#include <immintrin.h>
+#include <bit>
 
 namespace mesh::connection {
 
@@ -16,28 +18,92 @@ RdmaRx::~RdmaRx()
 }
 
 Result RdmaRx::configure(context::Context& ctx, const mcm_conn_param& request,
-                         libfabric_ctx *& dev_handle)
+                         libfabric_ctx *& dev_handle, const RdmaOptions& options)
 {
     log::debug("RdmaRx configure")("local_ip", request.local_addr.ip)
                                   ("local_port", request.local_addr.port)
                                   ("remote_ip", request.remote_addr.ip)
                                   ("remote_port", request.remote_addr.port);
 
-    return Rdma::configure(ctx, request, dev_handle);
+    return Rdma::configure(ctx, request, dev_handle, options);
 }
 
 Result RdmaRx::start_threads(context::Context& ctx) {
 
+    rx_pool = new(std::nothrow) BufferPool(config.buf_parts);
+    if (!rx_pool || !rx_pool->init(queue_size)) {
+        log::error("RDMA rx buffer pool alloc failed")("capacity", queue_size)
+                  ("kind", kind2str(_kind));
+        if (rx_pool)
+            rx_pool->destroy();
+        rx_pool = nullptr;
+        return Result::error_out_of_memory;
+    }
+
+    auto owner = new(std::nothrow) sync::DataplaneAtomicPtr;
+    if (!owner) {
+        rx_pool->destroy();
+        rx_pool = nullptr;
+        return Result::error_out_of_memory;
+    }
+    owner->store(this);
+    rx_pool->on_destroy([owner]() { delete owner; });
+    rx_owner = owner;
+
     process_buffers_thread_ctx = context::WithCancel(ctx);
     rdma_cq_thread_ctx = context::WithCancel(ctx);
 
-    try {
-        handle_process_buffers_thread = std::jthread(
-            [this]() { this->process_buffers_thread(this->process_buffers_thread_ctx); });
-    } catch (const std::system_error& e) {
-        log::error("RDMA rx failed to start thread")("error", e.what())
-                  ("kind", kind2str(_kind));
-        return Result::error_thread_creation_failed;
+    // With the write transport, the transmitter writes to the buffers
+    // directly and no receives are posted.
+    if (rma_write) {
+        slot_ready = std::make_unique<bool[]>(queue_size);
+        slot_chunks = std::make_unique<uint16_t[]>(queue_size);
+        slot_lost = std::make_unique<uint16_t[]>(queue_size);
+        slot_released = std::make_unique<std::atomic<bool>[]>(queue_size);
+        deliver_head = 0;
+        release_head = 0;
+        credits_sent = 0;
+        peer_known = false;
+
+        if (progress_attach())
+            return Result::success;
+
+        try {
+            handle_rdma_cq_thread =
+                std::jthread([this]() { this->write_cq_thread(this->rdma_cq_thread_ctx); });
+        } catch (const std::system_error& e) {
+            log::error("RDMA rx failed to start thread")("error", e.what())
+                      ("kind", kind2str(_kind));
+            return Result::error_thread_creation_failed;
+        }
+        return Result::success;
+    }
+
+    Result res = reorder_init();
+    if (res != Result::success)
+        return res;
+
+    if (flow_credits()) {
+        recv_ep = std::make_unique<std::atomic<uint8_t>[]>(queue_size);
+        recvs_posted = 0;
+        frames_received = 0;
+        credits_sent = 0;
+        peer_known = false;
+    }
+
+    if (progress_attach())
+        return Result::success;
+
+    // Buffers of the shared receive context are reposted when released
+    if (!shared_rx) {
+        try {
+            handle_process_buffers_thread = std::jthread(
+                [this]() { this->process_buffers_thread(this->process_buffers_thread_ctx); });
+        } catch (const std::system_error& e) {
+            log::error("RDMA rx failed to start thread")("error", e.what())
+                      ("kind", kind2str(_kind));
+            return Result::error_thread_creation_failed;
+        }
     }
 
     try {
@@ -56,8 +122,9 @@ Result RdmaRx::start_threads(context::Context& ctx) {
  * @brief Handles the buffer processing logic for RDMA in a dedicated thread.
  * 
  * Continuously consumes available buffers from the queue and prepares them for RDMA reception
- * by passing them to the RDMA endpoint. If no buffers are available, the thread waits for 
- * notification of buffer availability. Ensures graceful handling of errors and context cancellation.
+ * by passing them to the RDMA endpoint. If no buffers are available, the thread blocks in the
+ * buffer queue until a buffer is returned. Ensures graceful handling of errors and context
+ * cancellation, which wakes up the blocked thread.
  * 
  * @param ctx The context for managing thread cancellation and operations.
  */
@@ -66,46 +133,91 @@ void RdmaRx::process_buffers_thread(context::Context& ctx)
     while (!ctx.cancelled()) {
         void *buf = nullptr;
 
-        // Drain all currently queued buffers
-        while (!ctx.cancelled()) {
-            Result res = consume_from_queue(ctx, &buf);
-            if (res == Result::success && buf) {
-                // Round-robin receive postings across the two QPs
-                uint32_t idx = next_rx_idx.fetch_add(1, std::memory_order_relaxed)
-                             % ep_ctxs.size();
-                ep_ctx_t* chosen = ep_ctxs[idx];
-                if (!chosen) {
-                    log::error("RDMA rx endpoint #%u is null, skipping buffer")
-                        ("idx", idx)("kind", kind2str(_kind));
-                    // Return buffer so it isn't lost
-                    add_to_queue(buf);
-                    break;
-                }
+        Result res = consume_from_queue(ctx, &buf, std::chrono::nanoseconds::max());
+        if (res != Result::success || !buf)
+            continue;
 
-                int err = libfabric_ep_ops.ep_recv_buf(chosen, buf, trx_sz + TRAILER, buf);
-                if (err) {
-                    log::error("Failed to post recv buffer to RDMA rx")
-                        ("buffer_address", buf)
-                        ("error", fi_strerror(-err))
-                        ("kind", kind2str(_kind));
-                    // On error, put the buffer back on the queue
-                    res = add_to_queue(buf);
-                    if (res != Result::success) {
-                        log::error("Failed to re-queue buffer after recv error")
-                            ("error", result2str(res))
-                            ("kind", kind2str(_kind));
-                        break;
-                    }
-                }
-            } else {
-                // No more buffers available right now
-                break;
-            }
+        // The buffer went back to the queue, wait for the link to be back
+        if (!post_receive(buf) && link_down.load(std::memory_order_relaxed))
+            thread::Sleep(ctx, std::chrono::microseconds(100));
+    }
+}
+
+/**
+ * @brief Posts receives for the buffers currently in the queue, up to a
+ * batch, without blocking. Used by the progress engine.
+ *
+ * @return The number of buffers posted.
+ */
+uint32_t RdmaRx::post_receives()
+{
+    uint32_t posted = 0;
+    void *buf;
+
+    while (posted < CQ_BATCH_SIZE && buffer_ring.pop(buf)) {
+        if (!post_receive(buf))
+            break;
+        posted++;
+    }
+
+    return posted;
+}
+
+/**
+ * @brief Posts a receive for the buffer. On error, or while the link is
+ * reconnecting, the buffer is put back on the queue.
+ *
+ * @return True if the receive was posted.
+ */
+bool RdmaRx::post_receive(void *buf)
+{
+    if (!ep_enter()) {
+        add_to_queue(buf);
+        return false;
+    }
+
+
+    // Round-robin receive postings across the two QPs
+    uint32_t idx = next_rx_idx.fetch_add(1, std::memory_order_relaxed)
+                 % ep_ctxs.size();
+    ep_ctx_t* chosen = ep_ctxs[idx];
+    if (!chosen) {
+        log::error("RDMA rx endpoint #%u is null, skipping buffer")
+            ("idx", idx)("kind", kind2str(_kind));
+        // Return buffer so it isn't lost
+        add_to_queue(buf);
+        ep_exit();
+        return false;
+    }
+
+    mark_posted(buf);
+
+    int err = libfabric_ep_ops.ep_recv_buf(chosen, buf, trx_sz + TRAILER, buf);
+    if (err) {
+        log::error("Failed to post recv buffer to RDMA rx")
+            ("buffer_address", buf)
+            ("error", fi_strerror(-err))
+            ("kind", kind2str(_kind));
+        // On error, put the buffer back on the queue
+        Result res = add_to_queue(buf);
+        if (res != Result::success) {
+            log::error("Failed to re-queue buffer after recv error")
+                ("error", result2str(res))
+                ("kind", kind2str(_kind));
         }
+        ep_exit();
+        return false;
+    }
 
-        // Wait until new buffers are added
-        wait_buf_available();
+    if (recv_ep) {
+        size_t slot = (static_cast<char *>(buf) - static_cast<char *>(buffer_block)) /
+                      ring_slot_size();
+        recv_ep[slot].store(idx, std::memory_order_relaxed);
+        recvs_posted.fetch_add(1, std::memory_order_release);
     }
+
+    ep_exit();
+    return true;
 }
 
 
@@ -119,192 +231,894 @@ void RdmaRx::process_buffers_thread(context::Context& ctx)
  * 
  * Key Steps:
  * 1. Reads a batch of CQ entries.
- * 2. For each entry:
- *    - Processes the received buffer and sends it.
- *    - Adds the buffer back to the queue upon successful processing.
- *    - Logs errors for any issues during processing or queue operations.
+ * 2. Slots every entry into the reorder ring, then delivers the entries
+ *    that became in order in bursts. Buffers go back to the queue when
+ *    their handles are released.
  * 3. Handles `EAGAIN` errors by yielding CPU time to avoid busy looping.
  * 4. Logs and exits on other CQ read errors.
  * 
  * @param ctx The context for managing thread cancellation and operations.
  */
 void RdmaRx::rdma_cq_thread(context::Context& ctx) {
-    constexpr int CQ_RETRY_DELAY_US = 100;
-    struct fi_cq_entry cq_entries[CQ_BATCH_SIZE];
+    int idle_cycles = 0;
 
     while (!ctx.cancelled()) {
-        bool did_work = false;
+        int ret = poll_cq(ctx);
+        if (ret < 0)
+            break;
 
-        // Poll each *unique* CQ only once
-        struct fid_cq *last_cq = nullptr;
-        for (auto* ep : ep_ctxs) {
-            if (!ep) continue;
+        cq_idle(ret > 0, idle_cycles);
+    }
 
-            struct fid_cq *cq = ep->cq_ctx.cq;
-            if (cq == last_cq)           // duplicate of the one we just handled
-                continue;
-            last_cq = cq;
+    stop_endpoints();
+    log::info("RDMA RX CQ thread stopped.")("kind", kind2str(_kind));
+}
 
-            int ret = fi_cq_read(cq, cq_entries, CQ_BATCH_SIZE);
-            if (ret > 0) {
-                did_work = true;
+/**
+ * @brief Makes one non-blocking pass over the completion queues.
+ *
+ * @return The number of completions handled, or -1 on a fatal CQ read error.
+ */
+int RdmaRx::poll_cq(context::Context& ctx)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
 
-                for (int i = 0; i < ret; ++i) {
-                    void* buf = cq_entries[i].op_context;
-                    if (!buf) {
-                        log::error("RDMA rx null buffer context, skipping...")
-                            ("batch_index", i)
-                            ("kind", kind2str(_kind));
-                        continue;
-                    }
+    struct fi_cq_data_entry cq_entries[CQ_BATCH_SIZE];
+    int work = 0;
+    bool credits = flow_credits();
 
-                    // Read 64-bit trailer after payload
-                    auto* trailer_ptr = reinterpret_cast<uint64_t*>(
-                        reinterpret_cast<char*>(buf) + trx_sz);
-                    uint64_t seq = *trailer_ptr;
+    // Poll the CQ of every rail once
+    for (auto* ep : cq_eps) {
+        if (!ep) continue;
 
-                    if (reorder_head == UINT64_MAX) {
-                        reorder_head = seq;
-                    }
-                    // Slot into ring buffer
-                    size_t idx = seq & (REORDER_WINDOW - 1);
-                    reorder_ring[idx] = buf;
-
-                    // Flush any in-order entries
-                    while (true) {
-                        size_t head_idx = reorder_head & (REORDER_WINDOW - 1);
-                        void* ready = reorder_ring[head_idx];
-                        if (!ready) break;
-                        reorder_ring[head_idx] = nullptr;
-
-                        // Deliver payload (exclude trailer)
-                        Result r = transmit(ctx, ready, trx_sz);
-                        if (r != Result::success) {
-                            log::error("RDMA rx failed to transmit buffer")
-                                ("buffer_address", ready)
-                                ("size", trx_sz)
-                                ("kind", kind2str(_kind));
-                        }
-
-                        // Recycle buffer
-                        r = add_to_queue(ready);
-                        if (r == Result::success) {
-                            notify_buf_available();
-                        } else {
-                            log::error("Failed to recycle buffer to queue")
-                                ("buffer_address", ready)
-                                ("kind", kind2str(_kind));
-                        }
-                        ++reorder_head;
-                    }
+        struct fid_cq *cq = ep->cq_ctx.cq;
+
+        int ret = fi_cq_read(cq, cq_entries, CQ_BATCH_SIZE);
+        if (ret > 0) {
+            work += ret;
+
+            for (int i = 0; i < ret; ++i) {
+                void* buf = cq_entries[i].op_context;
+                if (!buf) {
+                    log::error("RDMA rx null buffer context, skipping...")
+                        ("batch_index", i)
+                        ("kind", kind2str(_kind));
+                    continue;
+                }
+
+                if (is_ctrl(buf)) {
+                    ctrl_on_send_completion();
+                    continue;
+                }
+
+                mark_posted(buf, false);
+                if (shared_rx)
+                    shared_rx->consumed();
+
+                // The message is the payload followed by the trailer
+                size_t len = cq_entries[i].len;
+                if (len < TRAILER || len > trx_sz + TRAILER) {
+                    if (credits)
+                        frames_received++;
+                    log::error("RDMA rx bad message length, dropping")
+                        ("len", len)("kind", kind2str(_kind));
+                    recycle_buffer(buf);
+                    continue;
                 }
+
+                // Read 64-bit trailer after payload
+                uint32_t payload_len = len - TRAILER;
+                uint64_t seq;
+                std::memcpy(&seq, reinterpret_cast<char*>(buf) + payload_len,
+                            sizeof(seq));
+
+                if (seq == CTRL_SEQ && len == sizeof(WriteCtrl)) {
+                    on_hello(static_cast<WriteCtrl *>(buf));
+                    continue;
+                }
+
+                if (credits)
+                    frames_received++;
+
+                reorder_insert(ctx, buf, payload_len, seq);
             }
-            else if (ret == -FI_EAVAIL) {
-                fi_cq_err_entry err_entry {};
-                int err_ret = fi_cq_readerr(ep->cq_ctx.cq, &err_entry, 0);
-                if (err_ret >= 0) {
-                    int err = err_entry.err;
-
-                    /* human-friendly diagnostics */
-                    if (err == -FI_ECANCELED) {
-                        log::warn("RDMA rx operation canceled")
-                            ("error", fi_strerror(err))("kind", kind2str(_kind));
-                    } else if (err == -FI_ECONNRESET || err == -FI_ENOTCONN) {
-                        log::warn("RDMA connection reset/not connected; retrying")
-                            ("error", fi_strerror(err))("kind", kind2str(_kind));
-                        thread::Sleep(ctx, std::chrono::milliseconds(1000));
-                    } else if (err == -FI_ECONNABORTED) {
-                        log::warn("RDMA rx connection aborted")
-                            ("error", fi_strerror(err))("kind", kind2str(_kind));
-                    } else {
-                        log::error("RDMA rx encountered CQ error")
-                            ("error", fi_strerror(err))("kind", kind2str(_kind));
-                    }
 
-                    /* recycle the buffer that was canceled / errored */
-                    if (err_entry.op_context) {
-                        if (add_to_queue(err_entry.op_context) == Result::success)
-                            notify_buf_available();
-                        else
-                            log::error("Failed to recycle buffer after CQ error")
-                                ("buffer_address", err_entry.op_context)
-                                ("kind", kind2str(_kind));
-                    }
+            // Deliver the in-order entries in bursts
+            flush_in_order(ctx);
+        }
+        else if (ret == -FI_EAVAIL) {
+            fi_cq_err_entry err_entry {};
+            int err_ret = fi_cq_readerr(ep->cq_ctx.cq, &err_entry, 0);
+            if (err_ret >= 0) {
+                // Providers report the error as a positive number
+                int err = -std::abs(err_entry.err);
+
+                /* human-friendly diagnostics */
+                if (err == -FI_ECANCELED) {
+                    log::warn("RDMA rx operation canceled")
+                        ("error", fi_strerror(-err))("kind", kind2str(_kind));
+                } else if (err == -FI_ECONNRESET || err == -FI_ENOTCONN) {
+                    link_lost(err);
+                } else if (err == -FI_ECONNABORTED) {
+                    log::warn("RDMA rx connection aborted")
+                        ("error", fi_strerror(-err))("kind", kind2str(_kind));
+                } else {
+                    log::error("RDMA rx encountered CQ error")
+                        ("error", fi_strerror(-err))("kind", kind2str(_kind));
+                }
+
+                /* recycle the buffer that was canceled / errored */
+                if (is_ctrl(err_entry.op_context)) {
+                    ctrl_on_send_completion();
+                } else if (err_entry.op_context) {
+                    // No frame was taken, so the credit is taken back
+                    if (recv_ep)
+                        recvs_posted.fetch_sub(1, std::memory_order_relaxed);
+                    if (shared_rx)
+                        shared_rx->consumed();
 
-                    /* ---- if it was ECANCELED, repost done:  keep reorder_head,
-                       just try to flush any packet that became in-order now ---- */
-                    if (err == -FI_ECANCELED) {
-                        std::size_t flushed = 0;
-                        while (true) {
-                            size_t head_idx = reorder_head & (REORDER_WINDOW - 1);
-                            void*  ready    = reorder_ring[head_idx];
-                            if (!ready) break;   // next frame not here yet
-                            reorder_ring[head_idx] = nullptr;
-
-                            Result r = transmit(ctx, ready, trx_sz);
-                            if (r != Result::success)
-                                log::error("RDMA rx failed to transmit buffer")
-                                    ("buffer_address", ready)("size", trx_sz)
-                                    ("kind", kind2str(_kind));
-
-                            if (add_to_queue(ready) == Result::success)
-                                notify_buf_available();
-                            else
-                                log::error("Failed to recycle buffer to queue")
-                                    ("buffer_address", ready)("kind", kind2str(_kind));				
-                            ++reorder_head;
-                            ++flushed;
-                        }
-                        log::debug("RX ECANCELED: flushed %zu frame%s waiting in ring",
-                                   flushed, flushed == 1 ? "" : "s")
+                    if (recycle_buffer(err_entry.op_context) != Result::success)
+                        log::error("Failed to recycle buffer after CQ error")
+                            ("buffer_address", err_entry.op_context)
                             ("kind", kind2str(_kind));
-                    }
+                }
 
-                    did_work = true;         // we handled something – no sleep
-                } else {
-                    log::error("RDMA rx failed to read CQ error entry")
-                        ("error", fi_strerror(-err_ret))("kind", kind2str(_kind));
+                /* ---- if it was ECANCELED, repost done:  keep reorder_head,
+                   just try to flush any packet that became in-order now ---- */
+                if (err == -FI_ECANCELED) {
+                    auto prev_head = reorder_head;
+                    flush_in_order(ctx);
+
+                    std::size_t flushed = reorder_head - prev_head;
+                    log::debug("RX ECANCELED: flushed %zu frame%s waiting in ring",
+                               flushed, flushed == 1 ? "" : "s")
+                        ("kind", kind2str(_kind));
                 }
+
+                work++;                  // we handled something – no sleep
+            } else {
+                log::error("RDMA rx failed to read CQ error entry")
+                    ("error", fi_strerror(-err_ret))("kind", kind2str(_kind));
             }
-            else if (ret != -EAGAIN && ret != -FI_ENOTCONN) {
-                // Fatal CQ read error
-                log::error("RDMA rx cq read failed")
-                    ("error", fi_strerror(-ret))
-                    ("kind", kind2str(_kind));
-                goto shutdown;
+        }
+        else if (ret != -EAGAIN && ret != -FI_ENOTCONN) {
+            // Fatal CQ read error
+            log::error("RDMA rx cq read failed")
+                ("error", fi_strerror(-ret))
+                ("kind", kind2str(_kind));
+            return -1;
+        }
+        // else: -EAGAIN or -FI_ENOTCONN → retry
+    }
+
+    reorder_expire(ctx);
+
+    if (credits)
+        grant_credits(!work);
+
+    reconnect_poll();
+
+    return work;
+}
+
+/**
+ * @brief Takes the hello message of the transmitter, received in a frame
+ * buffer, and sends the credits to the address it carries from then on.
+ * The message took no frame, so its credit is taken back.
+ */
+void RdmaRx::on_hello(WriteCtrl *msg)
+{
+    // The hello is repeated until answered, and the transmitter may come
+    // back with a new address after a reconnection
+    if (msg->magic == WRITE_CTRL_MAGIC && msg->type == WriteCtrlType::hello &&
+        flow_credits() && ctrl_set_peer(msg)) {
+        if (!peer_known)
+            log::info("RDMA rx granting credits to the transmitter")
+                     ("credits", recvs_posted.load(std::memory_order_relaxed))
+                     ("kind", kind2str(_kind));
+
+        // The credits are sent again, which answers the hello
+        peer_known = true;
+        credits_sent = 0;
+    }
+
+    if (recv_ep)
+        recvs_posted.fetch_sub(1, std::memory_order_relaxed);
+
+    recycle_buffer(msg);
+}
+
+/**
+ * @brief Grants the receives posted since the last grant to the transmitter
+ * as credits. Credits are sent in batches of a quarter of the queue, or
+ * whenever the CQ is idle. The frames received so far are reported too, so
+ * the transmitter can discount the frames sent before the receiver was up.
+ */
+void RdmaRx::grant_credits(bool idle)
+{
+    uint64_t posted = recvs_posted.load(std::memory_order_acquire);
+    uint64_t batch = std::max(1, queue_size / 4);
+
+    // Receives completed in error may leave fewer than granted already
+    if (!peer_known || posted <= credits_sent || link_down.load(std::memory_order_relaxed))
+        return;
+
+    if (posted - credits_sent < batch && !idle)
+        return;
+
+    WriteCtrl msg = {};
+    msg.credits = posted;
+    msg.received = frames_received;
+
+    if (!ctrl_send(WriteCtrlType::credits, msg))
+        credits_sent = posted;
+}
+
+/**
+ * @brief Returns a receive posted on an old endpoint to the queue. It took
+ * no frame, so its credit is taken back.
+ */
+void RdmaRx::recycle_posted(void *buf)
+{
+    if (recv_ep)
+        recvs_posted.fetch_sub(1, std::memory_order_relaxed);
+
+    add_to_queue(buf);
+}
+
+/**
+ * @brief Learns the transmitter address again once reconnected, and grants
+ * it the receives posted on the new endpoints.
+ */
+void RdmaRx::on_reconnect()
+{
+    peer_known = false;
+    credits_sent = 0;
+}
+
+/**
+ * @brief Allocates the reorder window. The window holds the receives posted
+ * on all endpoints, rounded up to a power of two.
+ */
+Result RdmaRx::reorder_init()
+{
+    size_t window = std::bit_ceil(std::max<size_t>(rdma_num_eps * queue_size, 64));
+
+    reorder_ring.reset(new(std::nothrow) ReorderEntry[window]);
+    if (!reorder_ring) {
+        log::error("RDMA rx reorder window alloc failed")("window", window)
+                  ("kind", kind2str(_kind));
+        return Result::error_out_of_memory;
+    }
+
+    reorder_mask = window - 1;
+    reorder_head = UINT64_MAX;
+    reorder_tail = 0;
+    reorder_pending = 0;
+    reorder_gap_ts = 0;
+    reorder_timeout_ns = (int64_t)config::proxy.rdma.reorder_timeout_us * 1000;
+
+    log::debug("RDMA rx reorder window")("window", window)
+              ("timeout_us", config::proxy.rdma.reorder_timeout_us)
+              ("kind", kind2str(_kind));
+
+    return Result::success;
+}
+
+/**
+ * @brief Slots a received frame into the reorder window.
+ *
+ * A frame too far ahead of the window makes room by skipping the oldest
+ * missing frames. A frame behind the window start is dropped as late, unless
+ * it is so far behind that the transmitter must have restarted its sequence,
+ * in which case the window is resynchronized.
+ */
+void RdmaRx::reorder_insert(context::Context& ctx, void *buf, uint32_t len,
+                            uint64_t seq)
+{
+    uint64_t window = reorder_mask + 1;
+
+    if (reorder_head == UINT64_MAX) {
+        reorder_head = seq;
+        reorder_tail = seq;
+    }
+
+    if (seq < reorder_head) {
+        if (reorder_head - seq <= window) {
+            reorder_stats.late.fetch_add(1, std::memory_order_relaxed);
+            recycle_buffer(buf);
+            return;
+        }
+
+        log::warn("RDMA rx sequence restarted, resynchronizing")
+            ("expected", reorder_head)("seq", seq)("kind", kind2str(_kind));
+        flush_in_order(ctx, UINT64_MAX);
+        reorder_head = seq;
+        reorder_tail = seq;
+    } else if (seq - reorder_head >= window) {
+        flush_in_order(ctx, seq - window + 1);
+    }
+
+    auto& entry = reorder_ring[seq & reorder_mask];
+    if (entry.buf) {
+        // Duplicate of a frame waiting in the window
+        reorder_stats.late.fetch_add(1, std::memory_order_relaxed);
+        recycle_buffer(buf);
+        return;
+    }
+
+    if (seq < reorder_tail)
+        reorder_stats.reordered.fetch_add(1, std::memory_order_relaxed);
+    else
+        reorder_tail = seq + 1;
+
+    entry = { .buf = buf, .len = len, .ts = telemetry::now_ns() };
+
+    if (!reorder_pending++)
+        reorder_gap_ts = entry.ts;
+}
+
+/**
+ * @brief Skips the missing frame at the window start when the first frame
+ * waiting for it has exceeded the reorder timeout, or when every receive
+ * buffer is held by the window or by the consumers, so the missing frame
+ * can no longer be received.
+ */
+void RdmaRx::reorder_expire(context::Context& ctx)
+{
+    if (!reorder_pending || reorder_ring[reorder_head & reorder_mask].buf)
+        return;
+
+    bool starved = shared_rx ? shared_rx->starved() :
+                   reorder_pending + rx_pool->outstanding() >= (uint32_t)queue_size;
+
+    if (!starved && telemetry::now_ns() - reorder_gap_ts < reorder_timeout_ns)
+        return;
+
+    flush_in_order(ctx, reorder_head + 1);
+}
+
+/**
+ * @brief Restarts the reorder timeout from the arrival of the first frame
+ * waiting behind the missing frame at the window start.
+ */
+void RdmaRx::reorder_update_gap()
+{
+    if (!reorder_pending)
+        return;
+
+    for (uint64_t seq = reorder_head + 1; ; seq++) {
+        auto& entry = reorder_ring[seq & reorder_mask];
+        if (entry.buf) {
+            reorder_gap_ts = entry.ts;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Delivers the frames that became in order to the linked connection.
+ *
+ * Frames are passed in bursts of up to burst_max buffer handles, so the
+ * per-call overhead of the data plane is paid once per burst. Every handle
+ * carries the length of the payload actually received. A buffer is
+ * reposted for receiving when the last consumer releases its handle.
+ * Missing frames numbered below skip_to are skipped and counted as lost.
+ *
+ * @param ctx The context for managing the operation.
+ * @param skip_to The sequence number up to which missing frames are skipped.
+ */
+void RdmaRx::flush_in_order(context::Context& ctx, uint64_t skip_to)
+{
+    BufferHandle *bufs[burst_max];
+    uint32_t count = 0;
+    uint64_t prev_head = reorder_head;
+
+    if (reorder_head == UINT64_MAX)
+        return;
+
+    for (;;) {
+        size_t head_idx = reorder_head & reorder_mask;
+        auto entry = reorder_ring[head_idx];
+        void *ready = entry.buf;
+
+        if (!ready && reorder_head < skip_to) {
+            if (reorder_pending) {
+                reorder_stats.skipped.fetch_add(1, std::memory_order_relaxed);
+                ++reorder_head;
+                continue;
+            }
+
+            // Nothing is waiting, jump over the rest of the gap at once
+            if (skip_to != UINT64_MAX) {
+                reorder_stats.skipped.fetch_add(skip_to - reorder_head,
+                                                std::memory_order_relaxed);
+                reorder_head = skip_to;
             }
-            // else: -EAGAIN or -FI_ENOTCONN → retry
         }
 
-        /* ---------- hybrid back-off when no CQ work was done ---------- */
-        static constexpr int SPIN_LIMIT  =  50;   // ≈ 1–2 µs of busy-wait
-        static constexpr int YIELD_LIMIT = 200;   // then ~200 sched_yield() calls
-        static thread_local int idle_cycles = 0;  // per-thread counter
-
-        if (!did_work) {
-            if (idle_cycles < SPIN_LIMIT) {
-                /* short spin: cheapest path at high packet rate */
-                _mm_pause();             // pause instruction = 40–100 ns
-            } else if (idle_cycles < SPIN_LIMIT + YIELD_LIMIT) {
-                /* medium wait: let other threads run */
-                std::this_thread::yield();
+        if (ready) {
+            reorder_ring[head_idx] = {};
+            ++reorder_head;
+            --reorder_pending;
+
+            auto buf = rx_pool->alloc();
+            if (buf) {
+                buf->data = ready;
+                buf->size = entry.len;
+                buf->on_release = on_rx_buffer_release;
+                buf->owner = rx_owner;
+                buf->cookie = (uint64_t)shared_rx;
+                bufs[count++] = buf;
             } else {
-                /* long wait: nothing for a while – real sleep */
-                std::this_thread::sleep_for(
-                    std::chrono::microseconds(CQ_RETRY_DELAY_US));
+                log::error("RDMA rx buffer pool exhausted")
+                    ("buffer_address", ready)("kind", kind2str(_kind));
+                if (recycle_buffer(ready) != Result::success)
+                    log::error("Failed to recycle buffer to queue")
+                        ("buffer_address", ready)("kind", kind2str(_kind));
             }
-            ++idle_cycles;               // back-off gets longer
-        } else {
-            idle_cycles = 0;             // reset after we did useful work
         }
+
+        if (count && (!ready || count == burst_max)) {
+            Result r = transmit_burst(ctx, bufs, count);
+            if (r != Result::success) {
+                log::error("RDMA rx failed to transmit buffers")
+                    ("count", count)
+                    ("kind", kind2str(_kind));
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+                bufs[i]->release();
+            count = 0;
+        }
+
+        if (!ready)
+            break;
     }
 
-shutdown:
-    // Signal all endpoints to stop
-    for (auto* ep : ep_ctxs) {
-        if (ep) ep->stop_flag = true;
+    if (reorder_head != prev_head)
+        reorder_update_gap();
+}
+
+void RdmaRx::collect(telemetry::Metric& metric, const int64_t& timestamp_ms)
+{
+    Rdma::collect(metric, timestamp_ms);
+
+    if (rma_write)
+        return;
+
+    metric.addFieldUint64("rdreord", reorder_stats.reordered.load(std::memory_order_relaxed));
+    metric.addFieldUint64("rdlate", reorder_stats.late.load(std::memory_order_relaxed));
+    metric.addFieldUint64("rdskip", reorder_stats.skipped.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Returns a received buffer for receiving again, to the shared
+ * receive context or to the queue.
+ */
+Result RdmaRx::recycle_buffer(void *buf)
+{
+    if (!shared_rx)
+        return add_to_queue(buf);
+
+    shared_rx->repost(buf);
+    return Result::success;
+}
+
+void RdmaRx::on_rx_buffer_release(BufferHandle *buf)
+{
+    auto owner = static_cast<sync::DataplaneAtomicPtr *>(buf->owner);
+    auto _this = static_cast<RdmaRx *>(owner->load_next_lock());
+
+    // Recycle buffer. After shutdown, a buffer of the shared receive context
+    // still goes back to the context, which stays attached until then.
+    if (_this) {
+        if (_this->recycle_buffer(buf->data) != Result::success)
+            log::error("Failed to recycle buffer to queue")
+                ("buffer_address", buf->data)("kind", kind2str(_this->_kind));
+    } else if (buf->cookie) {
+        reinterpret_cast<RdmaSharedRx *>(buf->cookie)->repost(buf->data);
     }
+
+    owner->unlock();
+}
+
+/**
+ * @brief Stops the buffer handles still held by the consumers from
+ * returning their buffers to the receiver. Waits only for the releases
+ * in progress, not for the consumers.
+ */
+void RdmaRx::rx_close()
+{
+    if (rx_owner)
+        rx_owner->store_wait(nullptr);
+}
+
+/**
+ * @brief Defers freeing the buffer memory until the consumers release the
+ * last buffer handle.
+ */
+void RdmaRx::retire(std::function<void()> fn)
+{
+    if (rx_pool)
+        rx_pool->on_destroy(std::move(fn));
+    else
+        fn();
+}
+
+/**
+ * @brief Handles the completion queue of the write transport in a dedicated
+ * thread.
+ *
+ * Remote writes carry the index of the slot written by the transmitter.
+ * Written slots are delivered in ring order. The hello message of the
+ * transmitter is answered with the description of the ring, and the slots
+ * released by the consumers are returned as credits.
+ *
+ * @param ctx The context for managing thread cancellation and operations.
+ */
+void RdmaRx::write_cq_thread(context::Context& ctx)
+{
+    int idle_cycles = 0;
+
+    while (!ctx.cancelled()) {
+        int ret = write_poll_cq(ctx);
+        if (ret < 0)
+            break;
+
+        cq_idle(ret > 0, idle_cycles);
+    }
+
+    stop_endpoints();
     log::info("RDMA RX CQ thread stopped.")("kind", kind2str(_kind));
 }
 
+/**
+ * @brief Makes one non-blocking pass over the completion queue of the write
+ * transport, and returns the released slots as credits.
+ *
+ * @return The number of completions handled, or -1 on a fatal CQ read error.
+ */
+int RdmaRx::write_poll_cq(context::Context& ctx)
+{
+    struct fi_cq_data_entry cq_entries[CQ_BATCH_SIZE];
+    int work = 0;
+
+    // Poll the CQ of every rail once. Control messages arrive on the first one.
+    for (auto *ep : cq_eps) {
+        struct fid_cq *cq = ep->cq_ctx.cq;
+
+        int ret = fi_cq_read(cq, cq_entries, CQ_BATCH_SIZE);
+        if (ret > 0) {
+            work += ret;
+
+            for (int i = 0; i < ret; ++i) {
+                auto& entry = cq_entries[i];
+
+                if ((entry.flags & FI_REMOTE_CQ_DATA) && (entry.flags & FI_RMA)) {
+                    uint32_t data = static_cast<uint32_t>(entry.data);
+                    uint32_t slot = data & WRITE_SLOT_MASK;
+                    uint32_t chunks = data >> WRITE_SLOT_BITS;
+                    if (slot >= (uint32_t)queue_size) {
+                        log::error("RDMA rx bad slot index, dropping")
+                            ("slot", slot)("kind", kind2str(_kind));
+                        continue;
+                    }
+
+                    // The tombstone of a lost frame tells how many writes
+                    // the slot sees in all
+                    if (data & WRITE_SKIP)
+                        slot_lost[slot] = std::max(chunks, 1u);
+                    if (slot_lost[slot])
+                        chunks = slot_lost[slot];
+
+                    // Chunks of a segmented write land in any order
+                    if (chunks > 1 && ++slot_chunks[slot] < chunks)
+                        continue;
+
+                    slot_chunks[slot] = 0;
+                    slot_ready[slot] = true;
+                    continue;
+                }
+
+                if (!is_ctrl(entry.op_context))
+                    continue;
+
+                if (entry.flags & FI_SEND) {
+                    ctrl_on_send_completion();
+                    continue;
+                }
+
+                auto msg = static_cast<WriteCtrl *>(entry.op_context);
+                write_on_ctrl(msg);
+
+                int err = ctrl_post_recv(msg);
+                if (err)
+                    log::error("RDMA rx failed to repost control message receive")
+                        ("error", fi_strerror(-err))("kind", kind2str(_kind));
+            }
+        }
+        else if (ret == -FI_EAVAIL) {
+            fi_cq_err_entry err_entry {};
+            int err_ret = fi_cq_readerr(cq, &err_entry, 0);
+            if (err_ret >= 0) {
+                if (err_entry.err != FI_ECANCELED)
+                    log::error("RDMA rx encountered CQ error")
+                        ("error", fi_strerror(err_entry.err))("kind", kind2str(_kind));
+
+                if (is_ctrl(err_entry.op_context) && (err_entry.flags & FI_SEND))
+                    ctrl_on_send_completion();
+            } else {
+                log::error("RDMA rx failed to read CQ error entry")
+                    ("error", fi_strerror(-err_ret))("kind", kind2str(_kind));
+            }
+            work++;
+        }
+        else if (ret != -FI_EAGAIN && ret != -FI_ENOTCONN) {
+            log::error("RDMA rx cq read failed")
+                ("error", fi_strerror(-ret))("kind", kind2str(_kind));
+            return -1;
+        }
+    }
+
+    if (work)
+        write_deliver(ctx);
+
+    write_return_credits(!work);
+
+    return work;
+}
+
+/**
+ * @brief Answers the hello message of the transmitter with the description
+ * of the ring of slots, sent to the address the message carries.
+ */
+void RdmaRx::write_on_ctrl(WriteCtrl *msg)
+{
+    if (msg->magic != WRITE_CTRL_MAGIC || msg->type != WriteCtrlType::hello) {
+        log::warn("RDMA rx unexpected control message")
+            ("type", static_cast<uint32_t>(msg->type))("kind", kind2str(_kind));
+        return;
+    }
+
+    if (!ctrl_set_peer(msg))
+        return;
+
+    peer_known = true;
+
+    auto info = m_dev_handle->info;
+
+    WriteCtrl ring = {};
+    ring.credits = release_head;
+    ring.addr = (info->domain_attr->mr_mode & FI_MR_VIRT_ADDR) ? (uint64_t)buffer_block : 0;
+    ring.slots = queue_size;
+    ring.slot_size = ring_slot_size();
+    for (size_t i = 0; i < ep_ctxs.size() && i < std::size(ring.keys); i++)
+        ring.keys[i] = fi_mr_key(block_mr(i));
+
+    int err = ctrl_send(WriteCtrlType::ring, ring);
+    if (err) {
+        log::error("RDMA rx failed to send ring description")
+            ("error", fi_strerror(-err))("kind", kind2str(_kind));
+        return;
+    }
+
+    log::info("RDMA rx write ring exposed")("slots", ring.slots)
+             ("slot_size", ring.slot_size)("kind", kind2str(_kind));
+}
+
+/**
+ * @brief Delivers the written slots to the linked connection in ring order,
+ * in bursts of up to burst_max buffer handles. A slot holds the payload
+ * length followed by the payload. The slot of a frame lost by the
+ * transmitter is released at once and counted as skipped.
+ */
+void RdmaRx::write_deliver(context::Context& ctx)
+{
+    BufferHandle *bufs[burst_max];
+    uint32_t count = 0;
+    size_t slot_size = ring_slot_size();
+
+    for (;;) {
+        uint32_t slot = deliver_head % queue_size;
+        bool ready = slot_ready[slot];
+
+        if (ready) {
+            slot_ready[slot] = false;
+            ++deliver_head;
+
+            char *ptr = static_cast<char *>(buffer_block) + slot * slot_size;
+            uint64_t len;
+            std::memcpy(&len, ptr, sizeof(len));
+
+            BufferHandle *buf = nullptr;
+
+            if (slot_lost[slot]) {
+                slot_lost[slot] = 0;
+                reorder_stats.skipped.fetch_add(1, std::memory_order_relaxed);
+            } else if (len <= trx_sz) {
+                buf = rx_pool->alloc();
+                if (!buf)
+                    log::error("RDMA rx buffer pool exhausted")
+                        ("slot", slot)("kind", kind2str(_kind));
+            } else {
+                log::error("RDMA rx bad message length, dropping")
+                    ("len", len)("kind", kind2str(_kind));
+            }
+
+            if (buf) {
+                buf->data = ptr + TRAILER;
+                buf->size = len;
+                buf->on_release = on_slot_release;
+                buf->owner = rx_owner;
+                bufs[count++] = buf;
+            } else {
+                slot_released[slot].store(true, std::memory_order_release);
+            }
+        }
+
+        if (count && (!ready || count == burst_max)) {
+            Result r = transmit_burst(ctx, bufs, count);
+            if (r != Result::success) {
+                log::error("RDMA rx failed to transmit buffers")
+                    ("count", count)
+                    ("kind", kind2str(_kind));
+            }
+
+            for (uint32_t i = 0; i < count; i++)
+                bufs[i]->release();
+            count = 0;
+        }
+
+        if (!ready)
+            break;
+    }
+}
+
+void RdmaRx::on_slot_release(BufferHandle *buf)
+{
+    auto owner = static_cast<sync::DataplaneAtomicPtr *>(buf->owner);
+    auto _this = static_cast<RdmaRx *>(owner->load_next_lock());
+
+    if (_this) {
+        auto ptr = static_cast<char *>(buf->data) - TRAILER;
+        size_t slot = (ptr - static_cast<char *>(_this->buffer_block)) /
+                      _this->ring_slot_size();
+
+        _this->slot_released[slot].store(true, std::memory_order_release);
+    }
+
+    owner->unlock();
+}
+
+/**
+ * @brief Returns the released slots to the transmitter as credits. Slots
+ * are returned in ring order. Credits are sent in batches of a quarter of
+ * the ring, or whenever the CQ is idle, so the transmitter never waits
+ * for slots released long ago.
+ */
+void RdmaRx::write_return_credits(bool idle)
+{
+    while (release_head < deliver_head) {
+        uint32_t slot = release_head % queue_size;
+        if (!slot_released[slot].exchange(false, std::memory_order_acq_rel))
+            break;
+        ++release_head;
+    }
+
+    uint64_t pending = release_head - credits_sent;
+    uint64_t batch = std::max(1, queue_size / 4);
+
+    if (!peer_known || !pending || (pending < batch && !idle))
+        return;
+
+    WriteCtrl msg = {};
+    msg.credits = release_head;
+
+    if (!ctrl_send(WriteCtrlType::credits, msg))
+        credits_sent = release_head;
+}
+
+/**
+ * @brief Returns the buffers of the shared receive context held by the
+ * connection before its endpoints are destroyed: the completions left in
+ * the completion queues and the frames waiting in the reorder window. The
+ * endpoints are closed first, so no more receives complete on them.
+ */
+void RdmaRx::shared_rx_drain()
+{
+    if (!shared_rx || !init)
+        return;
+
+    for (auto *ep : ep_ctxs)
+        if (ep)
+            RDMA_CLOSE_FID(ep->ep);
+
+    struct fi_cq_data_entry entries[CQ_BATCH_SIZE];
+
+    for (auto *ep : cq_eps) {
+        if (!ep)
+            continue;
+
+        for (;;) {
+            int ret = fi_cq_read(ep->cq_ctx.cq, entries, CQ_BATCH_SIZE);
+            if (ret > 0) {
+                for (int i = 0; i < ret; i++) {
+                    shared_rx->consumed();
+                    shared_rx->repost(entries[i].op_context);
+                }
+                continue;
+            }
+
+            if (ret != -FI_EAVAIL)
+                break;
+
+            fi_cq_err_entry err {};
+            if (fi_cq_readerr(ep->cq_ctx.cq, &err, 0) < 0)
+                break;
+            if (err.op_context) {
+                shared_rx->consumed();
+                shared_rx->repost(err.op_context);
+            }
+        }
+    }
+
+    for (uint64_t i = 0; reorder_pending && i <= reorder_mask; i++) {
+        auto& entry = reorder_ring[i];
+        if (entry.buf) {
+            shared_rx->repost(entry.buf);
+            entry = {};
+            reorder_pending--;
+        }
+    }
+}
+
+/**
+ * @brief Makes one pass for the progress engine: posts receives for the
+ * returned buffers and handles the completions.
+ */
+int RdmaRx::poll(context::Context& ctx)
+{
+    if (rma_write)
+        return write_poll_cq(ctx);
+
+    int posted = shared_rx ? 0 : post_receives();
+
+    int ret = poll_cq(ctx);
+    if (ret < 0)
+        return ret;
+
+    return posted + ret;
+}
+
+Result RdmaRx::on_shutdown(context::Context& ctx)
+{
+    // Stop the delivery of frames before waiting for the buffers in use.
+    progress_detach();
+    rdma_cq_thread_ctx.cancel();
+
+    try {
+        if (handle_rdma_cq_thread.joinable())
+            handle_rdma_cq_thread.join();
+    } catch (const std::exception& e) {
+        log::error("Exception caught while joining RDMA rdma_cq_thread")("error", e.what());
+        return Result::error_general_failure;
+    }
+
+    rx_close();
+    shared_rx_drain();
+
+    auto res = Rdma::on_shutdown(ctx);
+
+    // The buffer memory is freed after the last handle is released.
+    if (rx_pool) {
+        rx_pool->destroy();
+        rx_pool = nullptr;
+        rx_owner = nullptr;
+    }
+
+    return res;
+}
+
 } // namespace mesh::connection
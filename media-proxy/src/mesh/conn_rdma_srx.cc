@@ -0,0 +1,470 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "conn_rdma_srx.h"
+#include "conn_rdma.h"
+#include "logger.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <bit>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <linux/mempolicy.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <netinet/in.h>
+#include <rdma/fi_endpoint.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mesh::connection {
+
+struct RdmaSharedDomain {
+    std::string key;
+    std::string provider;
+    std::string ip;
+    std::string port;
+    libfabric_ctx *dev = nullptr;
+    int node = -1; // NUMA node of the NIC
+    std::list<std::unique_ptr<RdmaSharedRx>> classes;
+};
+
+// Domains live while receivers are attached to them.
+static std::map<std::string, std::unique_ptr<RdmaSharedDomain>> domains;
+static std::mutex domains_mx;
+
+/**
+ * Open the domain of the receivers of the provider on the local address,
+ * with shared receive contexts. Returns nullptr if the provider has none,
+ * or binds memory registrations to endpoints.
+ */
+static std::unique_ptr<RdmaSharedDomain> domain_open(const std::string& key,
+                                                     const libfabric_ctx& want)
+{
+    auto dom = std::make_unique<RdmaSharedDomain>();
+    dom->key = key;
+    dom->provider = want.provider_name;
+    dom->ip = want.local_ip;
+    dom->port = want.local_port;
+
+    auto dev = (libfabric_ctx *)calloc(1, sizeof(libfabric_ctx));
+    if (!dev) {
+        log::error("Failed to allocate RDMA shared domain context")("error", strerror(errno));
+        return nullptr;
+    }
+
+    dev->kind          = FI_KIND_RECEIVER;
+    dev->local_ip      = dom->ip.c_str();
+    dev->local_port    = dom->port.c_str();
+    dev->provider_name = dom->provider.c_str();
+    dev->unreliable    = want.unreliable;
+    dev->shared_rx     = true;
+
+    int ret = libfabric_dev_ops.rdma_init(&dev);
+    if (ret) {
+        free(dev); // may have been freed and reset by rdma_init()
+        log::info("RDMA shared receive context not supported")
+                 ("provider", dom->provider)("local_ip", dom->ip)
+                 ("error", fi_strerror(-ret));
+        return nullptr;
+    }
+
+    // Buffers posted to the context are registered once for all endpoints
+    if (dev->info->domain_attr->mr_mode & FI_MR_ENDPOINT) {
+        log::info("RDMA shared receive context not supported")
+                 ("provider", dom->provider)("local_ip", dom->ip)
+                 ("reason", "per-endpoint memory registration");
+        libfabric_dev_ops.rdma_deinit(&dev);
+        return nullptr;
+    }
+
+    dom->dev = dev;
+    dom->node = Rdma::nic_numa_node(dom->ip.c_str());
+
+    log::info("RDMA shared receive domain opened")("provider", dom->provider)
+             ("local_ip", dom->ip)("numa_node", dom->node);
+
+    return dom;
+}
+
+static void domain_close(RdmaSharedDomain *dom)
+{
+    int ret = libfabric_dev_ops.rdma_deinit(&dom->dev);
+    if (ret)
+        log::error("Failed to deinitialize RDMA shared domain")("error", fi_strerror(-ret));
+
+    log::info("RDMA shared receive domain closed")("provider", dom->provider)
+             ("local_ip", dom->ip);
+}
+
+/**
+ * Clone the device context of the domain for a receiver, with the local
+ * port of the receiver as the source address of its endpoints.
+ */
+static libfabric_ctx *domain_clone(RdmaSharedDomain *dom, const char *port)
+{
+    fi_info *info = fi_dupinfo(dom->dev->info);
+    if (!info)
+        return nullptr;
+
+    if (info->src_addr && info->src_addrlen == sizeof(sockaddr_in))
+        reinterpret_cast<sockaddr_in *>(info->src_addr)->sin_port =
+            htons(static_cast<unsigned short>(std::atoi(port)));
+
+    auto dev = static_cast<libfabric_ctx *>(calloc(1, sizeof(libfabric_ctx)));
+    if (!dev) {
+        fi_freeinfo(info);
+        return nullptr;
+    }
+
+    *dev = *dom->dev; // shallow copy
+    dev->info = info;
+    dev->local_port = port;
+
+    return dev;
+}
+
+/**
+ * Round the size up to a multiple of a quarter of its highest power of two,
+ * and at least to a page, so a buffer wastes less than a quarter of it.
+ */
+size_t RdmaSharedRx::size_class(size_t size)
+{
+    size_t step = std::max<size_t>(PAGE_SIZE, std::bit_floor(size) / 4);
+
+    return (size + step - 1) / step * step;
+}
+
+/**
+ * Attach the receiver to the shared receive context of its domain and size
+ * class, opening them if needed. The pool is filled up to the queue size of
+ * the receiver, and may grow by its queue size.
+ */
+RdmaSharedRx * RdmaSharedRx::attach(const libfabric_ctx& want, size_t buf_size,
+                                    uint32_t queue_size, libfabric_ctx **dev)
+{
+    std::lock_guard<std::mutex> lk(domains_mx);
+
+    std::string key = std::string(want.provider_name) + "/" + want.local_ip +
+                      (want.unreliable ? "/dgram" : "/rdm");
+
+    auto it = domains.find(key);
+    if (it == domains.end()) {
+        auto dom = domain_open(key, want);
+        if (!dom)
+            return nullptr;
+        it = domains.emplace(key, std::move(dom)).first;
+    }
+
+    RdmaSharedDomain *dom = it->second.get();
+    size_t slot_size = size_class(buf_size);
+    RdmaSharedRx *srx = nullptr;
+
+    for (auto& c : dom->classes) {
+        if (c->slot_size == slot_size) {
+            srx = c.get();
+            break;
+        }
+    }
+
+    if (!srx) {
+        srx = new(std::nothrow) RdmaSharedRx(dom, slot_size);
+        if (srx && !srx->open()) {
+            delete srx;
+            srx = nullptr;
+        }
+        if (srx)
+            dom->classes.emplace_back(srx);
+    }
+
+    *dev = srx ? domain_clone(dom, want.local_port) : nullptr;
+    if (!*dev) {
+        release(dom, srx);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lk_srx(srx->mx);
+
+    srx->users++;
+    srx->queued += queue_size;
+    srx->fill = std::min(std::max(srx->fill, queue_size), srx->depth);
+    srx->capacity.store(std::min<uint64_t>(srx->queued, srx->depth));
+    srx->grow_mark.store(std::max(srx->fill / 4, 1u));
+
+    uint32_t have = srx->posted.load() + srx->spare.size();
+    if (have < srx->fill)
+        srx->grow_locked(srx->fill - have);
+
+    log::info("RDMA rx attached to shared receive context")("local_ip", dom->ip)
+             ("local_port", want.local_port)("buf_size", slot_size)
+             ("receivers", srx->users)("pool", srx->total.load())
+             ("capacity", srx->capacity.load());
+
+    return srx;
+}
+
+/**
+ * Detach a receiver whose endpoints are closed, and free its device context.
+ * The last receiver closes the context, and the last context the domain.
+ */
+void RdmaSharedRx::detach(libfabric_ctx *dev, uint32_t queue_size)
+{
+    std::lock_guard<std::mutex> lk(domains_mx);
+
+    if (dev) {
+        fi_freeinfo(dev->info);
+        free(dev);
+    }
+
+    {
+        std::lock_guard<std::mutex> lk_srx(mx);
+
+        users--;
+        queued -= std::min<uint64_t>(queued, queue_size);
+        capacity.store(std::min<uint64_t>(queued, depth));
+    }
+
+    release(dom, this);
+}
+
+/**
+ * Close the context if no receiver is attached to it, and the domain if it
+ * has no context left. Called with the domain registry locked.
+ */
+void RdmaSharedRx::release(RdmaSharedDomain *dom, RdmaSharedRx *srx)
+{
+    if (srx && !srx->users) {
+        srx->close();
+        dom->classes.remove_if([srx](auto& c) { return c.get() == srx; });
+    }
+
+    if (dom->classes.empty()) {
+        std::string key = dom->key;
+
+        domain_close(dom);
+        domains.erase(key);
+    }
+}
+
+bool RdmaSharedRx::open()
+{
+    struct fi_rx_attr attr = *dom->dev->info->rx_attr;
+
+    int ret = fi_srx_context(dom->dev->domain, &attr, &srx, nullptr);
+    if (ret) {
+        log::error("RDMA failed to open shared receive context")
+                  ("error", fi_strerror(-ret))("local_ip", dom->ip);
+        srx = nullptr;
+        return false;
+    }
+
+    depth = attr.size ? std::min<size_t>(attr.size, UINT32_MAX) : UINT32_MAX;
+
+    grow_th = std::jthread([this](std::stop_token stoken) { grow_thread(stoken); });
+    return true;
+}
+
+/**
+ * Close the context, which cancels its receives, and release the pool.
+ * The endpoints bound to it must be closed already. Receivers detach only
+ * after the consumers have released their buffer handles, so no buffer of
+ * the pool is in use.
+ */
+void RdmaSharedRx::close()
+{
+    if (grow_th.joinable()) {
+        grow_th.request_stop();
+        grow_th.join();
+    }
+
+    RDMA_CLOSE_FID(srx);
+
+    for (auto& c : chunks)
+        chunk_free(c);
+
+    chunks.clear();
+    spare.clear();
+    posted = 0;
+    total = 0;
+}
+
+/**
+ * Map a chunk of the slots on the NUMA node of the NIC and register it once.
+ */
+bool RdmaSharedRx::chunk_alloc(uint32_t slots, Chunk& chunk)
+{
+    size_t size = slots * slot_size;
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        log::error("RDMA shared receive pool alloc failed")("size", size)
+                  ("error", strerror(errno));
+        return false;
+    }
+
+    if (dom->node >= 0 && dom->node < 64) {
+        unsigned long nodemask = 1UL << dom->node;
+        syscall(SYS_mbind, base, size, MPOL_PREFERRED, &nodemask, 64, 0);
+    }
+
+    chunk = { static_cast<char *>(base), size, nullptr, nullptr };
+
+    int ret = libfabric_mr_ops.rdma_reg_mr(
+        dom->dev, nullptr, base, size,
+        libfabric_mr_ops.rdma_info_to_mr_access(dom->dev->info), (uint64_t)base,
+        FI_HMEM_SYSTEM, 0, &chunk.mr, &chunk.desc);
+    if (ret) {
+        log::error("RDMA shared receive pool registration failed")("size", size)
+                  ("error", fi_strerror(-ret));
+        munmap(base, size);
+        return false;
+    }
+
+    return true;
+}
+
+void RdmaSharedRx::chunk_free(Chunk& chunk)
+{
+    if (chunk.mr)
+        libfabric_mr_ops.rdma_unreg_mr(chunk.mr);
+    libfabric_mr_ops.rdma_mr_cache_invalidate(dom->dev, chunk.base, chunk.size);
+    munmap(chunk.base, chunk.size);
+}
+
+/**
+ * Add the chunk to the pool and post its buffers.
+ */
+void RdmaSharedRx::chunk_add_locked(const Chunk& chunk, uint32_t slots)
+{
+    auto pos = std::upper_bound(chunks.begin(), chunks.end(), chunk.base,
+                                [](char *p, const Chunk& c) { return p < c.base; });
+    chunks.insert(pos, chunk);
+    total.fetch_add(slots);
+
+    for (uint32_t i = 0; i < slots; i++) {
+        void *buf = chunk.base + i * slot_size;
+        if (!post_locked(buf))
+            spare.push_back(buf);
+    }
+}
+
+/**
+ * Add buffers to the pool in chunks, up to its capacity, and post them.
+ * Called when a receiver attaches.
+ */
+void RdmaSharedRx::grow_locked(uint32_t slots)
+{
+    while (slots) {
+        uint32_t room = capacity.load() - std::min(total.load(), capacity.load());
+        uint32_t n = std::min({ slots, room, CHUNK_SLOTS });
+        if (!n)
+            return;
+
+        Chunk chunk = {};
+        if (!chunk_alloc(n, chunk))
+            return;
+
+        chunk_add_locked(chunk, n);
+        slots -= n;
+    }
+}
+
+/**
+ * Add a chunk to the pool whenever the CQ pollers request one. The chunk is
+ * mapped and registered without holding the pool, so the buffers returned
+ * meanwhile are reposted at once. A receiver may detach meanwhile, and the
+ * chunk is dropped if the pool has no room left for it.
+ */
+void RdmaSharedRx::grow_thread(std::stop_token stoken)
+{
+    while (!stoken.stop_requested()) {
+        {
+            std::unique_lock<std::mutex> lk(grow_mx);
+            if (!grow_cv.wait(lk, stoken, [this]() { return grow_wanted.load(); }))
+                return;
+        }
+
+        uint32_t cap = capacity.load();
+        uint32_t n = std::min(cap - std::min(total.load(), cap), CHUNK_SLOTS);
+
+        Chunk chunk = {};
+        if (n && chunk_alloc(n, chunk)) {
+            std::unique_lock<std::mutex> lk(mx);
+
+            if (total.load() + n <= capacity.load()) {
+                chunk_add_locked(chunk, n);
+            } else {
+                lk.unlock();
+                chunk_free(chunk);
+            }
+        }
+
+        grow_wanted.store(false);
+    }
+}
+
+void *RdmaSharedRx::desc_of(void *buf) const
+{
+    auto pos = std::upper_bound(chunks.begin(), chunks.end(), static_cast<char *>(buf),
+                                [](char *p, const Chunk& c) { return p < c.base; });
+
+    return pos == chunks.begin() ? nullptr : std::prev(pos)->desc;
+}
+
+bool RdmaSharedRx::post_locked(void *buf)
+{
+    int ret = fi_recv(srx, buf, slot_size, desc_of(buf), FI_ADDR_UNSPEC, buf);
+    if (ret) {
+        if (ret != -FI_EAGAIN)
+            log::error("RDMA failed to post shared receive")("buffer_address", buf)
+                      ("error", fi_strerror(-ret));
+        return false;
+    }
+
+    posted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Called by the CQ poller of a receiver for every completed receive. Asks
+ * the thread of the context for a chunk when few receives are left posted,
+ * since the buffers are held by the consumers. The thread is woken up once
+ * per chunk.
+ */
+void RdmaSharedRx::consumed()
+{
+    uint32_t left = posted.fetch_sub(1, std::memory_order_relaxed) - 1;
+
+    if (left >= grow_mark.load(std::memory_order_relaxed) ||
+        total.load(std::memory_order_relaxed) >= capacity.load(std::memory_order_relaxed) ||
+        grow_wanted.load(std::memory_order_relaxed) || grow_wanted.exchange(true))
+        return;
+
+    // Taken so the wake-up can't fall between the check and the wait
+    { std::lock_guard<std::mutex> lk(grow_mx); }
+    grow_cv.notify_one();
+}
+
+/**
+ * Return the buffer of a completed receive to the context. Buffers that
+ * failed to post earlier are retried first.
+ */
+void RdmaSharedRx::repost(void *buf)
+{
+    std::lock_guard<std::mutex> lk(mx);
+
+    while (!spare.empty() && post_locked(spare.back()))
+        spare.pop_back();
+
+    if (!post_locked(buf))
+        spare.push_back(buf);
+}
+
+} // namespace mesh::connection
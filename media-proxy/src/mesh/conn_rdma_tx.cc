@@ -1,4 +1,5 @@
 #include "conn_rdma_tx.h"
+#include "proxy_config.h"
 #include <stdexcept>
 #include <queue>
 
@@ -11,32 +12,103 @@ RdmaTx::RdmaTx() : Rdma() {
 
 RdmaTx::~RdmaTx()
 {
-    // Any specific cleanup for Tx can go here
+    zero_copy_cleanup();
 }
 
 Result RdmaTx::configure(context::Context& ctx, const mcm_conn_param& request,
-                         libfabric_ctx *& dev_handle)
+                         libfabric_ctx *& dev_handle, const RdmaOptions& options)
 {
     log::debug("RdmaTx configure")("local_ip", request.local_addr.ip)
                                   ("local_port", request.local_addr.port)
                                   ("remote_ip", request.remote_addr.ip)
                                   ("remote_port", request.remote_addr.port);
 
-    return Rdma::configure(ctx, request, dev_handle);
+    Result res = Rdma::configure(ctx, request, dev_handle, options);
+    if (res != Result::success)
+        return res;
+
+    // Only the write transport can place chunks in the receiver buffer
+    segment_size = options.segment_size;
+    if (segment_size && !rma_write) {
+        log::warn("RDMA tx segmented transfer requires the write transport, ignored")
+                 ("segment_size", segment_size)("kind", kind2str(_kind));
+        segment_size = 0;
+    }
+
+    return res;
 }
 
 Result RdmaTx::start_threads(context::Context& ctx)
 {
+    send_slot_size = (((trx_sz + TRAILER) + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
+    send_ts = std::make_unique<std::atomic<int64_t>[]>(queue_size);
+    send_ep = std::make_unique<std::atomic<uint8_t>[]>(queue_size);
+    ep_outstanding = std::make_unique<std::atomic<uint32_t>[]>(ep_ctxs.size());
+    if (rma_write)
+        write_frames = std::make_unique<WriteFrame[]>(queue_size);
+
+    // Frames must fit the inject size of every rail
+    inject_max = rails.empty() ? 0 : RDMA_INJECT_MAX;
+    for (auto& rail : rails)
+        inject_max = std::min(inject_max, rail.dev->info->tx_attr->inject_size);
+    if (inject_max <= TRAILER)
+        inject_max = 0;
+
+    latency_tight = max_latency_ns && max_latency_ns < BURST_MIN_BUDGET_NS;
+
+    if (config::proxy.rdma.zero_copy_tx) {
+        auto info = m_dev_handle->info;
+
+        // Memory regions are registered with the domain and shared by all
+        // endpoints. Sends gather the payload and the trailer.
+        zero_copy = !(info->domain_attr->mr_mode & FI_MR_ENDPOINT) &&
+                    info->tx_attr->iov_limit >= 2;
+        if (zero_copy)
+            zc_handles = std::make_unique<std::atomic<BufferHandle *>[]>(queue_size);
+        else
+            log::warn("RDMA tx zero-copy not supported by provider, copying")
+                     ("kind", kind2str(_kind));
+    }
+
     rdma_cq_thread_ctx = context::WithCancel(ctx);
 
-    try {
-        handle_rdma_cq_thread =
-            std::jthread([this]() { this->rdma_cq_thread(this->rdma_cq_thread_ctx); });
-    } catch (const std::system_error& e) {
-        log::error("RDMA tx failed to start threads")("error", e.what())
-                  ("kind", kind2str(_kind));
-        return Result::error_thread_creation_failed;
+    ring_ready = false;
+    write_credits = 0;
+    write_head = 0;
+    hello_ts = {};
+    hello_answered = false;
+
+    credits_known = false;
+    credits_granted = 0;
+    credits_used = 0;
+    backlog_head = 0;
+    backlog_len = 0;
+    if (flow_control == RDMA_FLOW_DROP_OLDEST) {
+        backlog_cap = std::max(1, queue_size / 4);
+        backlog = std::make_unique<BacklogEntry[]>(backlog_cap);
+    }
+
+    if (!progress_attach()) {
+        try {
+            if (rma_write)
+                handle_rdma_cq_thread =
+                    std::jthread([this]() { this->write_cq_thread(this->rdma_cq_thread_ctx); });
+            else
+                handle_rdma_cq_thread =
+                    std::jthread([this]() { this->rdma_cq_thread(this->rdma_cq_thread_ctx); });
+        } catch (const std::system_error& e) {
+            log::error("RDMA tx failed to start threads")("error", e.what())
+                      ("kind", kind2str(_kind));
+            return Result::error_thread_creation_failed;
+        }
+    }
+
+    // Register the published memory regions before any frame is sent
+    if (zero_copy) {
+        MemoryRegions::subscribe(this);
+        zc_subscribed = true;
     }
+
     return Result::success;
 }
 
@@ -52,94 +124,267 @@ Result RdmaTx::start_threads(context::Context& ctx)
 
 void RdmaTx::rdma_cq_thread(context::Context& ctx)
 {
-    constexpr uint32_t RETRY_INTERVAL_US = 100;     // 100 µs back-off
-    constexpr uint32_t TIMEOUT_US        = 1'000'000; // 1 s max spin
+    constexpr auto TIMEOUT = std::chrono::seconds(1); // 1 s max wait
+    bool fatal = false;
 
-    // Buffer for batched completions
-    struct fi_cq_entry cq_entries[CQ_BATCH_SIZE];
-
-    while (!ctx.cancelled()) {
+    while (!ctx.cancelled() && !fatal) {
         // Wait until at least one send has occurred
         wait_buf_available();
 
-        uint32_t elapsed = 0;
-        bool     done    = false;
+        auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+        bool timed_out = true;
+        int idle_cycles = 0;
 
-        while (!ctx.cancelled() && elapsed < TIMEOUT_US) {
-        /* We use a single CQ for all QPs – skip duplicates */
-        struct fid_cq *last_cq = nullptr;
-        for (auto *ep : ep_ctxs) {
-            if (!ep) continue;
+        while (!ctx.cancelled() && std::chrono::steady_clock::now() < deadline) {
+            int ret = poll_cq(ctx);
+            if (ret > 0) {
+                // Poll again, more completions may be pending
+                notify_buf_available();
+                timed_out = false;
+                break;
+            }
+            if (ret < 0) {
+                fatal = true;
+                timed_out = false;
+                break;
+            }
 
-            struct fid_cq *cq = ep->cq_ctx.cq;
-            if (cq == last_cq)           // already handled in this iteration
-                continue;
-            last_cq = cq;
-
-            int ret = fi_cq_read(cq, cq_entries, CQ_BATCH_SIZE);
-                if (ret > 0) {
-                    // We got completions on this QP
-                    for (int i = 0; i < ret; ++i) {
-                        void *buf = cq_entries[i].op_context;
-                        if (!buf) {
-                            log::error("RDMA tx null buffer context, skipping...")
-                                ("kind", kind2str(_kind));
-                            continue;
-                        }
-                        if (add_to_queue(buf) != Result::success) {
-                            log::error("RDMA tx failed to add buffer back to queue")
-                                ("buffer_address", buf)
-                                ("kind", kind2str(_kind));
-                        }
-                    }
-                    done = true;
+            // No events yet on either CQ, wait per the completion strategy
+            cq_idle(false, idle_cycles);
+        }
+
+        if (timed_out && !ctx.cancelled()) {
+            log::debug("RDMA tx cq read timed out after retries")
+                ("kind", kind2str(_kind));
+        }
+    }
+
+    stop_endpoints();
+    log::info("RDMA TX CQ thread stopped.")("kind", kind2str(_kind));
+}
+
+/**
+ * @brief Makes one non-blocking pass over the completion queues and returns
+ * the buffers of the completed sends to the queue.
+ *
+ * @return The number of completions handled, or -1 on a fatal CQ read error.
+ */
+int RdmaTx::poll_cq(context::Context& ctx, bool drain)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    // Buffer for batched completions
+    struct fi_cq_data_entry cq_entries[CQ_BATCH_SIZE];
+    int work = 0;
+    bool credited = false;
+
+    /* One CQ per rail, shared by the QPs of the rail */
+    for (auto *ep : cq_eps) {
+        if (!ep) continue;
+
+        struct fid_cq *cq = ep->cq_ctx.cq;
+
+        int ret = fi_cq_read(cq, cq_entries, CQ_BATCH_SIZE);
+        if (ret > 0) {
+            // We got completions on this rail
+            for (int i = 0; i < ret; ++i) {
+                void *buf = cq_entries[i].op_context;
+                if (!buf) {
+                    log::error("RDMA tx null buffer context, skipping...")
+                        ("kind", kind2str(_kind));
+                    continue;
                 }
-                else if (ret == -FI_EAVAIL) {
-                    // asynchronous error completions ― recycle buffers too
-                    fi_cq_err_entry err {};
-                    if (fi_cq_readerr(ep->cq_ctx.cq, &err, 0) >= 0) {
-                        log::error("RDMA tx CQ error")("error", fi_strerror(err.err))
-                            ("kind", kind2str(_kind));
-                        if (err.op_context) {
-                            add_to_queue(err.op_context); // reclaim the failed buffer
-                        }
+
+                // Credits granted by the receiver
+                if (is_ctrl(buf)) {
+                    if (cq_entries[i].flags & FI_RECV) {
+                        auto msg = static_cast<WriteCtrl *>(buf);
+                        write_on_ctrl(msg);
+                        credited = true;
+
+                        int err = ctrl_post_recv(msg);
+                        if (err)
+                            log::error("RDMA tx failed to repost control message receive")
+                                ("error", fi_strerror(-err))("kind", kind2str(_kind));
                     } else {
-                        log::error("RDMA tx failed to read CQ error entry")
-                            ("kind", kind2str(_kind));
+                        ctrl_on_send_completion();
                     }
-                    done = true;
+                    continue;
                 }
-                else if (ret != -EAGAIN) {
-                    // fatal CQ read error
-                    log::error("RDMA tx cq read failed")
-                        ("error", fi_strerror(-ret))
+
+                on_send_completion(buf);
+                endpoint_release(buf);
+                zero_copy_release(buf);
+                if (add_to_queue(buf) != Result::success) {
+                    log::error("RDMA tx failed to add buffer back to queue")
+                        ("buffer_address", buf)
                         ("kind", kind2str(_kind));
-                    done = true;
                 }
-
-                if (done) break;     // processed something on this iteration
             }
-
-            if (done) break;         // go back to outer loop
-
-            // No events yet on either CQ, back off a bit
-            std::this_thread::sleep_for(std::chrono::microseconds(RETRY_INTERVAL_US));
-            elapsed += RETRY_INTERVAL_US;
+            work += ret;
         }
+        else if (ret == -FI_EAVAIL) {
+            // asynchronous error completions ― recycle buffers too
+            fi_cq_err_entry err {};
+            if (fi_cq_readerr(ep->cq_ctx.cq, &err, 0) >= 0) {
+                log::error("RDMA tx CQ error")("error", fi_strerror(err.err))
+                    ("kind", kind2str(_kind));
+                if (err.err == FI_ECONNRESET || err.err == FI_ENOTCONN)
+                    link_lost(-err.err);
 
-        if (elapsed >= TIMEOUT_US) {
-            log::debug("RDMA tx cq read timed out after retries")
+                if (is_ctrl(err.op_context)) {
+                    if (err.flags & FI_SEND)
+                        ctrl_on_send_completion();
+                } else if (err.op_context) {
+                    endpoint_release(err.op_context);
+                    zero_copy_release(err.op_context);
+                    add_to_queue(err.op_context); // reclaim the failed buffer
+                }
+            } else {
+                log::error("RDMA tx failed to read CQ error entry")
+                    ("kind", kind2str(_kind));
+            }
+            work++;
+        }
+        else if (ret != -EAGAIN) {
+            // fatal CQ read error
+            log::error("RDMA tx cq read failed")
+                ("error", fi_strerror(-ret))
                 ("kind", kind2str(_kind));
+            return -1;
         }
     }
 
-    // Signal shutdown on all endpoints
-    for (auto *ep : ep_ctxs) {
-        if (ep) ep->stop_flag = true;
+    if (credited && drain)
+        flow_drain(ctx);
+
+    hello_poll();
+
+    reconnect_poll();
+
+    return work;
+}
+
+/**
+ * @brief Drops frames while the link is reconnecting, returning their
+ * registered buffers, if any, to the queue. The CQ poller is woken up to
+ * reconnect.
+ */
+void RdmaTx::link_drop(void **reg_bufs, uint32_t count)
+{
+    for (uint32_t i = 0; reg_bufs && i < count; i++)
+        add_to_queue(reg_bufs[i]);
+
+    link_dropped.fetch_add(count, std::memory_order_relaxed);
+    notify_buf_available();
+}
+
+/**
+ * @brief Returns a buffer posted on an old endpoint to the queue, releasing
+ * the ingress buffer it was sent from.
+ */
+void RdmaTx::recycle_posted(void *buf)
+{
+    zero_copy_release(buf);
+    add_to_queue(buf);
+}
+
+/**
+ * @brief Starts the new endpoints with no sends in flight, and unlimited
+ * until the receiver grants credits again.
+ */
+void RdmaTx::on_reconnect()
+{
+    if (ep_outstanding) {
+        for (size_t i = 0; i < ep_ctxs.size(); i++)
+            ep_outstanding[i].store(0, std::memory_order_relaxed);
+    }
+
+    credits_known.store(false, std::memory_order_release);
+    hello_answered = false;
+    hello_ts = {};
+}
+
+/**
+ * @brief Picks the endpoint for sending the buffers: the one with the fewest
+ * sends in flight, starting the search from the next endpoint in round-robin
+ * order to break ties. A rail completes sends at the rate of its link, so
+ * frames are striped across the rails in proportion to their bandwidth.
+ *
+ * @return The index of the endpoint.
+ */
+uint32_t RdmaTx::pick_endpoint(void **reg_bufs, uint32_t count)
+{
+    uint32_t num_eps = static_cast<uint32_t>(ep_ctxs.size());
+    uint32_t start = next_tx_idx.fetch_add(1, std::memory_order_relaxed) % num_eps;
+    uint32_t best = start;
+
+    if (ep_outstanding) {
+        uint32_t best_load = ep_outstanding[best].load(std::memory_order_relaxed);
+
+        for (uint32_t k = 1; k < num_eps && best_load; k++) {
+            uint32_t i = (start + k) % num_eps;
+            uint32_t load = ep_outstanding[i].load(std::memory_order_relaxed);
+            if (load < best_load) {
+                best = i;
+                best_load = load;
+            }
+        }
+
+        ep_outstanding[best].fetch_add(count, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; i++)
+            send_ep[slot_of(reg_bufs[i])].store(best, std::memory_order_relaxed);
     }
-    log::info("RDMA TX CQ thread stopped.")("kind", kind2str(_kind));
+
+    return best;
+}
+
+/**
+ * Account for the completion of the send of the buffer on its endpoint.
+ * The context of a chunk of a segmented write points past the buffer
+ * start by the chunk number, which gives the endpoint of the chunk.
+ */
+void RdmaTx::endpoint_release(void *reg_buf)
+{
+    if (!ep_outstanding || !buffer_block)
+        return;
+
+    size_t slot = slot_of(reg_buf);
+    if (slot >= (size_t)queue_size)
+        return;
+
+    size_t chunk = (char *)reg_buf - ((char *)buffer_block + slot * send_slot_size);
+    auto ep = (send_ep[slot].load(std::memory_order_relaxed) + chunk) % ep_ctxs.size();
+    ep_outstanding[ep].fetch_sub(1, std::memory_order_relaxed);
+}
+
+/**
+ * Record the time from posting the send of the buffer to its completion.
+ */
+void RdmaTx::on_send_completion(void *buf)
+{
+    if (!send_ts || !buffer_block)
+        return;
+
+    size_t slot = slot_of(buf);
+    if (slot >= (size_t)queue_size)
+        return;
+
+    auto ts = send_ts[slot].load(std::memory_order_relaxed);
+    if (ts)
+        send_ns.record(telemetry::now_ns() - ts);
 }
 
+void RdmaTx::collect(telemetry::Metric& metric, const int64_t& timestamp_ms)
+{
+    Rdma::collect(metric, timestamp_ms);
+    send_ns.export_fields(metric, "sendlat");
+    metric.addFieldUint64("rdinject", injected.load(std::memory_order_relaxed));
+
+    if (flow_control != RDMA_FLOW_NONE)
+        metric.addFieldUint64("rdfcdrop", flow_dropped.load(std::memory_order_relaxed));
+}
 
 /**
  * @brief Handles sending data through RDMA by consuming a buffer, copying data, and transmitting it.
@@ -147,6 +392,9 @@ void RdmaTx::rdma_cq_thread(context::Context& ctx)
  * This function attempts to consume a pre-allocated buffer from the queue within a specified timeout,
  * copies the provided data into the buffer, and sends it through the RDMA endpoint. It ensures proper
  * error handling, retries for buffer availability, and buffer management in case of transmission failure.
+ * Only the used part of the buffer is sent, followed by the trailer. With the
+ * write transport, the used part is written to the next slot of the receiver
+ * ring, preceded by its length.
  * 
  * @param ctx The context for managing the operation.
  * @param ptr Pointer to the data to be transmitted.
@@ -157,79 +405,1315 @@ void RdmaTx::rdma_cq_thread(context::Context& ctx)
 Result RdmaTx::on_receive(context::Context& ctx, void *ptr, uint32_t sz, uint32_t& sent)
 {
     void *reg_buf = nullptr;
-    constexpr uint32_t TIMEOUT_US         = 1000000; // 1-second timeout
-    constexpr uint32_t RETRY_INTERVAL_US = 100;     // 100 µs
-    uint32_t elapsed = 0;
 
-    // 1) Acquire a buffer from our pool, with timeout
-    while (elapsed < TIMEOUT_US && !ctx.cancelled()) {
-        Result r = consume_from_queue(ctx, &reg_buf);
-        if (r == Result::success) {
-            if (reg_buf) break;
-            log::debug("RDMA tx buffer is null, retrying...")("kind", kind2str(_kind));
-        }
-        else if (r != Result::error_no_buffer) {
-            log::error("RDMA tx failed to consume buffer from queue")
-                ("result", static_cast<int>(r))("kind", kind2str(_kind));
-            sent = 0;
+    if (flow_control != RDMA_FLOW_NONE) {
+        bool handled;
+        Result r = flow_admit(ctx, ptr, sz, sent, handled);
+        if (handled)
             return r;
-        }
-        std::this_thread::sleep_for(std::chrono::microseconds(RETRY_INTERVAL_US));
-        elapsed += RETRY_INTERVAL_US;
     }
 
-    if (!reg_buf) {
-        log::error("RDMA tx failed to consume buffer within timeout")
-            ("timeout_us", TIMEOUT_US)("kind", kind2str(_kind));
+    // Small frames are injected
+    if (inject_max) {
+        uint32_t to_send = used_size(ptr, sz);
+        if (to_send + TRAILER <= inject_max)
+            return send_inject(ctx, ptr, to_send, sent);
+    }
+
+    // 1) Acquire a buffer from our pool, with timeout
+    Result r = acquire_buffer(ctx, &reg_buf);
+    if (r != Result::success) {
         sent = 0;
-        return Result::error_timeout;
+        return r;
     }
 
-    // 2) Copy payload and pad to trx_sz
-    char* data_ptr = reinterpret_cast<char*>(reg_buf);
-    uint32_t to_send = std::min<uint32_t>(trx_sz, sz);
-    std::memcpy(data_ptr, ptr, to_send);
-    if (to_send < trx_sz)                       // pad any unused space
-        std::memset(data_ptr + to_send, 0, trx_sz - to_send);
+    // 2) Copy the used part of the payload, write trailer
+    uint32_t to_send = rma_write ? fill_slot(reg_buf, ptr, sz) :
+                       fill_buffer(reg_buf, ptr, sz,
+                                   tx_seq.fetch_add(1, std::memory_order_relaxed));
+
+    return send_buffer(ctx, reg_buf, to_send, sent);
+}
 
-    // ---- write trailer at fixed offset ----
-    uint64_t seq = global_seq.fetch_add(1, std::memory_order_relaxed);
-    *reinterpret_cast<uint64_t*>(data_ptr + trx_sz) = seq;
+/**
+ * @brief Sends the filled registered buffer: the used part of the payload
+ * followed by the trailer, or preceded by its length with the write
+ * transport. On error, or while the link is reconnecting, the buffer is
+ * returned to the queue.
+ */
+Result RdmaTx::send_buffer(context::Context& ctx, void *reg_buf, uint32_t to_send,
+                           uint32_t& sent)
+{
+    // Send the payload + trailer, the receiver learns the length from the CQ
+    uint32_t total_len = to_send + static_cast<uint32_t>(TRAILER);
+
+    sent = 0;
 
-    // Always send full payload-slot + trailer
-    uint32_t total_len = trx_sz + static_cast<uint32_t>(TRAILER);
+    if (!ep_enter()) {
+        link_drop(&reg_buf, 1);
+        return Result::success;
+    }
 
-    uint32_t idx = next_tx_idx.fetch_add(1, std::memory_order_relaxed)
-                   % static_cast<uint32_t>(ep_ctxs.size());
+    uint32_t idx = pick_endpoint(&reg_buf, 1);
     ep_ctx_t* chosen = ep_ctxs[idx];
     if (!chosen) {
         log::error("RDMA tx endpoint #%u is null, cannot send")("idx", idx);
-        sent = 0;
+        endpoint_release(reg_buf);
         add_to_queue(reg_buf);
+        ep_exit();
         return Result::error_general_failure;
     }
 
-    int rc = libfabric_ep_ops.ep_send_buf(chosen, reg_buf, total_len);
+    stamp_send(reg_buf);
+    mark_posted(reg_buf);
+
+    int rc = rma_write ? write_slot(ctx, idx, reg_buf, total_len) :
+             libfabric_ep_ops.ep_send_buf(chosen, reg_buf, total_len);
+    if (rc)
+        mark_posted(reg_buf, false);
+    ep_exit();
     // Signal that there’s now room for more sends
     notify_buf_available();
-    sent = to_send;
-
 
     if (rc) {
         log::error("Failed to send buffer through RDMA tx")
             ("error", fi_strerror(-rc))("kind", kind2str(_kind));
         // Return buffer to pool
+        endpoint_release(reg_buf);
         Result qr = add_to_queue(reg_buf);
         if (qr != Result::success) {
             log::error("Failed to return buffer to queue after send error")
                 ("error", result2str(qr))("kind", kind2str(_kind));
         }
-        sent = 0;
         return Result::error_general_failure;
     }
 
+    credits_take(1);
+    sent = to_send;
+    return Result::success;
+}
+
+/**
+ * @brief Sends a burst of buffers through RDMA with a single doorbell.
+ *
+ * Acquires a registered buffer for every frame of the burst, copies the
+ * frames and posts all sends to one endpoint at once. Frames that do not
+ * get a buffer in time are dropped.
+ *
+ * @param ctx The context for managing the operation.
+ * @param bufs Buffer handles of the frames to be transmitted.
+ * @param count Number of frames in the burst.
+ * @param sent Output parameter indicating the total number of bytes sent.
+ * @return Result::success if all frames were sent, or an appropriate error result.
+ */
+Result RdmaTx::on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                                uint32_t count, uint32_t& sent)
+{
+    void *reg_bufs[burst_max];
+    uint32_t sizes[burst_max];
+    size_t send_sizes[burst_max];
+    uint32_t num = 0;
+    Result res = Result::success;
+
+    // Buffers that can be sent without copying are sent one by one, and so
+    // are the frames written to the receiver ring. So are the frames of a
+    // tight latency budget, since a burst holds its first frame until the
+    // last one is copied.
+    if (zero_copy || rma_write || latency_tight)
+        return Connection::on_receive_burst(ctx, bufs, count, sent);
+
+    // Without enough credits, or behind a backlog, the flow control policy
+    // is applied frame by frame
+    if (flow_control != RDMA_FLOW_NONE &&
+        (credits_available() < std::min(count, burst_max) ||
+         backlog_len.load(std::memory_order_acquire)))
+        return Connection::on_receive_burst(ctx, bufs, count, sent);
+
+    sent = 0;
+    count = std::min(count, burst_max);
+
+    // 1) Acquire buffers and fill them. Small frames are injected at once.
+    for (uint32_t i = 0; i < count; i++) {
+        void *reg_buf = nullptr;
+
+        if (inject_max) {
+            uint32_t to_send = used_size(bufs[i]->data, bufs[i]->size);
+            if (to_send + TRAILER <= inject_max) {
+                uint32_t injected_sz = 0;
+                res = send_inject(ctx, bufs[i]->data, to_send, injected_sz);
+                if (res != Result::success)
+                    break;
+                sent += injected_sz;
+                continue;
+            }
+        }
+
+        res = acquire_buffer(ctx, &reg_buf);
+        if (res != Result::success)
+            break;
+
+        sizes[num] = fill_buffer(reg_buf, bufs[i]->data, bufs[i]->size,
+                                 tx_seq.fetch_add(1, std::memory_order_relaxed));
+        send_sizes[num] = sizes[num] + TRAILER;
+        reg_bufs[num++] = reg_buf;
+    }
+
+    if (!num)
+        return res;
+
+    if (!ep_enter()) {
+        link_drop(reg_bufs, num);
+        return res;
+    }
+
+    uint32_t idx = pick_endpoint(reg_bufs, num);
+    ep_ctx_t* chosen = ep_ctxs[idx];
+    if (!chosen) {
+        log::error("RDMA tx endpoint #%u is null, cannot send")("idx", idx);
+        for (uint32_t i = 0; i < num; i++) {
+            endpoint_release(reg_bufs[i]);
+            add_to_queue(reg_bufs[i]);
+        }
+        ep_exit();
+        return Result::error_general_failure;
+    }
+
+    for (uint32_t i = 0; i < num; i++) {
+        stamp_send(reg_bufs[i]);
+        mark_posted(reg_bufs[i]);
+    }
+
+    // 2) Post all sends at once
+    int rc = libfabric_ep_ops.ep_send_burst(chosen, reg_bufs, send_sizes, num);
+    uint32_t posted = rc > 0 ? rc : 0;
+    for (uint32_t i = posted; i < num; i++)
+        mark_posted(reg_bufs[i], false);
+    ep_exit();
+    notify_buf_available();
+
+    for (uint32_t i = 0; i < posted; i++)
+        sent += sizes[i];
+
+    credits_take(posted);
+
+    if (posted < num) {
+        log::error("Failed to send buffers through RDMA tx")
+            ("error", fi_strerror(rc < 0 ? -rc : EIO))
+            ("posted", posted)("count", num)("kind", kind2str(_kind));
+
+        // Return unsent buffers to pool
+        for (uint32_t i = posted; i < num; i++) {
+            endpoint_release(reg_bufs[i]);
+            add_to_queue(reg_bufs[i]);
+        }
+
+        return Result::error_general_failure;
+    }
+
+    return res;
+}
+
+/**
+ * @brief Sends a small frame without a registered buffer. The used part of
+ * the payload is copied to the stack followed by the trailer, or preceded by
+ * its length with the write transport, and injected. No local completion is
+ * generated, so the frame never waits for a buffer and costs the CQ poller
+ * nothing.
+ */
+Result RdmaTx::send_inject(context::Context& ctx, void *ptr, uint32_t to_send, uint32_t& sent)
+{
+    alignas(8) char msg[RDMA_INJECT_MAX];
+    uint32_t total_len = to_send + static_cast<uint32_t>(TRAILER);
+
+    sent = 0;
+
+    if (!ep_enter()) {
+        link_drop(nullptr, 1);
+        return Result::success;
+    }
+
+    uint32_t idx = next_tx_idx.fetch_add(1, std::memory_order_relaxed) % ep_ctxs.size();
+    ep_ctx_t* chosen = ep_ctxs[idx];
+    if (!chosen) {
+        log::error("RDMA tx endpoint #%u is null, cannot send")("idx", idx);
+        ep_exit();
+        return Result::error_general_failure;
+    }
+
+    int rc;
+
+    if (rma_write) {
+        uint64_t len = to_send;
+        std::memcpy(msg, &len, sizeof(len));
+        std::memcpy(msg + TRAILER, ptr, to_send);
+
+        struct iovec iov = { .iov_base = msg, .iov_len = total_len };
+        rc = write_slotv(ctx, idx, &iov, 1, nullptr, nullptr);
+    } else {
+        uint64_t seq = tx_seq.fetch_add(1, std::memory_order_relaxed);
+        std::memcpy(msg, ptr, to_send);
+        std::memcpy(msg + to_send, &seq, sizeof(seq));
+
+        rc = libfabric_ep_ops.ep_inject(chosen, msg, total_len);
+    }
+    ep_exit();
+
+    if (rc) {
+        log::error("Failed to inject buffer through RDMA tx")
+            ("error", fi_strerror(-rc))("kind", kind2str(_kind));
+        return Result::error_general_failure;
+    }
+
+    injected.fetch_add(1, std::memory_order_relaxed);
+    credits_take(1);
+    sent = to_send;
+    return Result::success;
+}
+
+/**
+ * @brief Acquires a registered buffer when called by the progress worker
+ * serving the connection, e.g. when a frame received on another connection
+ * of the worker is forwarded. The worker polls the completions inline,
+ * since nobody else returns the buffers while it waits.
+ */
+Result RdmaTx::acquire_buffer_inline(context::Context& ctx, void **reg_buf,
+                                     std::chrono::nanoseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    for (;;) {
+        Result r = consume_from_queue(ctx, reg_buf);
+        if (r != Result::error_no_buffer)
+            return r;
+
+        if (poll_inline(rdma_cq_thread_ctx) < 0 ||
+            std::chrono::steady_clock::now() >= deadline)
+            return Result::error_timeout;
+    }
+}
+
+/**
+ * @brief Acquires a registered buffer from the queue, waiting up to 1 second.
+ *
+ * Blocks in the buffer queue, so the caller is woken up as soon as a send
+ * completion returns a buffer, rather than polling.
+ */
+Result RdmaTx::acquire_buffer(context::Context& ctx, void **reg_buf)
+{
+    constexpr uint32_t TIMEOUT_US = 1000000; // 1-second timeout
+
+    Result r = progress_inline() ?
+               acquire_buffer_inline(ctx, reg_buf, std::chrono::microseconds(TIMEOUT_US)) :
+               consume_from_queue(ctx, reg_buf, std::chrono::microseconds(TIMEOUT_US));
+    if (r == Result::error_timeout) {
+        log::error("RDMA tx failed to consume buffer within timeout")
+            ("timeout_us", TIMEOUT_US)("kind", kind2str(_kind));
+        return r;
+    }
+    if (r != Result::success) {
+        log::error("RDMA tx failed to consume buffer from queue")
+            ("result", static_cast<int>(r))("kind", kind2str(_kind));
+        return r;
+    }
+
     return Result::success;
 }
 
+/**
+ * @brief Copies the used part of the payload to the registered buffer and
+ * writes the sequence number trailer right after it. Returns the number of
+ * payload bytes.
+ */
+uint32_t RdmaTx::fill_buffer(void *reg_buf, void *ptr, uint32_t sz, uint64_t seq)
+{
+    char* data_ptr = reinterpret_cast<char*>(reg_buf);
+    uint32_t to_send = used_size(ptr, sz);
+    std::memcpy(data_ptr, ptr, to_send);
+
+    // ---- write trailer after the payload ----
+    std::memcpy(data_ptr + to_send, &seq, sizeof(seq));
+
+    return to_send;
+}
+
+/**
+ * @brief Writes the length of the used part of the payload to the registered
+ * buffer, followed by the used part itself, as laid out in a slot of the
+ * receiver ring. Returns the number of payload bytes.
+ */
+uint32_t RdmaTx::fill_slot(void *reg_buf, void *ptr, uint32_t sz)
+{
+    char* data_ptr = reinterpret_cast<char*>(reg_buf);
+    uint32_t to_send = used_size(ptr, sz);
+    uint64_t len = to_send;
+
+    std::memcpy(data_ptr, &len, sizeof(len));
+    std::memcpy(data_ptr + TRAILER, ptr, to_send);
+
+    return to_send;
+}
+
+/**
+ * Return the number of leading bytes of the buffer to be sent. The unused
+ * tails of the payload and metadata partitions are not sent.
+ */
+uint32_t RdmaTx::used_size(const void *ptr, uint32_t sz) const
+{
+    auto used = config.buf_parts.used_size(ptr, sz);
+    return std::min<size_t>(used, trx_sz);
+}
+
+void RdmaTx::stamp_send(void *reg_buf)
+{
+    if (!send_ts)
+        return;
+
+    send_ts[slot_of(reg_buf)].store(telemetry::now_ns(), std::memory_order_relaxed);
+}
+
+size_t RdmaTx::slot_of(void *reg_buf) const
+{
+    return ((char *)reg_buf - (char *)buffer_block) / send_slot_size;
+}
+
+/**
+ * @brief Sends the buffer handle through RDMA, without copying if possible.
+ *
+ * In the zero-copy mode, a buffer pointing into a published shared memory
+ * region, e.g. a memif ingress slot, is sent straight from the region.
+ * The handle is retained until the send completes, which keeps the slot
+ * out of the memif ring. Other buffers are copied.
+ */
+Result RdmaTx::on_receive(context::Context& ctx, BufferHandle *buf, uint32_t& sent)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    // Small frames are injected rather than sent from the region
+    if (buf->size + TRAILER <= inject_max)
+        return on_receive(ctx, buf->data, buf->size, sent);
+
+    void *descs_by_rail[RDMA_MAX_EPS];
+    bool registered;
+
+    if (zero_copy && buf->size && buf->size <= trx_sz &&
+        zero_copy_find(buf->data, buf->size, descs_by_rail, registered)) {
+        if (flow_control != RDMA_FLOW_NONE) {
+            bool handled;
+            Result r = flow_admit(ctx, buf->data, buf->size, sent, handled);
+            if (handled)
+                return r;
+        }
+        return send_zero_copy(ctx, buf, descs_by_rail, registered, sent);
+    }
+
+    return on_receive(ctx, buf->data, buf->size, sent);
+}
+
+Result RdmaTx::send_zero_copy(context::Context& ctx, BufferHandle *buf,
+                              void **descs_by_rail, bool registered, uint32_t& sent)
+{
+    sent = 0;
+
+    if (!registered && (m_dev_handle->info->domain_attr->mr_mode & FI_MR_LOCAL))
+        return on_receive(ctx, buf->data, buf->size, sent);
+
+    // 1) Acquire a registered buffer for the trailer
+    void *reg_buf = nullptr;
+
+    Result r = acquire_buffer(ctx, &reg_buf);
+    if (r != Result::success)
+        return r;
+
+    if (!ep_enter()) {
+        link_drop(&reg_buf, 1);
+        return Result::success;
+    }
+
+    uint32_t to_send = used_size(buf->data, buf->size);
+    *reinterpret_cast<uint64_t *>(reg_buf) = rma_write ? to_send :
+        tx_seq.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t idx = pick_endpoint(&reg_buf, 1);
+    ep_ctx_t* chosen = ep_ctxs[idx];
+    if (!chosen) {
+        log::error("RDMA tx endpoint #%u is null, cannot send")("idx", idx);
+        endpoint_release(reg_buf);
+        add_to_queue(reg_buf);
+        ep_exit();
+        return Result::error_general_failure;
+    }
+
+    // 2) Gather the used part of the payload from the region, and the trailer.
+    // A frame written to the receiver ring is preceded by its length instead.
+    // The region is registered with the domain of every rail.
+    struct iovec iov[2] = {
+        { .iov_base = buf->data, .iov_len = to_send },
+        { .iov_base = reg_buf, .iov_len = TRAILER },
+    };
+    void *descs[2] = { descs_by_rail[rail_of(idx)], chosen->data_desc };
+
+    if (rma_write) {
+        std::swap(iov[0], iov[1]);
+        std::swap(descs[0], descs[1]);
+    }
+
+    buf->retain();
+    zc_handles[slot_of(reg_buf)].store(buf, std::memory_order_release);
+
+    stamp_send(reg_buf);
+    mark_posted(reg_buf);
+
+    int rc = rma_write ? write_slotv(ctx, idx, iov, 2, reg_buf, descs_by_rail) :
+             libfabric_ep_ops.ep_sendv(chosen, iov, descs, 2, reg_buf);
+    if (rc)
+        mark_posted(reg_buf, false);
+    ep_exit();
+    notify_buf_available();
+
+    if (rc) {
+        log::error("Failed to send buffer through RDMA tx")
+            ("error", fi_strerror(-rc))("kind", kind2str(_kind));
+        endpoint_release(reg_buf);
+        zero_copy_release(reg_buf);
+        add_to_queue(reg_buf);
+        return Result::error_general_failure;
+    }
+
+    credits_take(1);
+    sent = to_send;
+    return Result::success;
+}
+
+/**
+ * Look up the registered region containing the buffer, and get its
+ * descriptors indexed by rail. Returns false if the buffer is outside
+ * the regions.
+ */
+bool RdmaTx::zero_copy_find(const void *ptr, size_t sz, void **descs, bool& registered)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    bool found = false;
+
+    auto regions = static_cast<ZeroCopyRegions *>(zc_regions.load_next_lock());
+    if (regions) {
+        for (auto& r : *regions) {
+            if (r.region.contains(ptr, sz)) {
+                std::copy(std::begin(r.desc), std::end(r.desc), descs);
+                registered = r.mr[0] != nullptr;
+                found = true;
+                break;
+            }
+        }
+    }
+    zc_regions.unlock();
+
+    return found;
+}
+
+/**
+ * Publish a new snapshot of the registered regions to the data plane.
+ * Must be called with zc_mx locked.
+ */
+void RdmaTx::zero_copy_publish(ZeroCopyRegions *regions)
+{
+    auto prev = static_cast<ZeroCopyRegions *>(zc_regions.store(regions));
+    if (prev)
+        zc_regions.retire([prev]() { delete prev; });
+}
+
+/**
+ * Register a region added to the registry with the domain of every rail.
+ * A failed registration is kept, so the buffers of the region are copied
+ * without retrying on every buffer.
+ */
+void RdmaTx::on_region_add(const MemoryRegion& region)
+{
+    ZeroCopyRegion r = { .region = region, .mr = {}, .desc = {} };
+
+    for (size_t rail = 0; rail < rails.size(); rail++) {
+        auto dev = rails[rail].dev;
+
+        // Regions are registered with the domain, not bound to an endpoint
+        int rc = libfabric_mr_ops.rdma_reg_mr(dev, nullptr, region.addr, region.size,
+                                              libfabric_mr_ops.rdma_info_to_mr_access(dev->info),
+                                              (uint64_t)this + region.id,
+                                              FI_HMEM_SYSTEM, 0, &r.mr[rail], &r.desc[rail]);
+        if (rc) {
+            log::error("RDMA tx zero-copy region registration failed")
+                ("error", fi_strerror(-rc))("size", region.size)("rail", rail)
+                ("kind", kind2str(_kind));
+            zero_copy_unreg(r);
+            break;
+        }
+    }
+
+    if (r.mr[0])
+        log::debug("RDMA tx zero-copy region registered")("size", region.size)
+                  ("rails", rails.size())("kind", kind2str(_kind));
+
+    std::lock_guard<std::mutex> lk(zc_mx);
+
+    auto prev = static_cast<ZeroCopyRegions *>(zc_regions.load());
+    auto regions = prev ? new ZeroCopyRegions(*prev) : new ZeroCopyRegions();
+    regions->push_back(r);
+    zero_copy_publish(regions);
+}
+
+/**
+ * Close the registration of a region removed from the registry. No buffer
+ * handle points into the region anymore, so no send uses the registration,
+ * and the data plane never matches the region in an older snapshot.
+ */
+void RdmaTx::on_region_remove(const MemoryRegion& region)
+{
+    std::lock_guard<std::mutex> lk(zc_mx);
+
+    auto prev = static_cast<ZeroCopyRegions *>(zc_regions.load());
+    if (!prev)
+        return;
+
+    auto regions = new ZeroCopyRegions();
+    ZeroCopyRegion removed = {};
+
+    for (auto& r : *prev) {
+        if (r.region.id == region.id)
+            removed = r;
+        else
+            regions->push_back(r);
+    }
+
+    zero_copy_publish(regions);
+
+    if (removed.region.id)
+        zero_copy_unreg(removed);
+}
+
+void RdmaTx::zero_copy_unreg(ZeroCopyRegion& r)
+{
+    for (size_t rail = 0; rail < std::size(r.mr); rail++) {
+        if (r.mr[rail])
+            libfabric_mr_ops.rdma_unreg_mr(r.mr[rail]);
+        r.mr[rail] = nullptr;
+        r.desc[rail] = nullptr;
+    }
+
+    // The region is not ours, so its registration must not outlive our use
+    for (auto& rail : rails)
+        libfabric_mr_ops.rdma_mr_cache_invalidate(rail.dev, r.region.addr, r.region.size);
+}
+
+/**
+ * Release the ingress buffer handle sent from the registered buffer slot.
+ */
+void RdmaTx::zero_copy_release(void *reg_buf)
+{
+    if (!zc_handles)
+        return;
+
+    size_t slot = slot_of(reg_buf);
+    if (slot >= (size_t)queue_size)
+        return;
+
+    auto buf = zc_handles[slot].exchange(nullptr, std::memory_order_acq_rel);
+    if (buf)
+        buf->release();
+}
+
+/**
+ * Stop registering the regions added, release the ingress buffers of sends
+ * that will never complete, and close the registrations of all regions.
+ */
+void RdmaTx::zero_copy_cleanup()
+{
+    if (zc_subscribed) {
+        MemoryRegions::unsubscribe(this);
+        zc_subscribed = false;
+    }
+
+    if (zc_handles) {
+        for (int i = 0; i < queue_size; i++) {
+            auto buf = zc_handles[i].exchange(nullptr, std::memory_order_acq_rel);
+            if (buf)
+                buf->release();
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(zc_mx);
+
+    auto regions = static_cast<ZeroCopyRegions *>(zc_regions.load());
+    if (!regions)
+        return;
+
+    zc_regions.store_wait(nullptr);
+
+    for (auto& r : *regions)
+        zero_copy_unreg(r);
+
+    delete regions;
+}
+
+/**
+ * The registrations of the regions are closed with the domains of the
+ * rails still open, after the endpoints sending from them are destroyed.
+ */
+void RdmaTx::on_cleanup()
+{
+    zero_copy_cleanup();
+}
+
+/**
+ * @brief Handles the completion queue of the write transport in a dedicated
+ * thread.
+ *
+ * Polls continuously, because the credits returned by the receiver arrive
+ * while the data plane waits for a free slot. Until the receiver describes
+ * its ring, a hello message is sent every 100 ms.
+ *
+ * @param ctx The context for managing thread cancellation and stop requests.
+ */
+void RdmaTx::write_cq_thread(context::Context& ctx)
+{
+    int idle_cycles = 0;
+
+    while (!ctx.cancelled()) {
+        int ret = write_poll_cq(ctx);
+        if (ret < 0)
+            break;
+
+        cq_idle(ret > 0, idle_cycles);
+    }
+
+    stop_endpoints();
+    log::info("RDMA TX CQ thread stopped.")("kind", kind2str(_kind));
+}
+
+/**
+ * @brief Makes one non-blocking pass over the completion queue of the write
+ * transport. Sends the hello message until the receiver ring is known.
+ *
+ * @return The number of completions handled, or -1 on a fatal CQ read error.
+ */
+int RdmaTx::write_poll_cq(context::Context& ctx, bool drain)
+{
+    struct fi_cq_data_entry cq_entries[CQ_BATCH_SIZE];
+
+    int work = 0;
+    bool credited = false;
+
+    hello_poll();
+
+    // Poll the CQ of every rail once. Control messages arrive on the first one.
+    for (auto *ep : cq_eps) {
+        struct fid_cq *cq = ep->cq_ctx.cq;
+
+        int ret = fi_cq_read(cq, cq_entries, CQ_BATCH_SIZE);
+        if (ret > 0) {
+            for (int i = 0; i < ret; ++i) {
+                void *buf = cq_entries[i].op_context;
+                if (!buf)
+                    continue;
+
+                if (is_ctrl(buf)) {
+                    if (cq_entries[i].flags & FI_RECV) {
+                        auto msg = static_cast<WriteCtrl *>(buf);
+                        write_on_ctrl(msg);
+                        credited = true;
+
+                        int err = ctrl_post_recv(msg);
+                        if (err)
+                            log::error("RDMA tx failed to repost control message receive")
+                                ("error", fi_strerror(-err))("kind", kind2str(_kind));
+                    } else {
+                        ctrl_on_send_completion();
+                    }
+                    continue;
+                }
+
+                endpoint_release(buf);
+                buf = write_complete(buf);
+                if (buf)
+                    write_release(buf);
+            }
+            work += ret;
+        }
+        else if (ret == -FI_EAVAIL) {
+            fi_cq_err_entry err {};
+            if (fi_cq_readerr(cq, &err, 0) >= 0) {
+                if (err.err != FI_ECANCELED)
+                    log::error("RDMA tx CQ error")("error", fi_strerror(err.err))
+                        ("kind", kind2str(_kind));
+
+                if (is_ctrl(err.op_context)) {
+                    if (err.flags & FI_SEND)
+                        ctrl_on_send_completion();
+                } else if (err.op_context) {
+                    endpoint_release(err.op_context);
+                    void *buf = write_complete(err.op_context, true);
+                    if (buf) {
+                        zero_copy_release(buf);
+                        add_to_queue(buf); // reclaim the failed buffer
+                    }
+                }
+            } else {
+                log::error("RDMA tx failed to read CQ error entry")
+                    ("kind", kind2str(_kind));
+            }
+            work++;
+        }
+        else if (ret != -FI_EAGAIN) {
+            log::error("RDMA tx cq read failed")
+                ("error", fi_strerror(-ret))("kind", kind2str(_kind));
+            return -1;
+        }
+    }
+
+    if (credited && drain)
+        flow_drain(ctx);
+
+    return work;
+}
+
+/**
+ * @brief Makes one pass for the progress engine.
+ */
+int RdmaTx::poll(context::Context& ctx)
+{
+    return rma_write ? write_poll_cq(ctx) : poll_cq(ctx);
+}
+
+int RdmaTx::poll_inline(context::Context& ctx)
+{
+    return rma_write ? write_poll_cq(ctx, false) : poll_cq(ctx, false);
+}
+
+/**
+ * @brief Sends the hello message with the address of the first endpoint
+ * every 100 ms, until the receiver answers with the ring description or
+ * with credits. The receiver can't tell the transmitter address from the
+ * frames, since it isn't in its address vector.
+ */
+void RdmaTx::hello_poll()
+{
+    constexpr auto HELLO_INTERVAL = std::chrono::milliseconds(100);
+
+    if (hello_answered || !ctrl_block)
+        return;
+
+    // With the send transport, the hello lands in a frame buffer
+    if (!rma_write && sizeof(WriteCtrl) > trx_sz + TRAILER) {
+        log::warn("RDMA tx frames too small for the hello message, no flow control")
+                 ("size", trx_sz)("kind", kind2str(_kind));
+        hello_answered = true;
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - hello_ts < HELLO_INTERVAL)
+        return;
+    hello_ts = now;
+
+    WriteCtrl msg = {};
+    size_t len = sizeof(msg.src);
+
+    int err = libfabric_ep_ops.ep_getname(ep_ctxs[0], msg.src, &len);
+    if (err) {
+        log::error("RDMA tx failed to get the endpoint address")
+            ("error", fi_strerror(-err))("kind", kind2str(_kind));
+        return;
+    }
+    msg.src_len = len;
+
+    ctrl_send(WriteCtrlType::hello, msg);
+}
+
+/**
+ * @brief Takes the ring description and the credits sent by the receiver.
+ * With the send transport, the frames sent before the first grant are
+ * rebased on the frames the receiver reports, since the frames sent before
+ * it posted receives never took a credit.
+ */
+void RdmaTx::write_on_ctrl(WriteCtrl *msg)
+{
+    if (msg->magic != WRITE_CTRL_MAGIC) {
+        log::warn("RDMA tx bad control message")("kind", kind2str(_kind));
+        return;
+    }
+
+    switch (msg->type) {
+    case WriteCtrlType::ring:
+        hello_answered = true;
+        if (ring_ready.load(std::memory_order_relaxed))
+            break;
+
+        if (!msg->slots || msg->slot_size < trx_sz + TRAILER) {
+            log::error("RDMA tx receiver ring too small")("slots", msg->slots)
+                      ("slot_size", msg->slot_size)("kind", kind2str(_kind));
+            break;
+        }
+
+        ring.addr = msg->addr;
+        ring.slots = msg->slots;
+        ring.slot_size = msg->slot_size;
+        std::memcpy(ring.keys, msg->keys, sizeof(ring.keys));
+
+        write_credits.store(msg->credits, std::memory_order_relaxed);
+        ring_ready.store(true, std::memory_order_release);
+
+        log::info("RDMA tx write ring ready")("slots", ring.slots)
+                 ("slot_size", ring.slot_size)("kind", kind2str(_kind));
+        break;
+
+    case WriteCtrlType::credits:
+        if (!rma_write) {
+            hello_answered = true;
+            if (!credits_known.load(std::memory_order_relaxed)) {
+                credits_used.store(msg->received, std::memory_order_relaxed);
+                credits_granted.store(msg->credits, std::memory_order_relaxed);
+                credits_known.store(true, std::memory_order_release);
+
+                log::info("RDMA tx credits granted by the receiver")
+                         ("credits", msg->credits - msg->received)("kind", kind2str(_kind));
+            } else if (msg->credits > credits_granted.load(std::memory_order_relaxed)) {
+                credits_granted.store(msg->credits, std::memory_order_release);
+            }
+            break;
+        }
+
+        if (msg->credits > write_credits.load(std::memory_order_relaxed))
+            write_credits.store(msg->credits, std::memory_order_release);
+        break;
+
+    default:
+        log::warn("RDMA tx unexpected control message")
+            ("type", static_cast<uint32_t>(msg->type))("kind", kind2str(_kind));
+        break;
+    }
+}
+
+int RdmaTx::write_slot(context::Context& ctx, uint32_t idx, void *reg_buf, uint32_t len)
+{
+    struct iovec iov = { .iov_base = reg_buf, .iov_len = len };
+
+    return write_slotv(ctx, idx, &iov, 1, reg_buf, nullptr);
+}
+
+/**
+ * @brief Writes the frame gathered from the buffers to the next slot of the
+ * receiver ring, with the slot index as immediate data. Waits up to 1 second
+ * for the receiver to return a slot. Slots are taken and written under a
+ * lock, so a failed write never leaves a gap in the ring.
+ *
+ * Buffers outside the registered buffer block are described by the
+ * region descriptors, indexed by rail. A frame without a registered buffer
+ * is a single small buffer, and is injected.
+ */
+int RdmaTx::write_slotv(context::Context& ctx, uint32_t idx, const struct iovec *iov,
+                        size_t count, void *reg_buf, void **region_descs)
+{
+    constexpr uint32_t TIMEOUT_US        = 1000000; // 1-second timeout
+    constexpr uint32_t RETRY_INTERVAL_US = 100;     // 100 µs
+    uint32_t elapsed = 0;
+    bool inline_poll = progress_inline();
+
+    std::lock_guard<std::mutex> lk(write_mx);
+
+    while (!ring_ready.load(std::memory_order_acquire) ||
+           write_head >= write_credits.load(std::memory_order_acquire) + ring.slots) {
+        if (ctx.cancelled())
+            return -ECANCELED;
+
+        if (elapsed >= TIMEOUT_US) {
+            log::error("RDMA tx no free slot in receiver ring within timeout")
+                ("timeout_us", TIMEOUT_US)("ring_ready", ring_ready.load())
+                ("kind", kind2str(_kind));
+            return -ETIMEDOUT;
+        }
+
+        // Credits arrive on the completion queue, which the progress
+        // worker can't poll while it waits here.
+        if (inline_poll)
+            poll_inline(rdma_cq_thread_ctx);
+
+        std::this_thread::sleep_for(std::chrono::microseconds(RETRY_INTERVAL_US));
+        elapsed += RETRY_INTERVAL_US;
+    }
+
+    uint32_t slot = write_head % ring.slots;
+    uint64_t addr = ring.addr + (uint64_t)slot * ring.slot_size;
+
+    int rc = reg_buf ?
+             write_segments(idx, iov, count, reg_buf, region_descs, slot, addr) :
+             libfabric_ep_ops.ep_inject_writedata(ep_ctxs[idx], iov->iov_base, iov->iov_len,
+                                                  slot, addr, ring.keys[idx]);
+    if (!rc)
+        write_head++;
+
+    return rc;
+}
+
+/**
+ * @brief Writes the frame to the slot of the receiver ring at addr.
+ *
+ * A frame larger than the segment size is split into chunks striped over
+ * the endpoints, starting from the endpoint idx. Every chunk lands at its
+ * offset in the slot and carries the slot index and the number of chunks
+ * as immediate data, so the receiver delivers the frame as soon as the last
+ * chunk lands, in whatever order the chunks complete.
+ *
+ * If a chunk other than the first can't be posted, the frame is lost. The
+ * chunks already posted still complete and return the buffer, and the last
+ * of them leaves a tombstone in the slot, so the receiver releases it
+ * instead of waiting for the chunks never posted.
+ */
+int RdmaTx::write_segments(uint32_t idx, const struct iovec *iov, size_t count,
+                           void *reg_buf, void **region_descs, uint32_t slot, uint64_t addr)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += iov[i].iov_len;
+
+    size_t seg = total;
+    if (segment_size && total > segment_size)
+        seg = std::max<size_t>(segment_size,
+                               (total + WRITE_MAX_CHUNKS - 1) / WRITE_MAX_CHUNKS);
+
+    uint32_t chunks = (total + seg - 1) / seg;
+    uint32_t num_eps = static_cast<uint32_t>(ep_ctxs.size());
+    uint64_t data = chunks > 1 ? slot | (chunks << WRITE_SLOT_BITS) : slot;
+    size_t buf_slot = slot_of(reg_buf);
+
+    WriteFrame *frame = write_frames && buf_slot < (size_t)queue_size ?
+                        &write_frames[buf_slot] : nullptr;
+    if (frame) {
+        frame->chunks = chunks;
+        frame->slot = slot;
+        frame->lost.store(0, std::memory_order_relaxed);
+        frame->pending.store(chunks, std::memory_order_release);
+    }
+
+    size_t src = 0;     // Buffer the next chunk starts in
+    size_t src_off = 0; // Offset of the next chunk in the buffer
+
+    for (uint32_t k = 0; k < chunks; k++) {
+        uint32_t ep = (idx + k) % num_eps;
+        size_t left = std::min(seg, total - k * seg);
+
+        // Frames are gathered from at most two buffers
+        struct iovec chunk_iov[2];
+        void *descs[2];
+        size_t n = 0;
+
+        while (left && src < count && n < std::size(chunk_iov)) {
+            size_t part = std::min(left, iov[src].iov_len - src_off);
+            if (part) {
+                auto base = static_cast<char *>(iov[src].iov_base) + src_off;
+                chunk_iov[n] = { .iov_base = base, .iov_len = part };
+                descs[n++] = write_desc(base, ep, region_descs);
+                left -= part;
+                src_off += part;
+            }
+            if (src_off == iov[src].iov_len) {
+                src++;
+                src_off = 0;
+            }
+        }
+
+        // The first chunk is accounted for by pick_endpoint()
+        if (k)
+            ep_outstanding[ep].fetch_add(1, std::memory_order_relaxed);
+
+        int rc = libfabric_ep_ops.ep_writedata(ep_ctxs[ep], chunk_iov, descs, n, data,
+                                               addr + k * seg, ring.keys[ep],
+                                               static_cast<char *>(reg_buf) + k);
+        if (!rc)
+            continue;
+
+        if (!k)
+            return rc;
+
+        ep_outstanding[ep].fetch_sub(1, std::memory_order_relaxed);
+
+        log::error("RDMA tx segmented write failed, frame lost")
+            ("error", fi_strerror(-rc))("chunk", k)("chunks", chunks)
+            ("kind", kind2str(_kind));
+
+        // The last chunk to complete leaves the tombstone
+        uint32_t unposted = chunks - k;
+        frame->lost.fetch_add(unposted, std::memory_order_relaxed);
+        if (frame->pending.fetch_sub(unposted, std::memory_order_acq_rel) == unposted) {
+            write_tombstone(ep + 1, slot, k);
+            write_release(reg_buf);
+        }
+        break;
+    }
+
+    return 0;
+}
+
+/**
+ * Writes the tombstone of the frame lost in the slot, with the number of its
+ * chunks that land. It is tried on every endpoint from idx on, since the one
+ * that failed the frame may fail it too.
+ */
+void RdmaTx::write_tombstone(uint32_t idx, uint32_t slot, uint32_t landed)
+{
+    uint32_t num_eps = static_cast<uint32_t>(ep_ctxs.size());
+    uint64_t addr = ring.addr + (uint64_t)slot * ring.slot_size;
+    uint64_t data = slot | WRITE_SKIP | ((landed + 1) << WRITE_SLOT_BITS);
+    int rc = -EINVAL;
+
+    for (uint32_t i = 0; i < num_eps && rc; i++) {
+        uint32_t ep = (idx + i) % num_eps;
+        rc = libfabric_ep_ops.ep_inject_writedata(ep_ctxs[ep], nullptr, 0, data, addr,
+                                                  ring.keys[ep]);
+    }
+
+    if (rc)
+        log::error("RDMA tx failed to write the tombstone of a lost frame, ring stalled")
+            ("error", fi_strerror(-rc))("slot", slot)("kind", kind2str(_kind));
+}
+
+/**
+ * Get the descriptor of the buffer for the endpoint: the registration of the
+ * buffer block with the endpoint, or of the memory region with its rail.
+ */
+void *RdmaTx::write_desc(const void *ptr, uint32_t idx, void **region_descs) const
+{
+    auto p = static_cast<const char *>(ptr);
+    auto block = static_cast<const char *>(buffer_block);
+
+    if (p >= block && p < block + queue_size * send_slot_size)
+        return ep_ctxs[idx]->data_desc;
+
+    return region_descs ? region_descs[rail_of(idx)] : nullptr;
+}
+
+/**
+ * Account for the completion of a write, failed or not. Returns the buffer
+ * once all chunks of its frame have completed, or nullptr while chunks are
+ * in flight. The last chunk of a frame with chunks lost leaves the
+ * tombstone in its slot, so one failed write costs the receiver one frame.
+ */
+void *RdmaTx::write_complete(void *op_ctx, bool failed)
+{
+    size_t slot = slot_of(op_ctx);
+    if (!write_frames || slot >= (size_t)queue_size)
+        return op_ctx;
+
+    auto& frame = write_frames[slot];
+    if (failed)
+        frame.lost.fetch_add(1, std::memory_order_relaxed);
+
+    if (frame.pending.fetch_sub(1, std::memory_order_acq_rel) > 1)
+        return nullptr;
+
+    uint32_t lost = frame.lost.load(std::memory_order_relaxed);
+    if (lost) {
+        size_t chunk = (char *)op_ctx - ((char *)buffer_block + slot * send_slot_size);
+        uint32_t ep = send_ep[slot].load(std::memory_order_relaxed) + chunk + 1;
+        write_tombstone(ep, frame.slot, frame.chunks - lost);
+    }
+
+    return (char *)buffer_block + slot * send_slot_size;
+}
+
+/**
+ * Return the buffer of a completed frame to the queue.
+ */
+void RdmaTx::write_release(void *reg_buf)
+{
+    on_send_completion(reg_buf);
+    zero_copy_release(reg_buf);
+    add_to_queue(reg_buf);
+}
+
+/**
+ * @brief Returns the number of frames the receiver has room for, or
+ * UINT64_MAX while the send transport has no grant from the receiver.
+ */
+uint64_t RdmaTx::credits_available() const
+{
+    if (rma_write) {
+        if (!ring_ready.load(std::memory_order_acquire))
+            return 0;
+
+        uint64_t limit = write_credits.load(std::memory_order_acquire) + ring.slots;
+        uint64_t head = write_head.load(std::memory_order_relaxed);
+        return limit > head ? limit - head : 0;
+    }
+
+    if (!credits_known.load(std::memory_order_acquire))
+        return UINT64_MAX;
+
+    uint64_t granted = credits_granted.load(std::memory_order_acquire);
+    uint64_t used = credits_used.load(std::memory_order_relaxed);
+    return granted > used ? granted - used : 0;
+}
+
+/**
+ * Account for frames posted by the send transport. The slots of the write
+ * transport are accounted for by the write head.
+ */
+void RdmaTx::credits_take(uint32_t count)
+{
+    if (!rma_write && count)
+        credits_used.fetch_add(count, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Waits up to 1 second for a credit from the receiver.
+ */
+Result RdmaTx::credits_wait(context::Context& ctx)
+{
+    constexpr uint32_t TIMEOUT_US        = 1000000; // 1-second timeout
+    constexpr uint32_t RETRY_INTERVAL_US = 100;     // 100 µs
+    uint32_t elapsed = 0;
+    bool inline_poll = progress_inline();
+
+    while (!credits_available()) {
+        if (ctx.cancelled())
+            return Result::error_context_cancelled;
+
+        if (elapsed >= TIMEOUT_US) {
+            log::error("RDMA tx no credit from receiver within timeout")
+                ("timeout_us", TIMEOUT_US)("kind", kind2str(_kind));
+            return Result::error_timeout;
+        }
+
+        // Credits arrive on the completion queue. The CQ thread of the send
+        // transport sleeps until it is notified.
+        if (inline_poll)
+            poll_inline(rdma_cq_thread_ctx);
+        else
+            notify_buf_available();
+
+        std::this_thread::sleep_for(std::chrono::microseconds(RETRY_INTERVAL_US));
+        elapsed += RETRY_INTERVAL_US;
+    }
+
+    return Result::success;
+}
+
+/**
+ * @brief Applies the flow control policy to a frame about to be sent.
+ *
+ * @param handled Set if the frame must not be sent by the caller, because
+ * it was dropped, queued in the backlog, or timed out waiting for a credit.
+ */
+Result RdmaTx::flow_admit(context::Context& ctx, void *ptr, uint32_t sz, uint32_t& sent,
+                          bool& handled)
+{
+    handled = false;
+
+    switch (flow_control) {
+    case RDMA_FLOW_BLOCK: {
+        Result r = credits_wait(ctx);
+        if (r != Result::success) {
+            handled = true;
+            sent = 0;
+        }
+        return r;
+    }
+
+    case RDMA_FLOW_DROP_NEWEST:
+        if (credits_available())
+            return Result::success;
+
+        handled = true;
+        sent = 0;
+        flow_dropped.fetch_add(1, std::memory_order_relaxed);
+        return Result::success;
+
+    case RDMA_FLOW_DROP_OLDEST: {
+        std::lock_guard<std::mutex> lk(backlog_mx);
+
+        if (!backlog_len.load(std::memory_order_relaxed) && credits_available())
+            return Result::success;
+
+        handled = true;
+        return backlog_push(ctx, ptr, sz, sent);
+    }
+
+    default:
+        return Result::success;
+    }
+}
+
+/**
+ * @brief Copies the frame to a registered buffer at the end of the backlog,
+ * and sends the backlog as far as the credits allow. When the backlog is
+ * full or no buffer is free, the buffer of the oldest frame in the backlog
+ * is reused. Frames already posted can't be dropped, so with no frame in
+ * the backlog and no free buffer the new frame is dropped. Called under
+ * the backlog lock.
+ */
+Result RdmaTx::backlog_push(context::Context& ctx, void *ptr, uint32_t sz, uint32_t& sent)
+{
+    void *reg_buf = nullptr;
+    uint32_t len = backlog_len.load(std::memory_order_relaxed);
+
+    if (len == backlog_cap || consume_from_queue(ctx, &reg_buf) != Result::success) {
+        flow_dropped.fetch_add(1, std::memory_order_relaxed);
+
+        if (!len) {
+            sent = 0;
+            return Result::success;
+        }
+
+        reg_buf = backlog[backlog_head].reg_buf;
+        backlog_head = (backlog_head + 1) % backlog_cap;
+        backlog_len.store(--len, std::memory_order_release);
+    }
+
+    // The sequence number is taken when the frame is sent, so dropped
+    // frames leave no gap for the receiver to wait for.
+    uint32_t to_send = rma_write ? fill_slot(reg_buf, ptr, sz) :
+                                   fill_buffer(reg_buf, ptr, sz, 0);
+
+    backlog[(backlog_head + len) % backlog_cap] = { .reg_buf = reg_buf, .len = to_send };
+    backlog_len.store(len + 1, std::memory_order_release);
+    sent = to_send;
+
+    backlog_drain(ctx);
+    return Result::success;
+}
+
+/**
+ * @brief Sends the frames of the backlog in order while credits are left.
+ * Called under the backlog lock.
+ */
+void RdmaTx::backlog_drain(context::Context& ctx)
+{
+    uint32_t len = backlog_len.load(std::memory_order_relaxed);
+
+    while (len && credits_available()) {
+        auto entry = backlog[backlog_head];
+        backlog_head = (backlog_head + 1) % backlog_cap;
+        backlog_len.store(--len, std::memory_order_release);
+
+        if (!rma_write) {
+            uint64_t seq = tx_seq.fetch_add(1, std::memory_order_relaxed);
+            std::memcpy(static_cast<char *>(entry.reg_buf) + entry.len, &seq, sizeof(seq));
+        }
+
+        uint32_t sent;
+        send_buffer(ctx, entry.reg_buf, entry.len, sent);
+    }
+}
+
+/**
+ * @brief Sends the backlog once credits arrive. Called by the CQ poller.
+ */
+void RdmaTx::flow_drain(context::Context& ctx)
+{
+    if (flow_control != RDMA_FLOW_DROP_OLDEST)
+        return;
+
+    std::lock_guard<std::mutex> lk(backlog_mx);
+    backlog_drain(ctx);
+}
 
-} // namespace mesh::connection
\ No newline at end of file
+} // namespace mesh::connection
@@ -216,21 +216,86 @@ int BridgesManager::create_bridge(context::Context& ctx, Connection*& bridge,
         libfabric_ctx *dev_handle = NULL;
 
         mcm_conn_param req = {};
+        RdmaOptions options;
 
         log::debug("RDMA bridge options")
                   ("provider", cfg.conn_config.options.rdma.provider)
-                  ("num_endpoints", cfg.conn_config.options.rdma.num_endpoints);
-
-        strlcpy(req.local_addr.ip, config::proxy.rdma.dataplane_ip_addr.c_str(),
+                  ("num_endpoints", cfg.conn_config.options.rdma.num_endpoints)
+                  ("transport", cfg.conn_config.options.rdma.transport)
+                  ("completion", cfg.conn_config.options.rdma.completion)
+                  ("segment_size", cfg.conn_config.options.rdma.segment_size)
+                  ("flow_control", cfg.conn_config.options.rdma.flow_control)
+                  ("connection_mode", cfg.conn_config.conn.rdma.connection_mode)
+                  ("max_latency_ns", cfg.conn_config.conn.rdma.max_latency_ns);
+
+        // Both addresses may be comma-separated lists, one address per rail.
+        auto& local_ips = config::proxy.rdma.dataplane_ip_addr;
+        auto& remote_ips = cfg.rdma.remote_ip_addr;
+
+        strlcpy(req.local_addr.ip, local_ips.substr(0, local_ips.find(',')).c_str(),
                 sizeof(req.local_addr.ip));
-        strlcpy(req.remote_addr.ip, cfg.rdma.remote_ip_addr.c_str(),
+        strlcpy(req.remote_addr.ip, remote_ips.substr(0, remote_ips.find(',')).c_str(),
                 sizeof(req.remote_addr.ip));
+        options.local_ips = local_ips;
+        options.remote_ips = remote_ips;
 
         req.payload_args.rdma_args.transfer_size = cfg.conn_config.buf_parts.total_size();
         req.payload_args.rdma_args.queue_size = 16;
         req.payload_args.rdma_args.provider = strdup(cfg.conn_config.options.rdma.provider.c_str());
         char* _rdma_provider_dup = req.payload_args.rdma_args.provider;
         req.payload_args.rdma_args.num_endpoints = cfg.conn_config.options.rdma.num_endpoints;
+        auto& transport = cfg.conn_config.options.rdma.transport;
+        if (!transport.compare("write")) {
+            options.rma_write = true;
+        } else {
+            if (!transport.empty() && transport.compare("send"))
+                log::warn("RDMA transport not supported, using send")
+                         ("transport", transport);
+            options.rma_write = false;
+        }
+        options.segment_size = cfg.conn_config.options.rdma.segment_size;
+
+        auto& completion = cfg.conn_config.options.rdma.completion;
+        if (!completion.compare("busy-poll")) {
+            options.cq_strategy = RDMA_CQ_BUSY_POLL;
+        } else if (!completion.compare("fd-wait")) {
+            options.cq_strategy = RDMA_CQ_FD_WAIT;
+        } else {
+            if (!completion.empty() && completion.compare("hybrid"))
+                log::warn("RDMA completion strategy not supported, using hybrid")
+                         ("completion", completion);
+            options.cq_strategy = RDMA_CQ_HYBRID;
+        }
+
+        auto& flow_control = cfg.conn_config.options.rdma.flow_control;
+        if (!flow_control.compare("block")) {
+            options.flow_control = RDMA_FLOW_BLOCK;
+        } else if (!flow_control.compare("drop-oldest")) {
+            options.flow_control = RDMA_FLOW_DROP_OLDEST;
+        } else if (!flow_control.compare("drop-newest")) {
+            options.flow_control = RDMA_FLOW_DROP_NEWEST;
+        } else {
+            if (!flow_control.empty() && flow_control.compare("none"))
+                log::warn("RDMA flow control not supported, using none")
+                         ("flow_control", flow_control);
+            options.flow_control = RDMA_FLOW_NONE;
+        }
+
+        // Libfabric has no unreliable connected endpoint type, so reliability
+        // is all the connection mode selects. "RC" and "RD" are synonyms, both
+        // select the reliable datagram endpoints, over RC queue pairs with
+        // the verbs provider.
+        auto& connection_mode = cfg.conn_config.conn.rdma.connection_mode;
+        if (!connection_mode.compare("UD")) {
+            options.ep_type = RDMA_EP_UNRELIABLE;
+        } else {
+            if (!connection_mode.empty() && connection_mode.compare("RC") &&
+                connection_mode.compare("RD"))
+                log::warn("RDMA connection mode not supported, using RC")
+                         ("connection_mode", connection_mode);
+            options.ep_type = RDMA_EP_RELIABLE;
+        }
+        options.max_latency_ns = cfg.conn_config.conn.rdma.max_latency_ns;
 
         // Create Egress RDMA Bridge
         if (cfg.kind == Kind::transmitter) {
@@ -244,7 +309,7 @@ int BridgesManager::create_bridge(context::Context& ctx, Connection*& bridge,
                      "%u", cfg.rdma.port);
 
             egress_bridge->config.copy_buf_parts_from(cfg.conn_config);
-            auto res = egress_bridge->configure(ctx, req, dev_handle);
+            auto res = egress_bridge->configure(ctx, req, dev_handle, options);
             if (res != Result::success) {
                 log::error("Error configuring RDMA Egress bridge: %s",
                            result2str(res));
@@ -268,7 +333,7 @@ int BridgesManager::create_bridge(context::Context& ctx, Connection*& bridge,
                      "%u", cfg.rdma.port);
 
             ingress_bridge->config.copy_buf_parts_from(cfg.conn_config);
-            auto res = ingress_bridge->configure(ctx, req, dev_handle);
+            auto res = ingress_bridge->configure(ctx, req, dev_handle, options);
             if (res != Result::success) {
                 log::error("Error configuring RDMA Ingress bridge: %s",
                            result2str(res));
@@ -24,6 +24,7 @@ LocalManager local_manager;
 int LocalManager::create_connection_sdk(context::Context& ctx, std::string& id,
                                         mcm_conn_param *param,
                                         memif_conn_param *memif_param,
+                                        std::string& relay_region_path,
                                         const Config& conn_config,
                                         std::string& err_str)
 {
@@ -118,6 +119,7 @@ int LocalManager::create_connection_sdk(context::Context& ctx, std::string& id,
     //           ("local", std::string(param->local_addr.ip) + ":" + std::string(param->local_addr.port));
 
     conn->get_params(memif_param);
+    relay_region_path = conn->relay_region_path();
 
     // Assign id accessed by metrics collector.
     conn->assign_id(agent_assigned_id);
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "mem_region.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace mesh::connection {
+
+static std::vector<MemoryRegion> regions;
+static std::vector<MemoryRegionListener *> listeners;
+static std::mutex regions_mx;
+static uint64_t next_region_id = 1;
+
+uint64_t MemoryRegions::add(void *addr, size_t size)
+{
+    std::lock_guard<std::mutex> lk(regions_mx);
+
+    auto id = next_region_id++;
+    regions.push_back({ .id = id, .addr = addr, .size = size });
+
+    for (auto listener : listeners)
+        listener->on_region_add(regions.back());
+
+    return id;
+}
+
+void MemoryRegions::remove(uint64_t id)
+{
+    std::lock_guard<std::mutex> lk(regions_mx);
+
+    auto it = std::find_if(regions.begin(), regions.end(),
+                           [id](const MemoryRegion& r) { return r.id == id; });
+    if (it == regions.end())
+        return;
+
+    for (auto listener : listeners)
+        listener->on_region_remove(*it);
+
+    regions.erase(it);
+}
+
+void MemoryRegions::subscribe(MemoryRegionListener *listener)
+{
+    std::lock_guard<std::mutex> lk(regions_mx);
+
+    listeners.push_back(listener);
+
+    for (auto& r : regions)
+        listener->on_region_add(r);
+}
+
+void MemoryRegions::unsubscribe(MemoryRegionListener *listener)
+{
+    std::lock_guard<std::mutex> lk(regions_mx);
+
+    std::erase(listeners, listener);
+}
+
+} // namespace mesh::connection
@@ -7,6 +7,9 @@
 #include "metrics.h"
 #include "metrics_collector.h"
 #include "logger.h"
+#include <algorithm>
+#include <iterator>
+#include <mutex>
 
 namespace mesh::telemetry {
 
@@ -25,6 +28,123 @@ void MetricsProvider::assign_id(const std::string& id)
     this->id = id;
 }
 
+thread_local uint32_t counter_shard_id = UINT32_MAX;
+
+static std::vector<uint32_t> free_shards;
+static uint32_t next_shard = 0;
+static std::mutex shards_mx;
+
+class CounterShardHolder {
+public:
+    ~CounterShardHolder() {
+        if (counter_shard_id >= counter_shards_max)
+            return;
+
+        std::lock_guard<std::mutex> lk(shards_mx);
+        free_shards.push_back(counter_shard_id);
+        counter_shard_id = counter_shards_max;
+    }
+};
+
+static thread_local CounterShardHolder shard_holder;
+
+/**
+ * Assign a shard to the calling thread. Called once per thread.
+ */
+uint32_t counter_shard_acquire()
+{
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lk(shards_mx);
+
+        if (!free_shards.empty()) {
+            id = free_shards.back();
+            free_shards.pop_back();
+        } else if (next_shard < counter_shards_max) {
+            id = next_shard++;
+        } else {
+            id = counter_shards_max;
+        }
+    }
+
+    // Touch the holder to release the shard on thread exit.
+    (void)&shard_holder;
+
+    counter_shard_id = id;
+    return id;
+}
+
+/**
+ * Return the highest value falling into the bucket.
+ */
+uint64_t Histogram::bucket_value(uint32_t idx)
+{
+    if (idx < sub_count)
+        return idx;
+
+    uint32_t group = idx / sub_count;
+    uint64_t top = idx % sub_count + sub_count;
+
+    return ((top + 1) << (group - 1)) - 1;
+}
+
+/**
+ * Compute the percentiles of the values recorded since the last call
+ * and reset the histogram.
+ */
+Histogram::Summary Histogram::collect_reset()
+{
+    static thread_local uint64_t counts[bucket_count];
+    Summary sum = {};
+
+    for (uint32_t i = 0; i < bucket_count; i++) {
+        counts[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+        sum.count += counts[i];
+    }
+    sum.max = max.exchange(0, std::memory_order_relaxed);
+
+    if (!sum.count)
+        return sum;
+
+    const struct {
+        uint64_t rank;
+        uint64_t *value;
+    } ranks[] = {
+        { (sum.count * 500 + 999) / 1000, &sum.p50 },
+        { (sum.count * 990 + 999) / 1000, &sum.p99 },
+        { (sum.count * 999 + 999) / 1000, &sum.p999 },
+    };
+
+    uint64_t seen = 0;
+    uint32_t r = 0;
+
+    for (uint32_t i = 0; i < bucket_count && r < std::size(ranks); i++) {
+        seen += counts[i];
+        while (r < std::size(ranks) && seen >= ranks[r].rank) {
+            *ranks[r].value = std::min(bucket_value(i), sum.max);
+            r++;
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * Add percentile fields in microseconds, e.g. <prefix>_p50, to the metric.
+ * Nothing is added if no values were recorded in the interval.
+ */
+void Histogram::export_fields(Metric& metric, const std::string& prefix)
+{
+    auto sum = collect_reset();
+    if (!sum.count)
+        return;
+
+    metric.addFieldDouble(prefix + "_p50", sum.p50 / 1000.0);
+    metric.addFieldDouble(prefix + "_p99", sum.p99 / 1000.0);
+    metric.addFieldDouble(prefix + "_p999", sum.p999 / 1000.0);
+    metric.addFieldDouble(prefix + "_max", sum.max / 1000.0);
+}
+
 // std::unordered_map<std::string, uint8_t> Provider::metrics_map()
 // {
 //     return std::unordered_map<std::string, uint8_t>();
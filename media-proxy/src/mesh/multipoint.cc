@@ -1,5 +1,7 @@
 #include "multipoint.h"
 #include "logger.h"
+#include "proxy_config.h"
+#include <cstring>
 
 namespace mesh::multipoint {
 
@@ -13,6 +15,9 @@ Group::Group(const std::string& group_id) : Connection()
 
 Group::~Group()
 {
+    update_hotpath(true);
+    outputs_ptr.synchronize();
+    delete_all_outputs();
 }
 
 void Group::configure(context::Context& ctx)
@@ -31,8 +36,10 @@ Result Group::set_link(context::Context& ctx, Connection *new_link,
         }
 
         // Remove the requester from the group outputs list
+        Output *removed = nullptr;
+
         for (auto it = outputs.begin(); it != outputs.end(); ++it) {
-            if (*it != requester)
+            if ((*it)->conn != requester)
                 continue;
 
             log::info("[GROUP] Delete output")("group_id", id)("id", requester->id);
@@ -40,12 +47,20 @@ Result Group::set_link(context::Context& ctx, Connection *new_link,
             {
                 const std::lock_guard<std::mutex> lk(outputs_mx);
 
+                removed = *it;
                 outputs.erase(it);
             }
             break;
         }
 
-        set_hotpath_outputs(&outputs);
+        update_hotpath();
+
+        // Wait until the data plane no longer refers to the output.
+        // Stop its worker before the output connection is deleted.
+        if (removed) {
+            outputs_ptr.synchronize();
+            delete removed;
+        }
 
         return Result::success;
     }
@@ -61,26 +76,58 @@ Result Group::assign_input(context::Context& ctx, Connection *input) {
 
     log::info("[GROUP] Assign input")("group_id", id)("id", input->id);
 
+    input_parts = input->config.buf_parts;
+    update_hotpath();
+
     return set_link(ctx, input);
 }
 
 Result Group::add_output(context::Context& ctx, Connection *output) {
+    auto policy = config::proxy.multipoint.fanout_drop_oldest ?
+                  DropPolicy::drop_oldest : DropPolicy::drop_newest;
+
+    return add_output(ctx, output, policy);
+}
+
+Result Group::add_output(context::Context& ctx, Connection *output,
+                         DropPolicy policy) {
     if (output->kind() != Kind::transmitter)
         return Result::error_bad_argument;
 
     log::info("[GROUP] Add output")("group_id", id)("id", output->id);
 
+    auto out = new(std::nothrow) Output(this, output);
+    if (!out)
+        return Result::error_out_of_memory;
+
+    if (config::proxy.multipoint.parallel_fanout) {
+        auto res = out->start(config::proxy.multipoint.fanout_queue_depth,
+                              policy);
+        if (res != Result::success) {
+            delete out;
+            return res;
+        }
+    }
+
     {
         const std::lock_guard<std::mutex> lk(outputs_mx);
 
-        outputs.emplace_back(output);
-    }    
+        outputs.emplace_back(out);
+    }
 
-    set_hotpath_outputs(&outputs);
+    update_hotpath();
 
     return Result::success;
 }
 
+void Group::delete_all_outputs()
+{
+    for (auto output : outputs)
+        delete output;
+
+    outputs.clear();
+}
+
 Result Group::on_establish(context::Context& ctx)
 {
     set_state(ctx, State::active);
@@ -89,30 +136,134 @@ Result Group::on_establish(context::Context& ctx)
     return Result::success;
 }
 
-std::list<Connection *> * Group::get_hotpath_outputs_lock()
+Group::Hotpath * Group::get_hotpath_lock()
 {
-    return reinterpret_cast<std::list<Connection *> *>(outputs_ptr.load_next_lock());
+    return reinterpret_cast<Hotpath *>(outputs_ptr.load_next_lock());
 }
 
-void Group::hotpath_outputs_unlock() {
+void Group::hotpath_unlock() {
     outputs_ptr.unlock();
 }
 
-void Group::set_hotpath_outputs(std::list<Connection *> *new_outputs)
+/**
+ * Publish a new snapshot of the outputs to the data plane. The previous
+ * snapshot is deleted after all data plane threads stop using it. The call
+ * does not wait for the data plane.
+ */
+void Group::update_hotpath(bool clear)
+{
+    const std::lock_guard<std::mutex> lk(outputs_mx);
+
+    auto prev = reinterpret_cast<Hotpath *>(outputs_ptr.load());
+    Hotpath *hotpath = nullptr;
+
+    if (!clear) {
+        hotpath = new Hotpath;
+        hotpath->outputs.assign(outputs.begin(), outputs.end());
+        hotpath->pool = hotpath_pool(prev, hotpath->pool_capacity);
+    }
+
+    outputs_ptr.store(hotpath);
+
+    if (!prev)
+        return;
+
+    // Deletion of the pool is deferred until all buffers are released.
+    auto prev_pool = prev->pool != (hotpath ? hotpath->pool : nullptr) ?
+                     prev->pool : nullptr;
+
+    outputs_ptr.retire([prev, prev_pool]() {
+        if (prev_pool)
+            prev_pool->destroy();
+        delete prev;
+    });
+}
+
+/**
+ * Return the pool for frames received as raw pointers, which are copied
+ * once into a pool buffer shared by all outputs. Every output holds up to
+ * the queue depth frames plus the one being processed. The pool of the
+ * previous snapshot is reused unless it is too small.
+ */
+BufferPool * Group::hotpath_pool(Hotpath *prev, uint32_t& capacity)
+{
+    auto buf_size = input_parts.total_size();
+
+    if (!config::proxy.multipoint.parallel_fanout || !buf_size ||
+        outputs.empty()) {
+        capacity = 0;
+        return nullptr;
+    }
+
+    auto depth = config::proxy.multipoint.fanout_queue_depth;
+    uint32_t required = (depth + 1) * (outputs.size() + 1);
+
+    if (prev && prev->pool && prev->pool_capacity >= required &&
+        prev->pool->parts.total_size() == buf_size) {
+        capacity = prev->pool_capacity;
+        return prev->pool;
+    }
+
+    // Grow in steps to avoid reallocation on every added output.
+    capacity = std::max(required, prev ? prev->pool_capacity * 2 : 0);
+
+    auto pool = new(std::nothrow) BufferPool(input_parts);
+    if (pool && !pool->init(capacity, true)) {
+        log::error("[GROUP] Fan-out buffer pool alloc failed")
+                  ("group_id", id)("capacity", capacity)
+                  ("buf_size", buf_size);
+        pool->destroy();
+        pool = nullptr;
+    }
+
+    if (!pool)
+        capacity = 0;
+
+    return pool;
+}
+
+/**
+ * Copy the frame into a buffer of the hotpath pool, to be queued to the
+ * parallel outputs. Frames received as raw pointers are copied, and so are
+ * ingress ring slots, which would stall the ingress ring while queued.
+ * Returns nullptr if the frame is not to be copied or no buffer is left.
+ */
+BufferHandle * Group::hotpath_copy(Hotpath *hotpath, void *ptr, uint32_t sz,
+                                   BufferHandle *buf)
 {
-    if (new_outputs)
-        new_outputs = new std::list<Connection *>(*new_outputs);
+    if ((buf && !buf->ring_slot) || !hotpath->pool ||
+        sz > hotpath->pool->parts.total_size())
+        return nullptr;
+
+    auto copy = hotpath->pool->alloc();
+    if (!copy)
+        return nullptr;
+
+    std::memcpy(copy->data, ptr, sz);
+    copy->size = sz;
+    copy->ingress_ns = buf ? buf->ingress_ns : telemetry::now_ns();
 
-    auto prev_outputs_ptr = reinterpret_cast<std::list<Connection *> *>(outputs_ptr.load());
-    
-    outputs_ptr.store_wait(new_outputs);
-    
-    if (prev_outputs_ptr)
-        delete prev_outputs_ptr;
+    return copy;
 }
 
 Result Group::on_receive(context::Context& ctx, void *ptr,
                          uint32_t sz, uint32_t& sent)
+{
+    return fan_out(ctx, ptr, sz, nullptr, sent);
+}
+
+/**
+ * Forward the buffer handle to all outputs. Outputs that need the buffer
+ * after returning from the call retain the handle on their own.
+ */
+Result Group::on_receive(context::Context& ctx, BufferHandle *buf,
+                         uint32_t& sent)
+{
+    return fan_out(ctx, buf->data, buf->size, buf, sent);
+}
+
+Result Group::fan_out(context::Context& ctx, void *ptr, uint32_t sz,
+                      BufferHandle *buf, uint32_t& sent)
 {
     if (state() != State::active)
         return set_result(Result::error_wrong_state);
@@ -124,23 +275,43 @@ Result Group::on_receive(context::Context& ctx, void *ptr,
 
     auto res = Result::success;
     uint32_t total_sent = 0;
-    uint32_t errors = 0;    
+    uint32_t errors = 0;
 
-    auto _outputs = get_hotpath_outputs_lock();
+    auto hotpath = get_hotpath_lock();
 
-    if (!_outputs || _outputs->empty()) {
-        hotpath_outputs_unlock();
+    if (!hotpath || hotpath->outputs.empty()) {
+        hotpath_unlock();
         return Result::error_no_link_assigned;
     }
 
-    for (Connection *output : *_outputs) {
-        if (!output) {
+    // In the parallel dispatch mode, queue the frame to the output workers
+    // without waiting for the outputs to consume it.
+    // An ingress ring slot that could not be copied is never queued,
+    // parallel outputs receive it serially instead.
+    BufferHandle *copy = hotpath_copy(hotpath, ptr, sz, buf);
+    if (!buf)
+        buf = copy;
+
+    BufferHandle *queued = copy ? copy : buf;
+    if (queued && queued->ring_slot)
+        queued = nullptr;
+
+    for (Output *output : hotpath->outputs) {
+        if (!output || !output->conn) {
             errors++;
             continue;
         }
 
+        if (queued && output->is_parallel()) {
+            output->dispatch(queued);
+            continue;
+        }
+
         uint32_t out_sent = 0;
-        res = output->do_receive(ctx, ptr, sz, out_sent);
+        if (buf)
+            res = output->conn->do_receive(ctx, buf, out_sent);
+        else
+            res = output->conn->do_receive(ctx, ptr, sz, out_sent);
 
         total_sent += out_sent;
 
@@ -148,7 +319,10 @@ Result Group::on_receive(context::Context& ctx, void *ptr,
             errors++;
     }
 
-    hotpath_outputs_unlock();
+    hotpath_unlock();
+
+    if (copy)
+        copy->release();
 
     sent = sz;
     metrics.outbound_bytes += total_sent;
@@ -162,12 +336,102 @@ Result Group::on_receive(context::Context& ctx, void *ptr,
     return Result::success;
 }
 
+/**
+ * Forward a burst of buffer handles to all outputs. The outputs snapshot
+ * is loaded once per burst, and every serial output receives the whole
+ * burst in one call.
+ */
+Result Group::on_receive_burst(context::Context& ctx, BufferHandle **bufs,
+                               uint32_t count, uint32_t& sent)
+{
+    if (state() != State::active)
+        return set_result(Result::error_wrong_state);
+
+    if (!link())
+        return set_result(Result::error_no_link_assigned);
+
+    uint64_t in = 0;
+    for (uint32_t i = 0; i < count; i++)
+        in += bufs[i]->size;
+
+    metrics.inbound_bytes += in;
+
+    uint32_t total_sent = 0;
+    uint32_t errors = 0;
+
+    auto hotpath = get_hotpath_lock();
+
+    if (!hotpath || hotpath->outputs.empty()) {
+        hotpath_unlock();
+        return Result::error_no_link_assigned;
+    }
+
+    // Ingress ring slots are copied once for all parallel outputs.
+    BufferHandle *copies[burst_max] = {};
+    uint32_t ncopies = hotpath->pool ? std::min(count, burst_max) : 0;
+
+    for (uint32_t i = 0; i < ncopies; i++)
+        copies[i] = hotpath_copy(hotpath, bufs[i]->data, bufs[i]->size, bufs[i]);
+
+    for (Output *output : hotpath->outputs) {
+        if (!output || !output->conn) {
+            errors++;
+            continue;
+        }
+
+        uint32_t out_sent = 0;
+        auto res = Result::success;
+
+        if (output->is_parallel()) {
+            // Ingress ring slots left without a copy are delivered serially.
+            for (uint32_t i = 0; i < count; i++) {
+                auto queued = i < ncopies && copies[i] ? copies[i] : bufs[i];
+                if (!queued->ring_slot) {
+                    output->dispatch(queued);
+                    continue;
+                }
+
+                uint32_t buf_sent = 0;
+                auto buf_res = output->conn->do_receive(ctx, queued, buf_sent);
+                out_sent += buf_sent;
+                if (buf_res != Result::success)
+                    res = buf_res;
+            }
+        } else {
+            res = output->conn->do_receive_burst(ctx, bufs, count, out_sent);
+        }
+
+        total_sent += out_sent;
+
+        if (res != Result::success)
+            errors++;
+    }
+
+    hotpath_unlock();
+
+    for (uint32_t i = 0; i < ncopies; i++)
+        if (copies[i])
+            copies[i]->release();
+
+    sent = in;
+    metrics.outbound_bytes += total_sent;
+    metrics.errors += errors;
+
+    if (!errors)
+        metrics.transactions_succeeded += count;
+    else
+        metrics.transactions_failed += count;
+
+    return Result::success;
+}
+
 Result Group::on_shutdown(context::Context& ctx)
 {
     set_link(ctx, nullptr);
 
-    outputs.clear();
-    set_hotpath_outputs(nullptr);
+    update_hotpath(true);
+    outputs_ptr.synchronize();
+    delete_all_outputs();
 
     set_state(ctx, State::closed);
     set_status(ctx, Status::shutdown);
@@ -179,4 +443,88 @@ void Group::on_delete(context::Context& ctx)
 {
 }
 
+Group::Output::~Output()
+{
+    if (!queue)
+        return;
+
+    worker_ctx.cancel();
+    queue->close();
+
+    if (th.joinable())
+        th.join();
+
+    while (auto buf = queue->try_receive())
+        (*buf)->release();
+
+    if (dropped)
+        log::warn("[GROUP] Output dropped frames")("group_id", group->id)
+                 ("id", conn->id)("dropped", dropped);
+}
+
+Result Group::Output::start(size_t queue_depth, DropPolicy policy)
+{
+    this->policy = policy;
+
+    queue = std::make_unique<thread::Channel<BufferHandle *>>(queue_depth);
+    worker_ctx = context::WithCancel(context::Background());
+
+    try {
+        th = std::jthread([this]() { worker(worker_ctx); });
+    }
+    catch (const std::system_error& e) {
+        log::error("[GROUP] Output worker create failed")("group_id", group->id)
+                  ("id", conn->id)("error", e.what());
+        queue.reset();
+        return Result::error_thread_creation_failed;
+    }
+
+    return Result::success;
+}
+
+/**
+ * Queue the frame to the output worker. Never blocks the caller.
+ * If the queue is full, a frame is dropped according to the output policy.
+ */
+void Group::Output::dispatch(BufferHandle *buf)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    buf->retain();
+
+    if (policy == DropPolicy::drop_oldest) {
+        auto evicted = queue->send_evict(buf);
+        if (!evicted.has_value())
+            return;
+
+        (*evicted)->release();
+    } else {
+        if (queue->try_send(buf))
+            return;
+
+        buf->release();
+    }
+
+    dropped++;
+}
+
+void Group::Output::worker(context::Context& ctx)
+{
+    while (!ctx.cancelled()) {
+        auto buf = queue->receive(ctx);
+        if (!buf.has_value())
+            break;
+
+        uint32_t sent = 0;
+        auto res = conn->do_receive(ctx, *buf, sent);
+
+        (*buf)->release();
+
+        group->metrics.outbound_bytes += sent;
+        if (res != Result::success)
+            group->metrics.errors++;
+    }
+}
+
 } // namespace mesh::multipoint
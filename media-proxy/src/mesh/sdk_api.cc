@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -70,15 +71,19 @@ public:
             // return Status(StatusCode::INVALID_ARGUMENT,
             //               "Wrong size of mcm_conn_param");
         }
-        memcpy(&param, req->mcm_conn_param().data(), sz);
+        // A client built with another layout must not overflow the param.
+        memcpy(&param, req->mcm_conn_param().data(),
+               std::min<size_t>(sz, sizeof(param)));
 
         auto ctx = context::WithCancel(context::Background());
         std::string conn_id;
         std::string err_str;
+        std::string relay_region_path;
 
         auto& mgr = connection::local_manager;
         int err = mgr.create_connection_sdk(ctx, conn_id, &param, &memif_param,
-                                            conn_config, err_str);
+                                            relay_region_path, conn_config,
+                                            err_str);
         if (err) {
             log::error("create_local_conn() failed (%d)", err);
             if (err_str.empty())
@@ -94,6 +99,7 @@ public:
         std::string memif_param_str(reinterpret_cast<const char *>(&memif_param),
                                     sizeof(memif_conn_param));
         resp->set_memif_conn_param(memif_param_str);
+        resp->set_relay_region_path(relay_region_path);
 
         log::info("[SDK] Connection created")("id", resp->conn_id())
                                              ("client_id", resp->client_id());
@@ -5,59 +5,426 @@
  */
 
 #include "sync.h"
+#include "metrics.h"
+#include <bit>
+#include <climits>
+#include <ctime>
+#include <exception>
+#include <thread>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
 
 namespace mesh::sync {
 
-static const uint64_t STATE_UNLOCKED = 0;
-static const uint64_t STATE_LOCKED   = 2;
-static const uint64_t FLAG_NEW_VALUE = 1;
+using telemetry::counter_shards_max;
+
+/**
+ * Read-side critical sections entered by the thread, the innermost last.
+ * Every section records the shard and the phase of the reader counter it
+ * is counted in.
+ */
+static constexpr uint32_t max_nesting = 16;
+
+static thread_local uint8_t section_shards[max_nesting];
+static thread_local uint8_t section_phases[max_nesting];
+static thread_local uint32_t nesting = 0;
+
+static EpochDomain global_domain;
+
+EpochDomain::EpochDomain() : shards(new ReaderShard[counter_shards_max + 1])
+{
+}
+
+EpochDomain::~EpochDomain()
+{
+    for (auto& r : retired)
+        r.deleter();
+}
+
+void EpochDomain::enter()
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (nesting >= max_nesting) [[unlikely]]
+        std::terminate();
+
+    uint32_t shard = telemetry::counter_shard();
+    uint32_t p = phase.load(std::memory_order_relaxed);
+    auto& readers = shards[shard].readers[p];
+
+    // Only the thread of the shard writes to it, but the overflow shard.
+    if (shard < counter_shards_max) [[likely]]
+        readers.store(readers.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    else
+        readers.fetch_add(1, std::memory_order_relaxed);
+
+    // Publish the reader before reading any shared pointer.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    section_shards[nesting] = shard;
+    section_phases[nesting++] = p;
+}
+
+void EpochDomain::leave()
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    uint32_t shard = section_shards[--nesting];
+    auto& readers = shards[shard].readers[section_phases[nesting]];
+
+    if (shard < counter_shards_max) [[likely]]
+        readers.store(readers.load(std::memory_order_relaxed) - 1,
+                      std::memory_order_release);
+    else
+        readers.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * Flip the phase if all readers of the previous phase have left. Returns
+ * false if some are left. Must be called with the domain locked.
+ */
+bool EpochDomain::advance()
+{
+    // Unpublish objects before checking for readers.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint32_t p = phase.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i <= counter_shards_max; i++)
+        if (shards[i].readers[p ^ 1].load(std::memory_order_acquire))
+            return false;
+
+    phase.store(p ^ 1, std::memory_order_relaxed);
+    flips.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Schedule the deleter to be called after a grace period. Must be called
+ * after the object has been unpublished.
+ */
+void EpochDomain::retire(std::function<void()> deleter)
+{
+    {
+        std::lock_guard<std::mutex> lk(mx);
+
+        uint64_t grace = flips.load(std::memory_order_relaxed) + 2;
+        retired.push_back({ .grace = grace, .deleter = std::move(deleter) });
+    }
+    reclaim();
+}
+
+/**
+ * Wait until all readers of the domain that could have seen an unpublished
+ * object leave their critical sections. Typically takes a few microseconds.
+ */
+void EpochDomain::synchronize()
+{
+    uint64_t grace;
+    {
+        std::lock_guard<std::mutex> lk(mx);
+        grace = flips.load(std::memory_order_relaxed) + 2;
+    }
+
+    for (int i = 0;; i++) {
+        {
+            std::lock_guard<std::mutex> lk(mx);
+
+            while (flips.load(std::memory_order_relaxed) < grace && advance());
+
+            if (flips.load(std::memory_order_relaxed) >= grace)
+                break;
+        }
+
+        if (i < 1000)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    reclaim();
+}
+
+/**
+ * Call the deleters of all retired objects whose grace period has elapsed.
+ */
+void EpochDomain::reclaim()
+{
+    std::vector<Retired> expired;
+    {
+        std::lock_guard<std::mutex> lk(mx);
+
+        if (retired.empty())
+            return;
+
+        for (int i = 0; i < 2 && advance(); i++);
+
+        auto done = flips.load(std::memory_order_relaxed);
+
+        for (auto it = retired.begin(); it != retired.end();) {
+            if (it->grace <= done) {
+                expired.push_back(std::move(*it));
+                it = retired.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    for (auto& r : expired)
+        r.deleter();
+}
+
+void Epoch::enter()
+{
+    global_domain.enter();
+}
+
+void Epoch::leave()
+{
+    global_domain.leave();
+}
+
+void Epoch::retire(std::function<void()> deleter)
+{
+    global_domain.retire(std::move(deleter));
+}
+
+void Epoch::synchronize()
+{
+    global_domain.synchronize();
+}
+
+void Epoch::reclaim()
+{
+    global_domain.reclaim();
+}
 
 void * DataplaneAtomicPtr::load()
 {
-    return (void *)current.load(std::memory_order_acquire);
+    return committed.load(std::memory_order_acquire);
+}
+
+/**
+ * Publish a new value without waiting for the hotpath. Returns the previous
+ * value, which the caller retires via retire().
+ */
+void * DataplaneAtomicPtr::store(void *new_ptr)
+{
+    std::lock_guard<std::mutex> lk(mx);
+
+    auto prev = current.exchange(new_ptr, std::memory_order_acq_rel);
+    committed.store(new_ptr, std::memory_order_release);
+
+    return prev;
 }
 
 void DataplaneAtomicPtr::store_wait(void *new_ptr)
 {
     std::lock_guard<std::mutex> lk(mx);
 
-    uint64_t new_value = (uint64_t)new_ptr;
+    current.store(new_ptr, std::memory_order_seq_cst);
+
+    epoch.synchronize();
+
+    committed.store(new_ptr, std::memory_order_release);
+}
+
+void * DataplaneAtomicPtr::load_next_lock()
+{
+    epoch.enter();
+    return current.load(std::memory_order_acquire);
+}
+
+void DataplaneAtomicPtr::unlock()
+{
+    epoch.leave();
+}
+
+Ring::Ring(size_t capacity)
+{
+    if (capacity)
+        init(capacity);
+}
+
+/**
+ * Allocate the cells of an empty ring. Returns false if the allocation
+ * failed, in which case the ring has no capacity.
+ */
+bool Ring::init(size_t capacity)
+{
+    capacity = std::bit_ceil(std::max<size_t>(capacity, 2));
+
+    cells.reset(new(std::nothrow) Cell[capacity]);
+    if (!cells) {
+        mask = 0;
+        return false;
+    }
+
+    for (size_t i = 0; i < capacity; i++)
+        cells[i].seq.store(i, std::memory_order_relaxed);
+
+    mask = capacity - 1;
+    enqueue_pos.store(0, std::memory_order_relaxed);
+    dequeue_pos.store(0, std::memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * Push the pointer. Returns false if the ring is full.
+ */
+bool Ring::push(void *ptr)
+{
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (!cells)
+        return false;
+
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Cell *cell;
 
-    auto prev = next.exchange(new_value | FLAG_NEW_VALUE, std::memory_order_acq_rel);
-    if (prev == STATE_LOCKED) {
-        for (;;) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
 
-            if (current.load(std::memory_order_acquire) == new_value)
-                return;
+        if (!diff) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
         }
     }
 
-    current.store(new_value, std::memory_order_release);
-    return;
+    cell->ptr = ptr;
+    cell->seq.store(pos + 1, std::memory_order_release);
+
+    // Pairs with the fence in pop_wait(). Either the consumer sees the
+    // pointer, or the producer sees the consumer waiting.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed))
+        wake(1);
+
+    return true;
 }
 
-void * DataplaneAtomicPtr::load_next_lock()
+/**
+ * Pop a pointer without blocking. Returns false if the ring is empty.
+ */
+bool Ring::pop(void *& ptr)
 {
-    uint64_t next_value = next.exchange(STATE_LOCKED, std::memory_order_acq_rel);
-    uint64_t current_value;
+    // WARNING: This is the hot path of Data Plane.
+    // Avoid any unnecessary operations that can increase latency.
+
+    if (!cells)
+        return false;
+
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    Cell *cell;
+
+    for (;;) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
 
-    if (next_value & FLAG_NEW_VALUE) {
-        current_value = next_value & ~FLAG_NEW_VALUE;
-        current.store(current_value, std::memory_order_release);
-    } else {
-        current_value = current.load(std::memory_order_acquire);
+        if (!diff) {
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                  std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
     }
 
-    return (void *)current_value;
+    ptr = cell->ptr;
+    cell->seq.store(pos + mask + 1, std::memory_order_release);
+
+    return true;
 }
 
-void DataplaneAtomicPtr::unlock()
+/**
+ * Pop a pointer, blocking while the ring is empty. Returns false if the
+ * timeout expired or the context was cancelled.
+ */
+bool Ring::pop_wait(context::Context& ctx, void *& ptr,
+                    std::chrono::nanoseconds timeout)
+{
+    if (pop(ptr))
+        return true;
+
+    auto infinite = timeout == std::chrono::nanoseconds::max();
+    auto deadline = std::chrono::steady_clock::now() +
+                    (infinite ? std::chrono::nanoseconds::zero() : timeout);
+
+    // Wake up all consumers when the context is cancelled.
+    std::stop_callback cb(ctx.stop_token(), [this]() { wake(INT_MAX); });
+
+    for (;;) {
+        uint32_t seq = wake_seq.load(std::memory_order_acquire);
+
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (pop(ptr)) {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        if (ctx.cancelled()) {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        struct timespec ts, *pts = nullptr;
+
+        if (!infinite) {
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::nanoseconds::zero()) {
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+            ts.tv_sec = ns / 1000000000;
+            ts.tv_nsec = ns % 1000000000;
+            pts = &ts;
+        }
+
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&wake_seq), FUTEX_WAIT_PRIVATE,
+                seq, pts, nullptr, 0);
+
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void Ring::wake(int count)
+{
+    wake_seq.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&wake_seq), FUTEX_WAKE_PRIVATE,
+            count, nullptr, nullptr, 0);
+}
+
+/**
+ * Return the number of pointers in the ring. The value is approximate
+ * while other threads push or pop.
+ */
+size_t Ring::size() const
 {
-    uint64_t next_value = next.exchange(STATE_UNLOCKED, std::memory_order_acq_rel);
+    auto head = dequeue_pos.load(std::memory_order_acquire);
+    auto tail = enqueue_pos.load(std::memory_order_acquire);
 
-    if (next_value & FLAG_NEW_VALUE)
-        current.store(next_value & ~FLAG_NEW_VALUE, std::memory_order_release);
+    return tail > head ? tail - head : 0;
 }
 
 } // namespace mesh::sync
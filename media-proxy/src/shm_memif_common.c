@@ -6,6 +6,7 @@
 
 #include <stdlib.h>
 
+#include "memif_private.h"
 #include "shm_memif.h"
 
 void print_memif_details(memif_conn_handle_t conn)
@@ -99,6 +100,9 @@ int memif_buffer_alloc_timeout(memif_conn_handle_t conn, uint16_t qid,
     while (waited_half_ms < timeout_ms * 2) {
         err = memif_buffer_alloc(conn, qid, bufs, count, count_out, size);
         if (err == MEMIF_ERR_NOBUF_RING) {
+            /* Part of the burst fits in the ring. The caller sends it. */
+            if (*count_out)
+                return 0;
             usleep(500);
             waited_half_ms += 1;
             continue;
@@ -110,3 +114,50 @@ int memif_buffer_alloc_timeout(memif_conn_handle_t conn, uint16_t qid,
     }
     return MEMIF_ERR_NOBUF_RING;
 }
+
+int memif_buffer_set_offset(memif_conn_handle_t conn, uint16_t qid,
+                            memif_buffer_t *buf, uint32_t offset)
+{
+    memif_connection_t *c = (memif_connection_t *)conn;
+    if (c == NULL)
+        return MEMIF_ERR_NOCONN;
+    if (c->control_channel == NULL)
+        return MEMIF_ERR_DISCONNECTED;
+    if (qid >= c->tx_queues_num)
+        return MEMIF_ERR_QID;
+    if (buf == NULL)
+        return MEMIF_ERR_INVAL_ARG;
+
+    memif_queue_t *mq = &c->tx_queues[qid];
+    uint16_t mask = (1 << mq->log2_ring_size) - 1;
+    memif_desc_t *d = &mq->ring->desc[buf->desc_index & mask];
+    memif_region_t *r = &c->regions[d->region];
+
+    if ((uint64_t)offset + c->run_args.buffer_size > r->region_size)
+        return MEMIF_ERR_INVAL_ARG;
+
+    d->offset = offset;
+    buf->data = (uint8_t *)r->addr + offset;
+    return MEMIF_ERR_SUCCESS;
+}
+
+int memif_get_tx_released(memif_conn_handle_t conn, uint16_t qid,
+                          uint16_t *released)
+{
+    memif_connection_t *c = (memif_connection_t *)conn;
+    if (c == NULL)
+        return MEMIF_ERR_NOCONN;
+    if (c->control_channel == NULL)
+        return MEMIF_ERR_DISCONNECTED;
+    if (qid >= c->tx_queues_num)
+        return MEMIF_ERR_QID;
+    if (released == NULL)
+        return MEMIF_ERR_INVAL_ARG;
+
+    memif_queue_t *mq = &c->tx_queues[qid];
+
+    /* The peer refills descriptors by moving the head one ring ahead
+     * of the last descriptor it has consumed. */
+    *released = mq->ring->head - (1 << mq->log2_ring_size);
+    return MEMIF_ERR_SUCCESS;
+}
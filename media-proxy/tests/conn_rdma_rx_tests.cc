@@ -5,12 +5,15 @@
 #include "conn_rdma_test_mocks.h"
 #include "libfabric_ep.h"
 #include "libfabric_dev.h"
+#include "mesh/proxy_config.h"
 #include <cstring>
 #include <atomic>
 #include <chrono>
 #include <thread>
 #include <iomanip>
 #include <sstream>
+#include <memory>
+#include <vector>
 
 #define DUMMY_DATA1 "DUMMY_DATA1"
 #define DUMMY_DATA2 "DUMMY_DATA2"
@@ -129,7 +132,7 @@ class RdmaRxTest : public ::testing::Test {
 
 TEST_F(RdmaRxTest, EstablishSuccess)
 {
-    libfabric_ctx mock_dev_handle; // Mocked device handle
+    libfabric_ctx mock_dev_handle = {}; // Mocked device handle
 
     EXPECT_CALL(*mock_dev_ops, rdma_init(::testing::_))
         .WillOnce(::testing::DoAll(::testing::SetArgPointee<0>(&mock_dev_handle),
@@ -224,7 +227,7 @@ TEST_F(RdmaRxTest, EstablishFailureBufferAllocation)
 
 TEST_F(RdmaRxTest, EstablishAlreadyInitialized)
 {
-    libfabric_ctx mock_dev_handle; // Mocked device handle
+    libfabric_ctx mock_dev_handle = {}; // Mocked device handle
 
     EXPECT_CALL(*mock_dev_ops, rdma_init(::testing::_))
         .WillOnce(::testing::DoAll(::testing::SetArgPointee<0>(&mock_dev_handle),
@@ -321,4 +324,241 @@ TEST_F(RdmaRxTest, ValidateStateTransitions)
     res = conn_rx->shutdown(ctx);
     ASSERT_EQ(res, connection::Result::success);
     ASSERT_EQ(conn_rx->state(), connection::State::closed);
-}
\ No newline at end of file
+}
+
+// Records the sequence numbers of the frames delivered by the receiver
+class ReorderSink : public connection::Connection {
+  public:
+    std::vector<uint64_t> seqs;
+
+    ReorderSink(context::Context& ctx)
+    {
+        _kind = connection::Kind::transmitter;
+        set_state(ctx, connection::State::active);
+    }
+
+    connection::Result on_establish(context::Context& ctx) override
+    {
+        return connection::Result::success;
+    }
+
+    connection::Result on_shutdown(context::Context& ctx) override
+    {
+        return connection::Result::success;
+    }
+
+    connection::Result on_receive_burst(context::Context& ctx, connection::BufferHandle **bufs,
+                                        uint32_t count, uint32_t& sent) override
+    {
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t seq;
+            std::memcpy(&seq, bufs[i]->data, sizeof(seq));
+            seqs.push_back(seq);
+        }
+        sent = count;
+        return connection::Result::success;
+    }
+};
+
+// A receiver of the send transport with a reorder window and a buffer pool
+// but no device. Frames are slotted into the window as the CQ poller does.
+class ReorderRdmaRx : public connection::RdmaRx {
+  public:
+    using RdmaRx::reorder_stats;
+
+    static constexpr uint32_t QUEUE = 16;
+    static constexpr uint32_t FRAME = 64;
+
+    ReorderRdmaRx(context::Context& ctx) : frames(256 * FRAME)
+    {
+        queue_size = QUEUE;
+        rdma_num_eps = 1;
+
+        rx_pool = new connection::BufferPool(config.buf_parts);
+        rx_pool->init(queue_size);
+        auto owner = new sync::DataplaneAtomicPtr;
+        owner->store(this);
+        rx_pool->on_destroy([owner]() { delete owner; });
+        rx_owner = owner;
+
+        reorder_init();
+        set_state(ctx, connection::State::active);
+    }
+
+    ~ReorderRdmaRx()
+    {
+        rx_close();
+        rx_pool->destroy();
+    }
+
+    // Receives a frame with the sequence number in a buffer of its own
+    void receive(context::Context& ctx, uint64_t seq)
+    {
+        char *buf = &frames[next_frame++ % 256 * FRAME];
+        std::memcpy(buf, &seq, sizeof(seq));
+        reorder_insert(ctx, buf, FRAME, seq);
+        flush_in_order(ctx);
+        reorder_expire(ctx);
+    }
+
+    void expire(context::Context& ctx) { reorder_expire(ctx); }
+
+    size_t recycled() const { return get_buffer_queue_size(); }
+
+  private:
+    std::vector<char> frames;
+    uint32_t next_frame = 0;
+};
+
+class RdmaReorderTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        saved_timeout_us = config::proxy.rdma.reorder_timeout_us;
+        config::proxy.rdma.reorder_timeout_us = 1000;
+
+        ctx = context::WithCancel(context::Background());
+        sink = std::make_unique<ReorderSink>(ctx);
+        rx = std::make_unique<ReorderRdmaRx>(ctx);
+        rx->set_link(ctx, sink.get());
+    }
+
+    void TearDown() override
+    {
+        rx.reset();
+        config::proxy.rdma.reorder_timeout_us = saved_timeout_us;
+    }
+
+    uint64_t skipped() { return rx->reorder_stats.skipped.load(); }
+    uint64_t late() { return rx->reorder_stats.late.load(); }
+    uint64_t reordered() { return rx->reorder_stats.reordered.load(); }
+
+    uint32_t saved_timeout_us;
+    context::Context ctx;
+    std::unique_ptr<ReorderSink> sink;
+    std::unique_ptr<ReorderRdmaRx> rx;
+};
+
+TEST_F(RdmaReorderTest, InOrder)
+{
+    for (uint64_t seq = 100; seq < 105; seq++)
+        rx->receive(ctx, seq);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 100, 101, 102, 103, 104 }));
+    ASSERT_EQ(skipped(), 0);
+    ASSERT_EQ(late(), 0);
+    ASSERT_EQ(reordered(), 0);
+    ASSERT_EQ(rx->recycled(), 5);
+}
+
+TEST_F(RdmaReorderTest, Reordered)
+{
+    rx->receive(ctx, 10);
+    rx->receive(ctx, 12);
+    rx->receive(ctx, 11);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 10, 11, 12 }));
+    ASSERT_EQ(reordered(), 1);
+    ASSERT_EQ(skipped(), 0);
+}
+
+TEST_F(RdmaReorderTest, TimeoutSkip)
+{
+    rx->receive(ctx, 10);
+    rx->receive(ctx, 12);
+    rx->receive(ctx, 13);
+
+    // Frame 11 is still awaited
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 10 }));
+    rx->expire(ctx);
+    ASSERT_EQ(sink->seqs.size(), 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    rx->expire(ctx);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 10, 12, 13 }));
+    ASSERT_EQ(skipped(), 1);
+}
+
+TEST_F(RdmaReorderTest, LateDrop)
+{
+    rx->receive(ctx, 10);
+    rx->receive(ctx, 12);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    rx->expire(ctx);
+    ASSERT_EQ(skipped(), 1);
+
+    // Frame 11 arrives after it was skipped
+    rx->receive(ctx, 11);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 10, 12 }));
+    ASSERT_EQ(late(), 1);
+    ASSERT_EQ(rx->recycled(), 3);
+}
+
+TEST_F(RdmaReorderTest, DuplicateDrop)
+{
+    rx->receive(ctx, 10);
+    rx->receive(ctx, 12);
+
+    // Duplicates of a delivered frame and of a frame waiting in the window
+    rx->receive(ctx, 10);
+    rx->receive(ctx, 12);
+
+    rx->receive(ctx, 11);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 10, 11, 12 }));
+    ASSERT_EQ(late(), 2);
+    ASSERT_EQ(skipped(), 0);
+    ASSERT_EQ(rx->recycled(), 5);
+}
+
+TEST_F(RdmaReorderTest, TooFarAhead)
+{
+    rx->receive(ctx, 0);
+    rx->receive(ctx, 2);
+
+    // The window of 64 frames must move to take frame 66, which skips
+    // frame 1 and delivers frame 2
+    rx->receive(ctx, 66);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 0, 2 }));
+    ASSERT_EQ(skipped(), 1);
+
+    // Frame 65 fills no gap at the window start
+    rx->receive(ctx, 65);
+    ASSERT_EQ(sink->seqs.size(), 2);
+    ASSERT_EQ(reordered(), 1);
+}
+
+TEST_F(RdmaReorderTest, Starved)
+{
+    rx->receive(ctx, 0);
+
+    // Every receive buffer is held by the window while frame 1 is missing,
+    // so frame 1 is skipped without waiting for the timeout.
+    for (uint64_t seq = 2; seq < 2 + ReorderRdmaRx::QUEUE - 1; seq++)
+        rx->receive(ctx, seq);
+    ASSERT_EQ(sink->seqs.size(), 1);
+
+    rx->receive(ctx, 2 + ReorderRdmaRx::QUEUE - 1);
+
+    ASSERT_EQ(sink->seqs.size(), 1 + ReorderRdmaRx::QUEUE);
+    ASSERT_EQ(sink->seqs[1], 2);
+    ASSERT_EQ(skipped(), 1);
+}
+
+TEST_F(RdmaReorderTest, SequenceRestart)
+{
+    rx->receive(ctx, 1000);
+    rx->receive(ctx, 1001);
+    rx->receive(ctx, 1003);
+
+    // The transmitter restarted its sequence. The frame waiting in the
+    // window is delivered, and the window follows the new sequence.
+    rx->receive(ctx, 5);
+    rx->receive(ctx, 6);
+
+    ASSERT_EQ(sink->seqs, (std::vector<uint64_t>{ 1000, 1001, 1003, 5, 6 }));
+    ASSERT_EQ(late(), 0);
+}
@@ -3,7 +3,13 @@
 #include "libfabric_ep.h"
 #include "libfabric_dev.h"
 #include "mesh/conn_rdma.h"
+#include "mesh/conn_rdma_progress.h"
+#include "mesh/conn_rdma_srx.h"
+#include "mesh/proxy_config.h"
 #include "conn_rdma_test_mocks.h"
+#include <chrono>
+#include <functional>
+#include <thread>
 
 using namespace testing;
 using namespace mesh;
@@ -27,12 +33,18 @@ class TestRdma : public Rdma {
     using Rdma::consume_from_queue;
     using Rdma::ep_cfg;
     using Rdma::ep_ctxs;
+    using Rdma::ep_type;
+    using Rdma::flow_control;
+    using Rdma::flow_credits;
     using Rdma::init;
     using Rdma::init_queue_with_elements;
     using Rdma::m_dev_handle;
+    using Rdma::max_latency_ns;
     using Rdma::on_delete;
     using Rdma::on_establish;
     using Rdma::on_shutdown;
+    using Rdma::rails;
+    using Rdma::rdma_num_eps;
     using Rdma::trx_sz;
     void set_kind(Kind kind) { _kind = kind; }
 
@@ -92,6 +104,104 @@ TEST_F(RdmaTest, ConfigureSuccess)
     ASSERT_EQ(rdma->kind(), Kind::receiver);
 }
 
+TEST_F(RdmaTest, ConfigureMultiRail)
+{
+    mcm_conn_param request = {};
+    request.local_addr = {.ip = "192.168.1.10", .port = "8001"};
+    request.remote_addr = {.ip = "192.168.1.20", .port = "8002"};
+    request.payload_args.rdma_args.transfer_size = 1024;
+    request.payload_args.rdma_args.queue_size = 32;
+    request.payload_args.rdma_args.num_endpoints = 1;
+
+    RdmaOptions options;
+    options.local_ips = "192.168.1.10,192.168.2.10,192.168.3.10";
+    options.remote_ips = "192.168.1.20,192.168.2.20";
+
+    libfabric_ctx *dev_handle = nullptr;
+
+    rdma->set_kind(Kind::transmitter);
+    auto res = rdma->configure(ctx, request, dev_handle, options);
+    ASSERT_EQ(res, Result::success);
+
+    // One rail per pair of addresses, and at least one endpoint per rail
+    ASSERT_EQ(rdma->rails.size(), 2u);
+    ASSERT_EQ(rdma->rdma_num_eps, 2u);
+    EXPECT_STREQ(rdma->rails[1].local_addr.ip, "192.168.2.10");
+    EXPECT_STREQ(rdma->rails[1].remote_addr.ip, "192.168.2.20");
+    EXPECT_STREQ(rdma->rails[1].remote_addr.port, "8002");
+    EXPECT_STREQ(rdma->ep_cfg.local_addr.ip, "192.168.1.10");
+    EXPECT_STREQ(rdma->ep_cfg.remote_addr.ip, "192.168.1.20");
+}
+
+TEST_F(RdmaTest, ConfigureFlowControl)
+{
+    mcm_conn_param request = {};
+    request.local_addr = {.ip = "192.168.1.10", .port = "8001"};
+    request.remote_addr = {.ip = "192.168.1.20", .port = "8002"};
+    request.payload_args.rdma_args.transfer_size = 1024;
+    request.payload_args.rdma_args.queue_size = 32;
+
+    RdmaOptions options;
+    options.flow_control = RDMA_FLOW_DROP_OLDEST;
+
+    libfabric_ctx *dev_handle = nullptr;
+
+    rdma->set_kind(Kind::transmitter);
+    ASSERT_EQ(rdma->configure(ctx, request, dev_handle, options), Result::success);
+    EXPECT_EQ(rdma->flow_control, RDMA_FLOW_DROP_OLDEST);
+    EXPECT_TRUE(rdma->flow_credits());
+
+    // An unknown policy falls back to none, which needs no credits
+    TestRdma other;
+    options.flow_control = static_cast<mcm_rdma_flow_control>(42);
+    other.set_kind(Kind::transmitter);
+    ASSERT_EQ(other.configure(ctx, request, dev_handle, options), Result::success);
+    EXPECT_EQ(other.flow_control, RDMA_FLOW_NONE);
+    EXPECT_FALSE(other.flow_credits());
+}
+
+TEST_F(RdmaTest, ConfigureConnectionMode)
+{
+    mcm_conn_param request = {};
+    request.local_addr = {.ip = "192.168.1.10", .port = "8001"};
+    request.remote_addr = {.ip = "192.168.1.20", .port = "8002"};
+    request.payload_args.rdma_args.transfer_size = 1024;
+    request.payload_args.rdma_args.queue_size = 32;
+    request.payload_args.rdma_args.provider = const_cast<char *>("tcp");
+
+    RdmaOptions options;
+    options.ep_type = RDMA_EP_UNRELIABLE;
+    options.max_latency_ns = 50000;
+
+    libfabric_ctx *dev_handle = nullptr;
+
+    rdma->set_kind(Kind::transmitter);
+    ASSERT_EQ(rdma->configure(ctx, request, dev_handle, options), Result::success);
+    EXPECT_EQ(rdma->ep_type, RDMA_EP_UNRELIABLE);
+    EXPECT_EQ(rdma->max_latency_ns, 50000u);
+
+    // The verbs provider has no datagram endpoints, and is the default
+    TestRdma verbs;
+    request.payload_args.rdma_args.provider = const_cast<char *>("verbs");
+    verbs.set_kind(Kind::transmitter);
+    EXPECT_EQ(verbs.configure(ctx, request, dev_handle, options),
+              Result::error_conn_config_invalid);
+
+    TestRdma unset;
+    request.payload_args.rdma_args.provider = nullptr;
+    unset.set_kind(Kind::receiver);
+    EXPECT_EQ(unset.configure(ctx, request, dev_handle, options),
+              Result::error_conn_config_invalid);
+    request.payload_args.rdma_args.provider = const_cast<char *>("tcp");
+
+    // Datagrams can't carry the write transport
+    TestRdma other;
+    options.rma_write = true;
+    other.set_kind(Kind::transmitter);
+    EXPECT_EQ(other.configure(ctx, request, dev_handle, options),
+              Result::error_conn_config_invalid);
+}
+
 TEST_F(RdmaTest, EstablishSuccess) {
 
     ConfigureRdma(rdma, ctx, 1024, Kind::receiver);
@@ -586,3 +696,133 @@ TEST_F(RdmaTest, ConcurrentAccessWithDelays) {
     ASSERT_TRUE(rdma->is_buffer_queue_empty());
 }
 
+
+TEST(RdmaSharedRxTest, SizeClass)
+{
+    // Small frames take a page
+    ASSERT_EQ(RdmaSharedRx::size_class(1), PAGE_SIZE);
+    ASSERT_EQ(RdmaSharedRx::size_class(PAGE_SIZE), PAGE_SIZE);
+
+    // Frames of the same class share it
+    ASSERT_EQ(RdmaSharedRx::size_class(1000 * 1000), 1024 * 1024);
+    ASSERT_EQ(RdmaSharedRx::size_class(1024 * 1024), 1024 * 1024);
+    ASSERT_EQ(RdmaSharedRx::size_class(1024 * 1024 + 1), 1280 * 1024);
+
+    // A buffer wastes less than a quarter of the frame
+    for (size_t size = PAGE_SIZE; size < (64 << 20); size = size * 3 / 2 + 123) {
+        size_t cls = RdmaSharedRx::size_class(size);
+        ASSERT_GE(cls, size);
+        ASSERT_LT(cls - size, std::max<size_t>(size / 4, PAGE_SIZE));
+        ASSERT_EQ(cls % PAGE_SIZE, 0);
+    }
+}
+
+// A connection served by the progress engine, counting its polls. A poll
+// can be held to check that a detach waits for it.
+class ProgressRdma : public TestRdma {
+  public:
+    using Rdma::cq_strategy;
+    using Rdma::progress;
+    using Rdma::progress_attach;
+    using Rdma::progress_detach;
+
+    std::atomic<int> polls = 0;
+    std::atomic<bool> hold = false;
+    std::atomic<bool> holding = false;
+
+    int poll(context::Context&) override
+    {
+        polls++;
+        while (hold) {
+            holding = true;
+            std::this_thread::yield();
+        }
+        holding = false;
+        return 0;
+    }
+};
+
+static bool wait_for(const std::function<bool()>& cond)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+
+    while (!cond()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return true;
+}
+
+class RdmaProgressTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        saved_progress_engine = config::proxy.rdma.progress_engine;
+        config::proxy.rdma.progress_engine = true;
+    }
+
+    void TearDown() override
+    {
+        config::proxy.rdma.progress_engine = saved_progress_engine;
+    }
+
+    bool saved_progress_engine;
+};
+
+TEST_F(RdmaProgressTest, AttachDetach)
+{
+    ProgressRdma a, b;
+
+    // Connections asking for busy-poll keep their own threads
+    a.cq_strategy = RDMA_CQ_BUSY_POLL;
+    ASSERT_FALSE(a.progress_attach());
+    ASSERT_EQ(a.progress, nullptr);
+    a.cq_strategy = RDMA_CQ_HYBRID;
+
+    ASSERT_TRUE(a.progress_attach());
+    ASSERT_TRUE(b.progress_attach());
+    ASSERT_NE(a.progress, nullptr);
+    ASSERT_NE(b.progress, nullptr);
+
+    ASSERT_TRUE(wait_for([&]() { return a.polls > 0 && b.polls > 0; }));
+
+    // A detached connection is not polled anymore, the others still are
+    a.progress_detach();
+    ASSERT_EQ(a.progress, nullptr);
+
+    int a_polls = a.polls;
+    int b_polls = b.polls;
+    ASSERT_TRUE(wait_for([&]() { return b.polls > b_polls + 10; }));
+    ASSERT_EQ(a.polls, a_polls);
+
+    b.progress_detach();
+    ASSERT_EQ(b.progress, nullptr);
+}
+
+TEST_F(RdmaProgressTest, DetachWaitsForPoll)
+{
+    ProgressRdma conn;
+
+    conn.hold = true;
+    ASSERT_TRUE(conn.progress_attach());
+    ASSERT_TRUE(wait_for([&]() { return conn.holding.load(); }));
+
+    std::atomic<bool> detached = false;
+    std::thread th([&]() {
+        conn.progress_detach();
+        detached = true;
+    });
+
+    // The worker is polling the connection, so the detach must wait
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(detached);
+
+    conn.hold = false;
+    th.join();
+    ASSERT_TRUE(detached);
+
+    int polls = conn.polls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(conn.polls, polls);
+}
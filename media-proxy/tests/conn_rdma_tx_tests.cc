@@ -5,6 +5,7 @@
 #include "libfabric_ep.h"
 #include "libfabric_dev.h"
 #include "conn_rdma_test_mocks.h"
+#include <cerrno>
 #include <cstring>
 #include <atomic>
 #include <chrono>
@@ -133,7 +134,7 @@ class RdmaTxTest : public ::testing::Test {
 
 TEST_F(RdmaTxTest, EstablishSuccess)
 {
-    libfabric_ctx mock_dev_handle; // Mocked device handle
+    libfabric_ctx mock_dev_handle = {}; // Mocked device handle
 
     EXPECT_CALL(*mock_dev_ops, rdma_init(::testing::_))
         .WillOnce(::testing::DoAll(::testing::SetArgPointee<0>(&mock_dev_handle),
@@ -220,7 +221,7 @@ TEST_F(RdmaTxTest, EstablishFailureBufferAllocation)
 }
 
 TEST_F(RdmaTxTest, EstablishAlreadyInitialized) {
-    libfabric_ctx mock_dev_handle;
+    libfabric_ctx mock_dev_handle = {};
 
     // Mock RDMA initialization
     EXPECT_CALL(*mock_dev_ops, rdma_init(::testing::_))
@@ -322,4 +323,379 @@ TEST_F(RdmaTxTest, ValidateStateTransitions)
     res = conn_tx->shutdown(ctx);
     ASSERT_EQ(res, connection::Result::success);
     ASSERT_EQ(conn_tx->state(), connection::State::closed);
-}
\ No newline at end of file
+}
+
+// A transmitter of the write transport with a buffer block and two
+// endpoints but no device, to check how frames are split into chunks.
+class SegmentRdmaTx : public connection::RdmaTx {
+  public:
+    using RdmaTx::ep_outstanding;
+    using RdmaTx::ring;
+    using RdmaTx::segment_size;
+    using RdmaTx::send_ep;
+    using RdmaTx::write_complete;
+    using RdmaTx::write_frames;
+    using RdmaTx::write_segments;
+    using RdmaTx::WRITE_MAX_CHUNKS;
+    using RdmaTx::WRITE_SKIP;
+    using RdmaTx::WRITE_SLOT_BITS;
+    using RdmaTx::WRITE_SLOT_MASK;
+
+    static constexpr uint32_t QUEUE = 4;
+    static constexpr uint32_t SLOT = 4096;
+    static constexpr uint32_t EPS = 2;
+
+    SegmentRdmaTx() : block(QUEUE * SLOT)
+    {
+        queue_size = QUEUE;
+        send_slot_size = SLOT;
+        buffer_block = block.data();
+        for (uint32_t i = 0; i < EPS; i++) {
+            eps[i].data_desc = reinterpret_cast<void *>(0x10 + i);
+            ep_ctxs.push_back(&eps[i]);
+            ring.keys[i] = 100 + i;
+        }
+        ep_outstanding = std::make_unique<std::atomic<uint32_t>[]>(EPS);
+        send_ep = std::make_unique<std::atomic<uint8_t>[]>(QUEUE);
+        write_frames = std::make_unique<WriteFrame[]>(QUEUE);
+    }
+
+    ~SegmentRdmaTx()
+    {
+        buffer_block = nullptr;
+        ep_ctxs.clear();
+    }
+
+    connection::Result start_threads(context::Context&) override
+    {
+        return connection::Result::success;
+    }
+
+    char *buf(uint32_t slot) { return block.data() + slot * SLOT; }
+
+    std::vector<char> block;
+    ep_ctx_t eps[EPS] = {};
+};
+
+struct ChunkWrite {
+    ep_ctx_t *ep;
+    size_t len;
+    size_t iov_count;
+    void *desc;
+    uint64_t data;
+    uint64_t addr;
+    uint64_t key;
+    void *ctx;
+};
+
+static std::vector<ChunkWrite> chunk_writes;
+static std::vector<ChunkWrite> tombstones;
+static int chunk_write_fail = -1; // Index of the write that fails, or -1
+
+class RdmaSegmentTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        chunk_writes.clear();
+        tombstones.clear();
+        chunk_write_fail = -1;
+
+        saved_inject_writedata = libfabric_ep_ops.ep_inject_writedata;
+        libfabric_ep_ops.ep_inject_writedata = [](ep_ctx_t *ep, const void *buf, size_t len,
+                                                  uint64_t data, uint64_t addr,
+                                                  uint64_t key) -> int {
+            tombstones.push_back({ ep, len, 0, nullptr, data, addr, key, nullptr });
+            return 0;
+        };
+
+        saved_writedata = libfabric_ep_ops.ep_writedata;
+        libfabric_ep_ops.ep_writedata = [](ep_ctx_t *ep, const struct iovec *iov, void **desc,
+                                           size_t count, uint64_t data, uint64_t addr,
+                                           uint64_t key, void *ctx) -> int {
+            if ((int)chunk_writes.size() == chunk_write_fail)
+                return -EIO;
+
+            size_t len = 0;
+            for (size_t i = 0; i < count; i++)
+                len += iov[i].iov_len;
+
+            chunk_writes.push_back({ ep, len, count, desc[0], data, addr, key, ctx });
+            return 0;
+        };
+
+        tx.ring.addr = ADDR;
+        tx.ring.slot_size = RING_SLOT_SIZE;
+
+        // The trailer in the registered buffer, then the payload outside
+        iov[0] = { .iov_base = tx.buf(SLOT), .iov_len = 8 };
+        iov[1] = { .iov_base = payload.data(), .iov_len = payload.size() };
+    }
+
+    void TearDown() override
+    {
+        libfabric_ep_ops.ep_writedata = saved_writedata;
+        libfabric_ep_ops.ep_inject_writedata = saved_inject_writedata;
+    }
+
+    static constexpr uint32_t SLOT = 1;       // Buffer slot of the frame
+    static constexpr uint32_t RING_SLOT = 5;  // Slot of the receiver ring
+    static constexpr uint64_t ADDR = 0x100000;
+    static constexpr uint32_t RING_SLOT_SIZE = 0x10000;
+
+    decltype(libfabric_ep_ops.ep_writedata) saved_writedata;
+    decltype(libfabric_ep_ops.ep_inject_writedata) saved_inject_writedata;
+    SegmentRdmaTx tx;
+    std::vector<char> payload = std::vector<char>(3000);
+    struct iovec iov[2];
+};
+
+TEST_F(RdmaSegmentTest, WholeFrame)
+{
+    tx.segment_size = 0;
+
+    ASSERT_EQ(tx.write_segments(1, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+
+    ASSERT_EQ(chunk_writes.size(), 1);
+    auto& w = chunk_writes[0];
+    ASSERT_EQ(w.ep, &tx.eps[1]);
+    ASSERT_EQ(w.len, 3008);
+    ASSERT_EQ(w.iov_count, 2);
+    ASSERT_EQ(w.data, RING_SLOT);
+    ASSERT_EQ(w.addr, ADDR);
+    ASSERT_EQ(w.key, 101);
+    ASSERT_EQ(w.ctx, tx.buf(SLOT));
+    ASSERT_EQ(tx.write_frames[SLOT].pending.load(), 1);
+}
+
+TEST_F(RdmaSegmentTest, Chunks)
+{
+    tx.segment_size = 1024;
+
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+
+    // Chunk k lands at k * 1024 in the slot, on endpoint k % 2
+    ASSERT_EQ(chunk_writes.size(), 3);
+    size_t lens[] = { 1024, 1024, 960 };
+    for (uint32_t k = 0; k < 3; k++) {
+        auto& w = chunk_writes[k];
+        ASSERT_EQ(w.ep, &tx.eps[k % 2]);
+        ASSERT_EQ(w.key, 100 + k % 2);
+        ASSERT_EQ(w.len, lens[k]);
+        ASSERT_EQ(w.addr, ADDR + k * 1024);
+        ASSERT_EQ(w.ctx, tx.buf(SLOT) + k);
+
+        // The immediate data carries the ring slot and the number of chunks
+        ASSERT_EQ(w.data, RING_SLOT | (3u << SegmentRdmaTx::WRITE_SLOT_BITS));
+        ASSERT_EQ(w.data & SegmentRdmaTx::WRITE_SLOT_MASK, RING_SLOT);
+        ASSERT_EQ(w.data >> SegmentRdmaTx::WRITE_SLOT_BITS, 3);
+    }
+
+    // The first chunk gathers the trailer and the start of the payload
+    ASSERT_EQ(chunk_writes[0].iov_count, 2);
+    ASSERT_EQ(chunk_writes[0].desc, tx.eps[0].data_desc);
+    ASSERT_EQ(chunk_writes[1].iov_count, 1);
+    ASSERT_EQ(chunk_writes[1].desc, nullptr);
+
+    // The first chunk is accounted for by the caller
+    ASSERT_EQ(tx.write_frames[SLOT].pending.load(), 3);
+    ASSERT_EQ(tx.ep_outstanding[0].load(), 1);
+    ASSERT_EQ(tx.ep_outstanding[1].load(), 1);
+}
+
+TEST_F(RdmaSegmentTest, ChunkLimit)
+{
+    // Chunks grow past the segment size to fit the immediate data
+    tx.segment_size = 1;
+    payload.resize(20000);
+    iov[1].iov_len = payload.size();
+
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+
+    size_t chunks = chunk_writes.size();
+    ASSERT_LE(chunks, SegmentRdmaTx::WRITE_MAX_CHUNKS);
+    ASSERT_EQ(chunks, (20008 + 4) / 5);
+
+    size_t total = 0;
+    for (size_t k = 0; k < chunks; k++) {
+        ASSERT_EQ(chunk_writes[k].addr, ADDR + total);
+        ASSERT_EQ(chunk_writes[k].data >> SegmentRdmaTx::WRITE_SLOT_BITS, chunks);
+        total += chunk_writes[k].len;
+    }
+    ASSERT_EQ(total, 20008);
+    ASSERT_EQ(tx.write_frames[SLOT].pending.load(), chunks);
+}
+
+TEST_F(RdmaSegmentTest, ChunkFailure)
+{
+    tx.segment_size = 1024;
+
+    // The frame is lost, the chunk posted still completes
+    chunk_write_fail = 1;
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+    ASSERT_EQ(chunk_writes.size(), 1);
+    ASSERT_EQ(tx.write_frames[SLOT].pending.load(), 1);
+    ASSERT_EQ(tx.ep_outstanding[1].load(), 0);
+    ASSERT_TRUE(tombstones.empty());
+
+    // It leaves a tombstone telling the receiver the slot sees it and itself
+    ASSERT_EQ(tx.write_complete(chunk_writes[0].ctx), tx.buf(SLOT));
+    ASSERT_EQ(tombstones.size(), 1);
+    auto& t = tombstones[0];
+    ASSERT_EQ(t.ep, &tx.eps[1]);
+    ASSERT_EQ(t.len, 0);
+    ASSERT_EQ(t.data, RING_SLOT | SegmentRdmaTx::WRITE_SKIP |
+                      (2u << SegmentRdmaTx::WRITE_SLOT_BITS));
+    ASSERT_EQ(t.addr, ADDR + RING_SLOT * RING_SLOT_SIZE);
+    ASSERT_EQ(t.key, 101);
+
+    // The error of the first chunk is returned
+    chunk_writes.clear();
+    tombstones.clear();
+    chunk_write_fail = 0;
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), -EIO);
+    ASSERT_TRUE(chunk_writes.empty());
+    ASSERT_TRUE(tombstones.empty());
+}
+
+TEST_F(RdmaSegmentTest, FailedCompletion)
+{
+    tx.segment_size = 1024;
+
+    // A chunk completing in error leaves the tombstone once the others complete
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+    ASSERT_EQ(chunk_writes.size(), 3);
+    ASSERT_EQ(tx.write_complete(chunk_writes[1].ctx, true), nullptr);
+    ASSERT_EQ(tx.write_complete(chunk_writes[0].ctx), nullptr);
+    ASSERT_TRUE(tombstones.empty());
+    ASSERT_EQ(tx.write_complete(chunk_writes[2].ctx), tx.buf(SLOT));
+    ASSERT_EQ(tombstones.size(), 1);
+    ASSERT_EQ(tombstones[0].data, RING_SLOT | SegmentRdmaTx::WRITE_SKIP |
+                                  (3u << SegmentRdmaTx::WRITE_SLOT_BITS));
+
+    // A whole frame written in error costs its slot only
+    chunk_writes.clear();
+    tombstones.clear();
+    tx.segment_size = 0;
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+    ASSERT_EQ(tx.write_complete(chunk_writes[0].ctx, true), tx.buf(SLOT));
+    ASSERT_EQ(tombstones.size(), 1);
+    ASSERT_EQ(tombstones[0].data, RING_SLOT | SegmentRdmaTx::WRITE_SKIP |
+                                  (1u << SegmentRdmaTx::WRITE_SLOT_BITS));
+
+    // Frames written without errors leave none
+    chunk_writes.clear();
+    tombstones.clear();
+    ASSERT_EQ(tx.write_segments(0, iov, 2, tx.buf(SLOT), nullptr, RING_SLOT, ADDR), 0);
+    ASSERT_EQ(tx.write_complete(chunk_writes[0].ctx), tx.buf(SLOT));
+    ASSERT_TRUE(tombstones.empty());
+}
+
+class ReconnectRdmaTx : public connection::RdmaTx {
+  public:
+    using RdmaTx::acquire_buffer;
+    using RdmaTx::buf_posted;
+    using RdmaTx::link_down;
+    using RdmaTx::reconnect_poll;
+    using RdmaTx::send_buffer;
+
+    static constexpr uint32_t QUEUE = 4;
+    static constexpr size_t FRAME = 1024;
+
+    ReconnectRdmaTx()
+    {
+        queue_size = QUEUE;
+        trx_sz = FRAME;
+        init_queue_with_elements(QUEUE, FRAME + TRAILER);
+        send_slot_size = ring_slot_size();
+        buf_posted = std::make_unique<std::atomic<bool>[]>(QUEUE);
+        ep_outstanding = std::make_unique<std::atomic<uint32_t>[]>(1);
+        send_ep = std::make_unique<std::atomic<uint8_t>[]>(QUEUE);
+
+        domain_attr.mr_mode = 0;
+        info.domain_attr = &domain_attr;
+        dev.info = &info;
+        ep.rdma_ctx = &dev;
+        ep_ctxs.push_back(&ep);
+        ep_cfgs.resize(1);
+    }
+
+    ~ReconnectRdmaTx()
+    {
+        cleanup_queue();
+        ep_ctxs.clear();
+    }
+
+    connection::Result start_threads(context::Context&) override
+    {
+        return connection::Result::success;
+    }
+
+    struct fi_domain_attr domain_attr = {};
+    struct fi_info info = {};
+    libfabric_ctx dev = {};
+    ep_ctx_t ep = {};
+};
+
+static int send_buf_result = 0;
+
+class RdmaReconnectTest : public ::testing::Test {
+  protected:
+    void SetUp() override
+    {
+        send_buf_result = 0;
+
+        saved_send_buf = libfabric_ep_ops.ep_send_buf;
+        saved_reinit = libfabric_ep_ops.ep_reinit;
+        libfabric_ep_ops.ep_send_buf = [](ep_ctx_t *, void *, size_t) -> int {
+            return send_buf_result;
+        };
+        libfabric_ep_ops.ep_reinit = [](ep_ctx_t *, ep_cfg_t *) -> int { return 0; };
+    }
+
+    void TearDown() override
+    {
+        libfabric_ep_ops.ep_send_buf = saved_send_buf;
+        libfabric_ep_ops.ep_reinit = saved_reinit;
+    }
+
+    void send(connection::Result expected)
+    {
+        void *buf = nullptr;
+        uint32_t sent = 0;
+
+        ASSERT_EQ(tx.acquire_buffer(ctx, &buf), connection::Result::success);
+        ASSERT_EQ(tx.send_buffer(ctx, buf, 100, sent), expected);
+    }
+
+    context::Context ctx = context::WithCancel(context::Background());
+    decltype(libfabric_ep_ops.ep_send_buf) saved_send_buf;
+    decltype(libfabric_ep_ops.ep_reinit) saved_reinit;
+    ReconnectRdmaTx tx;
+};
+
+TEST_F(RdmaReconnectTest, SendsInFlightRecycled)
+{
+    send(connection::Result::success);
+    send(connection::Result::success);
+    send(connection::Result::success);
+    ASSERT_EQ(tx.get_buffer_queue_size(), 1);
+
+    // A send that fails to post is not in flight
+    send_buf_result = -EIO;
+    send(connection::Result::error_general_failure);
+    ASSERT_EQ(tx.get_buffer_queue_size(), 1);
+
+    uint32_t posted = 0;
+    for (uint32_t i = 0; i < ReconnectRdmaTx::QUEUE; i++)
+        posted += tx.buf_posted[i].load();
+    ASSERT_EQ(posted, 3);
+
+    // The completions of the old endpoints are lost with the link
+    tx.link_down = true;
+    tx.reconnect_poll();
+
+    ASSERT_FALSE(tx.link_down.load());
+    ASSERT_EQ(tx.get_buffer_queue_size(), ReconnectRdmaTx::QUEUE);
+    for (uint32_t i = 0; i < ReconnectRdmaTx::QUEUE; i++)
+        ASSERT_FALSE(tx.buf_posted[i].load());
+}
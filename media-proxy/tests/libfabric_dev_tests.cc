@@ -186,6 +186,36 @@ TEST_F(LibfabricDevTest, TestRdmaDeinitSuccess) {
     ASSERT_EQ(fi_freeinfo_fake.call_count, 2);
 }
 
+TEST_F(LibfabricDevTest, TestRdmaInitSharesDomain) {
+    auto other = (libfabric_ctx *)calloc(1, sizeof(libfabric_ctx));
+    *other = *ctx;
+
+    ASSERT_EQ(libfabric_dev_ops.rdma_init(&ctx), 0);
+    ASSERT_EQ(libfabric_dev_ops.rdma_init(&other), 0);
+
+    // Contexts resolving to the same domain share it and its registration cache
+    ASSERT_EQ(fi_fabric_fake.call_count, 1);
+    ASSERT_EQ(domain_fake.call_count, 1);
+    ASSERT_EQ(other->domain, ctx->domain);
+    ASSERT_EQ(other->mr_cache, ctx->mr_cache);
+
+    // The domain is closed with the last context
+    custom_close_fake.call_count = 0;
+    ASSERT_EQ(libfabric_dev_ops.rdma_deinit(&ctx), 0);
+    ASSERT_EQ(custom_close_fake.call_count, 0);
+    ASSERT_EQ(libfabric_dev_ops.rdma_deinit(&other), 0);
+    ASSERT_EQ(custom_close_fake.call_count, 2);
+}
+
+TEST_F(LibfabricDevTest, TestRdmaInitUnreliable) {
+    ctx->unreliable = true;
+
+    int ret = libfabric_dev_ops.rdma_init(&ctx);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(ctx->ep_attr_type, FI_EP_DGRAM);
+    ASSERT_EQ(fi_getinfo_fake.call_count, 1);
+}
+
 TEST_F(LibfabricDevTest, TestRdmaInitNullContext) {
     int ret = libfabric_dev_ops.rdma_init(nullptr);
     ASSERT_EQ(ret, -EINVAL);
@@ -8,10 +8,12 @@ extern "C" {
 
 FAKE_VALUE_FUNC(int, av_insert, struct fid_av *, const void *, size_t, fi_addr_t *, uint64_t,
                 void *);
+FAKE_VALUE_FUNC(int, av_remove, struct fid_av *, fi_addr_t *, size_t, uint64_t);
 FAKE_VALUE_FUNC(int, endpoint, struct fid_domain *, struct fi_info *, struct fid_ep **, void *);
 FAKE_VALUE_FUNC(int, av_open, struct fid_domain *, struct fi_av_attr *, struct fid_av **, void *);
 FAKE_VALUE_FUNC(ssize_t, send, struct fid_ep *, const void *, size_t, void *, fi_addr_t, void *);
 FAKE_VALUE_FUNC(ssize_t, recv, struct fid_ep *, void *, size_t, void *, fi_addr_t, void *);
+FAKE_VALUE_FUNC(ssize_t, inject, struct fid_ep *, const void *, size_t, fi_addr_t);
 FAKE_VALUE_FUNC(int, rdma_cq_open_mock, ep_ctx_t *, size_t, enum cq_comp_method);
 FAKE_VALUE_FUNC(int, rdma_read_cq_mock, ep_ctx_t *, struct fi_cq_err_entry *, int);
 FAKE_VALUE_FUNC(int, rdma_cq_readerr_mock, struct fid_cq *);
@@ -25,9 +27,9 @@ class LibfabricEpTest : public ::testing::Test
   protected:
     void SetUp() override
     {
-        ops_msg = {.recv = recv, .send = send};
+        ops_msg = {.recv = recv, .send = send, .inject = inject};
         ops_cq = {.read = cq_read};
-        ops_av = {.insert = av_insert};
+        ops_av = {.insert = av_insert, .remove = av_remove};
         ep_ops = {.close = custom_close, .bind = custom_bind, .control = control};
         av_and_cq_ops = {.close = custom_close};
 
@@ -62,12 +64,14 @@ class LibfabricEpTest : public ::testing::Test
 
         RESET_FAKE(control);
         RESET_FAKE(av_insert);
+        RESET_FAKE(av_remove);
         RESET_FAKE(endpoint);
         RESET_FAKE(av_open);
         RESET_FAKE(fi_getinfo);
         RESET_FAKE(fi_freeinfo);
         RESET_FAKE(send);
         RESET_FAKE(recv);
+        RESET_FAKE(inject);
         RESET_FAKE(cq_read);
         RESET_FAKE(rdma_cq_open_mock);
         RESET_FAKE(rdma_read_cq_mock);
@@ -220,6 +224,37 @@ TEST_F(LibfabricEpTest, TestEpSendBufRetryFail)
 }
 
 
+TEST_F(LibfabricEpTest, TestEpInjectSuccess)
+{
+    inject_fake.return_val = 0;
+
+    char dummy_buf[10] = {0};
+    size_t buf_size = sizeof(dummy_buf);
+
+    int ret = libfabric_ep_ops.ep_inject(&ep_ctx, dummy_buf, buf_size);
+
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(inject_fake.call_count, 1);
+    ASSERT_EQ(send_fake.call_count, 0);
+    ASSERT_EQ(cq_read_fake.call_count, 0);
+}
+
+TEST_F(LibfabricEpTest, TestEpInjectRetrySuccess)
+{
+    ssize_t inject_fake_return_vals[] = {-FI_EAGAIN, 0};
+    SET_RETURN_SEQ(inject, inject_fake_return_vals,
+                   sizeof(inject_fake_return_vals) / sizeof(inject_fake_return_vals[0]));
+
+    char dummy_buf[10] = {0};
+    size_t buf_size = sizeof(dummy_buf);
+
+    int ret = libfabric_ep_ops.ep_inject(&ep_ctx, dummy_buf, buf_size);
+
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(inject_fake.call_count, 2);
+    ASSERT_EQ(cq_read_fake.call_count, 1);
+}
+
 TEST_F(LibfabricEpTest, TestEpRecvBufFail)
 {
     recv_fake.return_val = -1;
@@ -295,6 +330,36 @@ TEST_F(LibfabricEpTest, TestEpInitSuccessRX)
     ASSERT_EQ(custom_close_fake.call_count, 0);
 }
 
+TEST_F(LibfabricEpTest, TestEpInitSharedRx)
+{
+    fi_getinfo_fake.custom_fake = fi_getinfo_custom_fake;
+    endpoint_fake.custom_fake = endpoint_custom_fake;
+    rdma_cq_open_mock_fake.custom_fake = rdma_cq_open_custom_fake;
+    av_open_fake.custom_fake = av_open_custom_fake;
+    control_fake.return_val = 0;
+    custom_bind_fake.return_val = 0;
+
+    struct fid_ep srx = {};
+    ep_cfg_t cfg = {.rdma_ctx = &rdma_ctx,
+                    .remote_addr = {.ip = "127.0.0.1", .port = "12345"},
+                    .local_addr = {.port = "12345"},
+                    .dir = RX,
+                    .srx = &srx};
+    ep_ctx_t *ep_ctx_ptr = nullptr;
+
+    int ret = libfabric_ep_ops.ep_init(&ep_ctx_ptr, &cfg);
+
+    ASSERT_EQ(ret, 0);
+    ASSERT_NE(ep_ctx_ptr, nullptr);
+    ASSERT_EQ(ep_ctx_ptr->srx, &srx);
+    ASSERT_EQ(custom_bind_fake.call_count, 3); // AV, SRX, CQ
+    ASSERT_EQ(control_fake.call_count, 1);
+
+    // The shared receive context belongs to the caller
+    ASSERT_EQ(libfabric_ep_ops.ep_destroy(&ep_ctx_ptr), 0);
+    ASSERT_EQ(custom_close_fake.call_count, 3); // ep, cq, av
+}
+
 TEST_F(LibfabricEpTest, TestEpInitSuccessTX)
 {
 
@@ -738,6 +803,82 @@ TEST_F(LibfabricEpTest, TestEpCqReadWithContext)
     ASSERT_EQ(rdma_read_cq_mock_fake.call_count, 1);
 }
 
+TEST_F(LibfabricEpTest, TestEpReinitSuccessTX)
+{
+    endpoint_fake.custom_fake = endpoint_custom_fake;
+    av_open_fake.custom_fake = av_open_custom_fake;
+    control_fake.return_val = 0;
+    custom_bind_fake.return_val = 0;
+    av_insert_fake.return_val = 1;
+
+    ep_cfg_t cfg = {.rdma_ctx = &rdma_ctx, .dir = TX};
+    ep_ctx.stop_flag = true;
+
+    int ret = libfabric_ep_ops.ep_reinit(&ep_ctx, &cfg);
+
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(ep_ctx.ep, &ep);
+    ASSERT_EQ(ep_ctx.av, &av);
+    ASSERT_EQ(ep_ctx.cq_ctx.cq, &cq);
+    ASSERT_FALSE(ep_ctx.stop_flag);
+    ASSERT_EQ(custom_close_fake.call_count, 2); // old ep, old av
+    ASSERT_EQ(endpoint_fake.call_count, 1);
+    ASSERT_EQ(av_open_fake.call_count, 1);
+    ASSERT_EQ(custom_bind_fake.call_count, 2);
+    ASSERT_EQ(control_fake.call_count, 1);
+    ASSERT_EQ(av_insert_fake.call_count, 1);
+}
+
+TEST_F(LibfabricEpTest, TestEpReinitEndpointFail)
+{
+    endpoint_fake.return_val = -FI_ENOMEM;
+
+    ep_cfg_t cfg = {.rdma_ctx = &rdma_ctx, .dir = TX};
+
+    int ret = libfabric_ep_ops.ep_reinit(&ep_ctx, &cfg);
+
+    ASSERT_EQ(ret, -FI_ENOMEM);
+    ASSERT_EQ(ep_ctx.ep, nullptr);
+    ASSERT_EQ(ep_ctx.av, nullptr);
+    ASSERT_EQ(ep_ctx.dest_av_entry, FI_ADDR_UNSPEC);
+    ASSERT_EQ(custom_close_fake.call_count, 2); // old ep, old av
+    ASSERT_EQ(av_open_fake.call_count, 0);
+    ASSERT_EQ(custom_bind_fake.call_count, 0);
+}
+
+TEST_F(LibfabricEpTest, TestEpSetPeerReplacesDestination)
+{
+    uint8_t addr[16] = {};
+
+    av_insert_fake.custom_fake = [](struct fid_av *, const void *, size_t, fi_addr_t *fi_addr,
+                                    uint64_t, void *) -> int {
+        *fi_addr = 7;
+        return 1;
+    };
+    ep_ctx.dest_av_entry = 3;
+
+    int ret = libfabric_ep_ops.ep_set_peer(&ep_ctx, addr);
+
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(ep_ctx.dest_av_entry, 7);
+    ASSERT_EQ(av_remove_fake.call_count, 1);
+    ASSERT_EQ(av_insert_fake.call_count, 1);
+}
+
+TEST_F(LibfabricEpTest, TestEpSetPeerInsertFail)
+{
+    uint8_t addr[16] = {};
+
+    av_insert_fake.return_val = -FI_EINVAL;
+    ep_ctx.dest_av_entry = FI_ADDR_UNSPEC;
+
+    int ret = libfabric_ep_ops.ep_set_peer(&ep_ctx, addr);
+
+    ASSERT_EQ(ret, -FI_EINVAL);
+    ASSERT_EQ(ep_ctx.dest_av_entry, FI_ADDR_UNSPEC);
+    ASSERT_EQ(av_remove_fake.call_count, 0);
+}
+
 TEST_F(LibfabricEpTest, TestEpDestroySuccess)
 {
     ep_ctx_t *ep_ctx_ptr = (ep_ctx_t *)malloc(sizeof(ep_ctx_t));
@@ -41,9 +41,30 @@ protected:
         *mr = &LibfabricMrTest::f_mr;
         return 0;
     }
+
+    // Hands out a distinct region per registration, as a provider would
+    static struct fid_mr cache_mrs[80];
+    static struct iovec cache_iov;
+    static uint64_t cache_key;
+    static int cache_mr_count;
+    static int mr_regattr_cache_fake(struct fid *fid, const struct fi_mr_attr *attr,
+                                     uint64_t flags, struct fid_mr **mr)
+    {
+        struct fid_mr *m = &cache_mrs[cache_mr_count++];
+        *m = f_mr;
+        m->fid.context = attr->context;
+        cache_iov = attr->mr_iov[0];
+        cache_key = attr->requested_key;
+        *mr = m;
+        return 0;
+    }
 };
 
 struct fid_mr LibfabricMrTest::f_mr;
+struct fid_mr LibfabricMrTest::cache_mrs[80];
+struct iovec LibfabricMrTest::cache_iov;
+uint64_t LibfabricMrTest::cache_key;
+int LibfabricMrTest::cache_mr_count;
 
 TEST_F(LibfabricMrTest, TestRdmaRegMrSuccess) {
     struct fid_mr *mr = nullptr;
@@ -163,3 +184,112 @@ TEST_F(LibfabricMrTest, TestRdmaInfoToMrAccessFiContext) {
     ASSERT_EQ(access, 0);
 }
 
+TEST_F(LibfabricMrTest, TestMrCacheHit) {
+    struct fid_mr *mr1 = nullptr, *mr2 = nullptr;
+    char *buf = reinterpret_cast<char *>(0x100000);
+    mr_regattr_fake.custom_fake = mr_regattr_cache_fake;
+    cache_mr_count = 0;
+    ASSERT_EQ(rdma_mr_cache_create(&rdma_ctx.mr_cache), 0);
+
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf, 8192, 0, 0x1234,
+                                           FI_HMEM_SYSTEM, 0, &mr1, nullptr), 0);
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf + 4096, 4096, 0, 0,
+                                           FI_HMEM_SYSTEM, 0, &mr2, nullptr), 0);
+
+    // The registration keeps the key requested by its caller
+    ASSERT_EQ(mr_regattr_fake.call_count, 1);
+    ASSERT_EQ(cache_key, 0x1234u);
+    ASSERT_EQ(mr1, mr2);
+
+    libfabric_mr_ops.rdma_unreg_mr(mr1);
+    libfabric_mr_ops.rdma_unreg_mr(mr2);
+    ASSERT_EQ(custom_close_fake.call_count, 0);
+
+    rdma_mr_cache_destroy(&rdma_ctx.mr_cache);
+    ASSERT_EQ(custom_close_fake.call_count, 1);
+    ASSERT_EQ(rdma_ctx.mr_cache, nullptr);
+}
+
+TEST_F(LibfabricMrTest, TestMrCacheOverlapWidens) {
+    struct fid_mr *mr1 = nullptr, *mr2 = nullptr, *mr3 = nullptr;
+    char *buf = reinterpret_cast<char *>(0x100000);
+    mr_regattr_fake.custom_fake = mr_regattr_cache_fake;
+    cache_mr_count = 0;
+    ASSERT_EQ(rdma_mr_cache_create(&rdma_ctx.mr_cache), 0);
+
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf, 4096, 0, 0, FI_HMEM_SYSTEM, 0,
+                                           &mr1, nullptr), 0);
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf + 2048, 6144, 0, 0,
+                                           FI_HMEM_SYSTEM, 0, &mr2, nullptr), 0);
+
+    // The second registration covers both ranges
+    ASSERT_EQ(mr_regattr_fake.call_count, 2);
+    ASSERT_EQ(cache_iov.iov_base, buf);
+    ASSERT_EQ(cache_iov.iov_len, 8192u);
+
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf, 4096, 0, 0, FI_HMEM_SYSTEM, 0,
+                                           &mr3, nullptr), 0);
+    ASSERT_EQ(mr_regattr_fake.call_count, 2);
+    ASSERT_EQ(mr3, mr2);
+
+    // The retired registration is closed on its last release
+    libfabric_mr_ops.rdma_unreg_mr(mr1);
+    ASSERT_EQ(custom_close_fake.call_count, 1);
+
+    libfabric_mr_ops.rdma_unreg_mr(mr2);
+    libfabric_mr_ops.rdma_unreg_mr(mr3);
+    rdma_mr_cache_destroy(&rdma_ctx.mr_cache);
+    ASSERT_EQ(custom_close_fake.call_count, 2);
+}
+
+TEST_F(LibfabricMrTest, TestMrCacheInvalidate) {
+    struct fid_mr *mr = nullptr;
+    char *buf = reinterpret_cast<char *>(0x100000);
+    mr_regattr_fake.custom_fake = mr_regattr_cache_fake;
+    cache_mr_count = 0;
+    ASSERT_EQ(rdma_mr_cache_create(&rdma_ctx.mr_cache), 0);
+
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf, 4096, 0, 0, FI_HMEM_SYSTEM, 0,
+                                           &mr, nullptr), 0);
+    libfabric_mr_ops.rdma_unreg_mr(mr);
+    ASSERT_EQ(custom_close_fake.call_count, 0);
+
+    libfabric_mr_ops.rdma_mr_cache_invalidate(&rdma_ctx, buf + 1024, 1024);
+    ASSERT_EQ(custom_close_fake.call_count, 1);
+
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf, 4096, 0, 0, FI_HMEM_SYSTEM, 0,
+                                           &mr, nullptr), 0);
+    ASSERT_EQ(mr_regattr_fake.call_count, 2);
+
+    libfabric_mr_ops.rdma_unreg_mr(mr);
+    rdma_mr_cache_destroy(&rdma_ctx.mr_cache);
+}
+
+TEST_F(LibfabricMrTest, TestMrCacheLruEviction) {
+    struct fid_mr *mr = nullptr;
+    char *buf = reinterpret_cast<char *>(0x100000);
+    mr_regattr_fake.custom_fake = mr_regattr_cache_fake;
+    cache_mr_count = 0;
+    ASSERT_EQ(rdma_mr_cache_create(&rdma_ctx.mr_cache), 0);
+
+    for (int i = 0; i < 65; i++) {
+        ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf + i * 8192, 4096, 0, 0,
+                                               FI_HMEM_SYSTEM, 0, &mr, nullptr), 0);
+        libfabric_mr_ops.rdma_unreg_mr(mr);
+    }
+
+    // Only the least recently used idle registration is closed
+    ASSERT_EQ(custom_close_fake.call_count, 1);
+
+    struct fid_mr *mr_hit = nullptr, *mr_evicted = nullptr;
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf + 8192, 4096, 0, 0,
+                                           FI_HMEM_SYSTEM, 0, &mr_hit, nullptr), 0);
+    ASSERT_EQ(mr_regattr_fake.call_count, 65);
+    ASSERT_EQ(libfabric_mr_ops.rdma_reg_mr(&rdma_ctx, nullptr, buf, 4096, 0, 0, FI_HMEM_SYSTEM, 0,
+                                           &mr_evicted, nullptr), 0);
+    ASSERT_EQ(mr_regattr_fake.call_count, 66);
+
+    libfabric_mr_ops.rdma_unreg_mr(mr_hit);
+    libfabric_mr_ops.rdma_unreg_mr(mr_evicted);
+    rdma_mr_cache_destroy(&rdma_ctx.mr_cache);
+}
@@ -5,7 +5,14 @@
  */
 
 #include <gtest/gtest.h>
+#include <vector>
 #include "mesh/sync.h"
+#include "mesh/conn_local_relay.h"
+#include "mesh/buf.h"
+#include "mesh/multipoint.h"
+#include "mesh/proxy_config.h"
+#include "mesh/metrics.h"
+#include "mesh/mem_region.h"
 
 TEST(mesh_test, DataplaneAtomicPtr) {
     mesh::sync::DataplaneAtomicPtr ptr;
@@ -49,3 +56,700 @@ TEST(mesh_test, DataplaneAtomicPtr) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
     ASSERT_EQ(ptr.load(), (void *)0x500);
 }
+
+TEST(mesh_test, Epoch) {
+    using mesh::sync::Epoch;
+
+    std::atomic<int> *shared = new std::atomic<int>(1);
+    std::atomic<std::atomic<int> *> ptr = shared;
+    std::atomic<bool> deleted = false;
+    std::atomic<int> entered = 0;
+    std::atomic<bool> stop = false;
+
+    // Multiple concurrent readers hold the old object.
+    std::vector<std::jthread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            Epoch::enter();
+            Epoch::enter(); // nested
+            auto p = ptr.load(std::memory_order_acquire);
+            entered++;
+            while (!stop)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ASSERT_EQ(p->load(), 1);
+            Epoch::leave();
+            Epoch::leave();
+        });
+    }
+    while (entered < 4)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // Retirement does not wait, and the object outlives the readers.
+    auto old = ptr.exchange(nullptr);
+    auto start = std::chrono::steady_clock::now();
+    Epoch::retire([&, old]() { delete old; deleted = true; });
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(5));
+    ASSERT_FALSE(deleted);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Epoch::reclaim();
+    ASSERT_FALSE(deleted);
+
+    stop = true;
+    readers.clear();
+
+    // No readers left, so the grace period ends immediately.
+    start = std::chrono::steady_clock::now();
+    Epoch::synchronize();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(5));
+    ASSERT_TRUE(deleted);
+}
+
+TEST(mesh_test, EpochDomains) {
+    mesh::sync::DataplaneAtomicPtr a, b;
+    std::atomic<bool> entered = false;
+    std::atomic<bool> stop = false;
+    std::atomic<bool> deleted = false;
+
+    // A reader stays in the critical section of one pointer.
+    std::jthread reader([&]() {
+        a.load_next_lock();
+        b.load_next_lock(); // nested across domains
+        b.unlock();
+        entered = true;
+        while (!stop)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        a.unlock();
+    });
+    while (!entered)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // The writers of another pointer do not wait for it.
+    auto start = std::chrono::steady_clock::now();
+    b.store_wait((void *)0x100);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(5));
+
+    // The writers of its own pointer do.
+    a.store((void *)0x200);
+    a.retire([&]() { deleted = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_FALSE(deleted);
+
+    stop = true;
+    reader.join();
+
+    a.synchronize();
+    ASSERT_TRUE(deleted);
+}
+
+TEST(mesh_test, EpochDomainShards) {
+    mesh::sync::DataplaneAtomicPtr ptr;
+    std::atomic<uint32_t> entered = 0;
+    std::atomic<bool> stop = false;
+    std::atomic<bool> deleted = false;
+
+    // More readers than counter shards, the last ones share the overflow shard.
+    std::vector<std::jthread> readers;
+    for (uint32_t i = 0; i < mesh::telemetry::counter_shards_max + 4; i++)
+        readers.emplace_back([&]() {
+            ptr.load_next_lock();
+            entered++;
+            while (!stop)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ptr.unlock();
+        });
+    while (entered < readers.size())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    ptr.store((void *)0x100);
+    ptr.retire([&]() { deleted = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_FALSE(deleted);
+
+    stop = true;
+    readers.clear();
+
+    ptr.synchronize();
+    ASSERT_TRUE(deleted);
+}
+
+TEST(mesh_test, Ring) {
+    using namespace mesh;
+
+    sync::Ring ring(3);
+    ASSERT_EQ(ring.capacity(), 4);
+
+    int v[5];
+    for (int i = 0; i < 4; i++)
+        ASSERT_TRUE(ring.push(&v[i]));
+    ASSERT_FALSE(ring.push(&v[4]));
+    ASSERT_EQ(ring.size(), 4);
+
+    // FIFO order.
+    void *ptr;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(ring.pop(ptr));
+        ASSERT_EQ(ptr, &v[i]);
+    }
+    ASSERT_FALSE(ring.pop(ptr));
+    ASSERT_TRUE(ring.empty());
+
+    auto ctx = context::WithCancel(context::Background());
+
+    // Timeout.
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(ring.pop_wait(ctx, ptr, std::chrono::milliseconds(20)));
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+    // A blocked consumer is woken up by a push.
+    std::jthread producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ring.push(&v[0]);
+    });
+    ASSERT_TRUE(ring.pop_wait(ctx, ptr));
+    ASSERT_EQ(ptr, &v[0]);
+    producer.join();
+
+    // A blocked consumer is woken up by cancellation.
+    std::jthread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ctx.cancel();
+    });
+    ASSERT_FALSE(ring.pop_wait(ctx, ptr));
+    canceller.join();
+
+    // Concurrent producers and consumers pass every pointer once.
+    sync::Ring mpmc(64);
+    std::atomic<uint64_t> sum = 0;
+    auto bg = context::WithCancel(context::Background());
+    {
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&]() {
+                for (int j = 0; j < 10000; j++) {
+                    void *p;
+                    if (!mpmc.pop_wait(bg, p))
+                        break;
+                    sum += (uintptr_t)p;
+                }
+            });
+            threads.emplace_back([&]() {
+                for (uintptr_t j = 1; j <= 10000; j++)
+                    while (!mpmc.push((void *)j))
+                        std::this_thread::yield();
+            });
+        }
+    }
+    ASSERT_EQ(sum, 4 * 10000ull * 10001 / 2);
+    ASSERT_TRUE(mpmc.empty());
+}
+
+TEST(mesh_test, ShardedCounters) {
+    using namespace mesh::telemetry;
+
+    ShardedCounters<2> counters;
+    ShardedCounter<2> frames(counters, 0);
+    ShardedCounter<2> bytes(counters, 1);
+
+    // More threads than shards, to exercise the overflow shard.
+    std::vector<std::jthread> threads;
+    for (uint32_t i = 0; i < counter_shards_max + 8; i++) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 1000; j++) {
+                frames++;
+                bytes += 100;
+            }
+        });
+    }
+    threads.clear();
+
+    ASSERT_EQ((uint64_t)frames, (counter_shards_max + 8) * 1000);
+    ASSERT_EQ((uint64_t)bytes, (counter_shards_max + 8) * 100000);
+
+    // Shards of exited threads are reused.
+    std::jthread([&]() {
+        frames++;
+        ASSERT_LT(counter_shard(), counter_shards_max);
+    }).join();
+    ASSERT_EQ((uint64_t)frames, (counter_shards_max + 8) * 1000 + 1);
+}
+
+TEST(mesh_test, Histogram) {
+    using namespace mesh::telemetry;
+
+    Histogram hist;
+
+    // 1..10000 us, uniformly distributed
+    for (int64_t i = 1; i <= 10000; i++)
+        hist.record(i * 1000);
+
+    auto s = hist.collect_reset();
+    ASSERT_EQ(s.count, 10000);
+    ASSERT_EQ(s.max, 10000000);
+    ASSERT_NEAR(s.p50, 5000000, 5000000 / 32);
+    ASSERT_NEAR(s.p99, 9900000, 9900000 / 32);
+    ASSERT_NEAR(s.p999, 9990000, 9990000 / 32);
+    ASSERT_LE(s.p999, s.max);
+
+    // Values below the sub-bucket count are exact.
+    for (uint64_t v = 0; v < Histogram::sub_count; v++)
+        ASSERT_EQ(Histogram::bucket_value(Histogram::bucket_index(v)), v);
+
+    // The histogram is reset after collection.
+    s = hist.collect_reset();
+    ASSERT_EQ(s.count, 0);
+    ASSERT_EQ(s.max, 0);
+}
+
+TEST(mesh_test, RelayRegion) {
+    using mesh::connection::RelayRegion;
+
+    auto region = RelayRegion::attach("relay-test", 1024, 4, true);
+    ASSERT_NE(region, nullptr);
+    ASSERT_EQ(region->size, 1024 * 4 * 2);
+
+    // Only one producer per group and the same geometry are allowed.
+    ASSERT_EQ(RelayRegion::attach("relay-test", 1024, 4, true), nullptr);
+    ASSERT_EQ(RelayRegion::attach("relay-test", 2048, 4, false), nullptr);
+
+    auto consumer = RelayRegion::attach("relay-test", 1024, 4, false);
+    ASSERT_EQ(consumer, region);
+
+    auto ptr = (uint8_t *)region->addr + region->offset_of(2);
+    ASSERT_TRUE(region->is_slot(ptr, 1024));
+    ASSERT_FALSE(region->is_slot(ptr + 1, 16));
+    ASSERT_FALSE(region->is_slot(ptr, region->size));
+    ASSERT_EQ(region->slot_of(ptr), 2);
+
+    // Slot is released after all references are dropped.
+    region->hold(2);
+    region->retain(2);
+    region->release(2);
+    ASSERT_FALSE(region->is_released(2));
+    region->release(2);
+    ASSERT_TRUE(region->is_released(2));
+
+    // Pool slots are allocated from the upper half of the region.
+    uint32_t slots[4], slot;
+    for (auto& s : slots) {
+        ASSERT_TRUE(region->alloc_slot(s));
+        ASSERT_GE(s, 4);
+        ASSERT_LT(s, 8);
+    }
+    ASSERT_FALSE(region->alloc_slot(slot));
+    region->release(slots[1]);
+    ASSERT_TRUE(region->alloc_slot(slot));
+    ASSERT_EQ(slot, slots[1]);
+
+    consumer->detach(false);
+    region->detach(true);
+}
+
+TEST(mesh_test, BufferPool) {
+    using namespace mesh::connection;
+
+    BufferPartitions parts = {
+        .payload = { .size = 1000, .offset = 0 },
+        .metadata = { .size = 0, .offset = 1000 },
+        .sysdata = { .size = sizeof(BufferSysData), .offset = 1000 },
+    };
+
+    auto pool = new BufferPool(parts);
+    ASSERT_TRUE(pool->init(2, true));
+    ASSERT_EQ(pool->available(), 2);
+
+    static int released;
+    released = 0;
+
+    auto buf = pool->alloc();
+    ASSERT_NE(buf, nullptr);
+    ASSERT_NE(buf->data, nullptr);
+    ASSERT_EQ(buf->sysdata(), (BufferSysData *)((uint8_t *)buf->data + 1000));
+    buf->on_release = [](BufferHandle *) { released++; };
+
+    auto buf2 = pool->alloc();
+    ASSERT_NE(buf2, nullptr);
+    ASSERT_EQ(pool->alloc(), nullptr);
+    ASSERT_EQ(pool->outstanding(), 2);
+
+    // The buffer is returned to the pool after the last reference is dropped.
+    buf->retain();
+    buf->release();
+    ASSERT_EQ(released, 0);
+    buf->release();
+    ASSERT_EQ(released, 1);
+    ASSERT_EQ(pool->available(), 1);
+
+    // Deletion of the pool is deferred until all handles are released,
+    // and so is the release of the memory the handles point into.
+    static int freed;
+    freed = 0;
+    pool->on_destroy([]() { freed++; });
+    pool->destroy();
+    ASSERT_EQ(freed, 0);
+    buf2->release();
+    ASSERT_EQ(freed, 1);
+}
+
+TEST(mesh_test, BufferUsedSize) {
+    using namespace mesh::connection;
+
+    // SDK layout: system data, payload, metadata
+    BufferPartitions parts = {
+        .payload = { .size = 1000, .offset = sizeof(BufferSysData) },
+        .metadata = { .size = 100, .offset = sizeof(BufferSysData) + 1000 },
+        .sysdata = { .size = sizeof(BufferSysData), .offset = 0 },
+    };
+    auto size = parts.total_size();
+    std::vector<uint8_t> buf(size);
+    auto sys = (BufferSysData *)buf.data();
+
+    sys->payload_len = 200;
+    sys->metadata_len = 0;
+    ASSERT_EQ(parts.used_size(buf.data(), size), sizeof(BufferSysData) + 200);
+
+    sys->metadata_len = 10;
+    ASSERT_EQ(parts.used_size(buf.data(), size), sizeof(BufferSysData) + 1010);
+
+    // Lengths are capped by the partition sizes.
+    sys->payload_len = 5000;
+    sys->metadata_len = 0;
+    ASSERT_EQ(parts.used_size(buf.data(), size), sizeof(BufferSysData) + 1000);
+
+    // Buffers without the full partitioning are used entirely.
+    ASSERT_EQ(parts.used_size(buf.data(), 500), 500);
+}
+
+TEST(mesh_test, MemoryRegions) {
+    using namespace mesh::connection;
+
+    struct Listener : MemoryRegionListener {
+        std::vector<MemoryRegion> added;
+        std::vector<uint64_t> removed;
+
+        void on_region_add(const MemoryRegion& region) override {
+            added.push_back(region);
+        }
+        void on_region_remove(const MemoryRegion& region) override {
+            removed.push_back(region.id);
+        }
+    };
+
+    static uint8_t mem[4096];
+
+    auto id = MemoryRegions::add(mem, sizeof(mem));
+
+    // A listener is told about the regions added before subscribing.
+    Listener listener;
+    MemoryRegions::subscribe(&listener);
+    ASSERT_EQ(listener.added.size(), 1);
+    ASSERT_EQ(listener.added[0].id, id);
+    ASSERT_EQ(listener.added[0].addr, mem);
+    ASSERT_TRUE(listener.added[0].contains(mem + 1024, 1024));
+    ASSERT_FALSE(listener.added[0].contains(mem + 1024, 4096));
+
+    // A region added at the same address gets a new id.
+    MemoryRegions::remove(id);
+    ASSERT_EQ(listener.removed, std::vector<uint64_t>{ id });
+
+    auto id2 = MemoryRegions::add(mem, sizeof(mem));
+    ASSERT_NE(id2, id);
+    ASSERT_EQ(listener.added.size(), 2);
+    ASSERT_EQ(listener.added[1].id, id2);
+
+    MemoryRegions::unsubscribe(&listener);
+    MemoryRegions::remove(id2);
+    ASSERT_EQ(listener.removed.size(), 1);
+}
+
+namespace {
+
+using namespace mesh;
+using namespace mesh::connection;
+
+class EmulatedRx : public Connection {
+public:
+    EmulatedRx() { _kind = Kind::receiver; }
+
+    void configure(context::Context& ctx) { set_state(ctx, State::configured); }
+
+    Result send(void *ptr, uint32_t sz) {
+        return transmit(context::Background(), ptr, sz);
+    }
+
+    Result send_burst(BufferHandle **bufs, uint32_t count) {
+        return transmit_burst(context::Background(), bufs, count);
+    }
+
+private:
+    Result on_establish(context::Context& ctx) override {
+        set_state(ctx, State::active);
+        return Result::success;
+    }
+    Result on_shutdown(context::Context& ctx) override {
+        set_state(ctx, State::closed);
+        return Result::success;
+    }
+};
+
+class EmulatedTx : public Connection {
+public:
+    EmulatedTx() { _kind = Kind::transmitter; }
+
+    void configure(context::Context& ctx) { set_state(ctx, State::configured); }
+
+    std::atomic<bool> blocked = false;
+    std::atomic<int> received = 0;
+
+private:
+    Result on_establish(context::Context& ctx) override {
+        set_state(ctx, State::active);
+        return Result::success;
+    }
+    Result on_shutdown(context::Context& ctx) override {
+        set_state(ctx, State::closed);
+        return Result::success;
+    }
+    Result on_receive(context::Context& ctx, void *ptr, uint32_t sz,
+                      uint32_t& sent) override {
+        while (blocked && !ctx.cancelled())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        received++;
+        sent = sz;
+        return Result::success;
+    }
+};
+
+} // namespace
+
+TEST(mesh_test, GroupParallelFanOut) {
+    using namespace mesh::multipoint;
+
+    auto& ctx = context::Background();
+
+    config::proxy.multipoint.parallel_fanout = true;
+    config::proxy.multipoint.fanout_queue_depth = 2;
+
+    EmulatedRx rx;
+    EmulatedTx fast, slow;
+    rx.config.buf_parts.payload.size = 64;
+
+    auto group = new Group("test-group");
+    group->configure(ctx);
+    ASSERT_EQ(group->establish(ctx), Result::success);
+
+    rx.configure(ctx);
+    fast.configure(ctx);
+    slow.configure(ctx);
+    ASSERT_EQ(rx.establish(ctx), Result::success);
+    ASSERT_EQ(fast.establish(ctx), Result::success);
+    ASSERT_EQ(slow.establish(ctx), Result::success);
+
+    ASSERT_EQ(group->assign_input(ctx, &rx), Result::success);
+    rx.set_link(ctx, group);
+    ASSERT_EQ(group->add_output(ctx, &fast), Result::success);
+    ASSERT_EQ(group->add_output(ctx, &slow, DropPolicy::drop_oldest),
+              Result::success);
+
+    // A blocked output must not stall the ingress and the other outputs.
+    slow.blocked = true;
+
+    uint8_t frame[64] = {};
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(rx.send(frame, sizeof(frame)), Result::success);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    for (int i = 0; i < 1000 && fast.received < 10; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(fast.received, 10);
+
+    // The blocked output gets one frame being processed plus the queue.
+    slow.blocked = false;
+    for (int i = 0; i < 1000 && slow.received < 3; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(slow.received, 3);
+
+    rx.set_link(ctx, nullptr);
+    group->shutdown(ctx);
+    delete group;
+
+    config::proxy.multipoint.parallel_fanout = false;
+}
+
+TEST(mesh_test, GroupParallelRingSlot) {
+    using namespace mesh::multipoint;
+
+    auto& ctx = context::Background();
+
+    config::proxy.multipoint.parallel_fanout = true;
+    config::proxy.multipoint.fanout_queue_depth = 2;
+
+    EmulatedRx rx;
+    EmulatedTx slow;
+    rx.config.buf_parts.payload.size = 64;
+
+    auto group = new Group("test-group-ring-slot");
+    group->configure(ctx);
+    ASSERT_EQ(group->establish(ctx), Result::success);
+
+    rx.configure(ctx);
+    slow.configure(ctx);
+    ASSERT_EQ(rx.establish(ctx), Result::success);
+    ASSERT_EQ(slow.establish(ctx), Result::success);
+
+    ASSERT_EQ(group->assign_input(ctx, &rx), Result::success);
+    rx.set_link(ctx, group);
+    ASSERT_EQ(group->add_output(ctx, &slow), Result::success);
+
+    slow.blocked = true;
+
+    BufferPartitions parts = {
+        .payload = { .size = 64, .offset = 0 },
+        .metadata = { .size = 0, .offset = 64 },
+        .sysdata = { .size = 0, .offset = 64 },
+    };
+    auto pool = new BufferPool(parts);
+    ASSERT_TRUE(pool->init(2, true));
+
+    // Ingress ring slots are copied, so a blocked output does not hold them.
+    BufferHandle *bufs[2];
+    for (auto& buf : bufs) {
+        buf = pool->alloc();
+        ASSERT_NE(buf, nullptr);
+        buf->size = 64;
+        buf->ring_slot = true;
+    }
+    ASSERT_EQ(rx.send_burst(bufs, 2), Result::success);
+
+    for (auto buf : bufs)
+        buf->release();
+    ASSERT_EQ(pool->outstanding(), 0);
+    pool->destroy();
+
+    slow.blocked = false;
+    for (int i = 0; i < 1000 && slow.received < 2; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(slow.received, 2);
+
+    rx.set_link(ctx, nullptr);
+    group->shutdown(ctx);
+    delete group;
+
+    config::proxy.multipoint.parallel_fanout = false;
+}
+
+TEST(mesh_test, GroupParallelRingSlotNoCopy) {
+    using namespace mesh::multipoint;
+
+    auto& ctx = context::Background();
+
+    config::proxy.multipoint.parallel_fanout = true;
+    config::proxy.multipoint.fanout_queue_depth = 2;
+
+    EmulatedRx rx;
+    EmulatedTx tx;
+    rx.config.buf_parts.payload.size = 64;
+
+    auto group = new Group("test-group-ring-slot-no-copy");
+    group->configure(ctx);
+    ASSERT_EQ(group->establish(ctx), Result::success);
+
+    rx.configure(ctx);
+    tx.configure(ctx);
+    ASSERT_EQ(rx.establish(ctx), Result::success);
+    ASSERT_EQ(tx.establish(ctx), Result::success);
+
+    ASSERT_EQ(group->assign_input(ctx, &rx), Result::success);
+    rx.set_link(ctx, group);
+    ASSERT_EQ(group->add_output(ctx, &tx), Result::success);
+
+    BufferPartitions parts = {
+        .payload = { .size = 128, .offset = 0 },
+        .metadata = { .size = 0, .offset = 128 },
+        .sysdata = { .size = 0, .offset = 128 },
+    };
+    auto pool = new BufferPool(parts);
+    ASSERT_TRUE(pool->init(2, true));
+
+    // Ring slots too large for the fan-out pool are delivered serially
+    // and never wait in the output queue.
+    BufferHandle *bufs[2];
+    for (auto& buf : bufs) {
+        buf = pool->alloc();
+        ASSERT_NE(buf, nullptr);
+        buf->size = 128;
+        buf->ring_slot = true;
+    }
+    ASSERT_EQ(rx.send_burst(bufs, 2), Result::success);
+    ASSERT_EQ(tx.received, 2);
+
+    uint32_t sent = 0;
+    ASSERT_EQ(group->do_receive(ctx, bufs[0], sent), Result::success);
+    ASSERT_EQ(tx.received, 3);
+
+    for (auto buf : bufs)
+        buf->release();
+    ASSERT_EQ(pool->outstanding(), 0);
+    pool->destroy();
+
+    rx.set_link(ctx, nullptr);
+    group->shutdown(ctx);
+    delete group;
+
+    config::proxy.multipoint.parallel_fanout = false;
+}
+
+TEST(mesh_test, GroupBurst) {
+    using namespace mesh::multipoint;
+
+    auto& ctx = context::Background();
+
+    EmulatedRx rx;
+    EmulatedTx tx1, tx2;
+
+    auto group = new Group("test-group-burst");
+    group->configure(ctx);
+    ASSERT_EQ(group->establish(ctx), Result::success);
+
+    rx.configure(ctx);
+    tx1.configure(ctx);
+    tx2.configure(ctx);
+    ASSERT_EQ(rx.establish(ctx), Result::success);
+    ASSERT_EQ(tx1.establish(ctx), Result::success);
+    ASSERT_EQ(tx2.establish(ctx), Result::success);
+
+    ASSERT_EQ(group->assign_input(ctx, &rx), Result::success);
+    rx.set_link(ctx, group);
+    ASSERT_EQ(group->add_output(ctx, &tx1), Result::success);
+    ASSERT_EQ(group->add_output(ctx, &tx2), Result::success);
+
+    BufferPartitions parts = {
+        .payload = { .size = 64, .offset = 0 },
+        .metadata = { .size = 0, .offset = 64 },
+        .sysdata = { .size = 0, .offset = 64 },
+    };
+    auto pool = new BufferPool(parts);
+    ASSERT_TRUE(pool->init(8, true));
+
+    // Every output receives all frames of the burst in one call.
+    BufferHandle *bufs[8];
+    for (auto& buf : bufs) {
+        buf = pool->alloc();
+        ASSERT_NE(buf, nullptr);
+        buf->size = 64;
+    }
+    ASSERT_EQ(rx.send_burst(bufs, 8), Result::success);
+    ASSERT_EQ(tx1.received, 8);
+    ASSERT_EQ(tx2.received, 8);
+
+    for (auto buf : bufs)
+        buf->release();
+    ASSERT_EQ(pool->outstanding(), 0);
+    pool->destroy();
+
+    rx.set_link(ctx, nullptr);
+    group->shutdown(ctx);
+    delete group;
+}
@@ -353,7 +353,7 @@ TEST(st2110_tx, send_data) {
             char metadata;
         } buf = {
             .sysdata = {
-                .timestamp_ms = 0,
+                .timestamp_ns = 0,
                 .seq = 0,
                 .payload_len = sizeof(DUMMY_DATA2),
                 .metadata_len = 0,
@@ -36,6 +36,9 @@ typedef struct {
     /* staging buffer */
     memif_buffer_t working_bufs[MEMIF_BUFFER_NUM];
     int working_idx;
+
+    /* buffer region shared by Media Proxy for zero-copy relay */
+    char relay_region_path[108];
 } memif_conn_context;
 
 typedef struct {
@@ -46,8 +49,9 @@ typedef struct {
     char socket_path[108];
 } memif_ops_t;
 
-/* Create memif connection . */
-mcm_conn_context* mcm_create_connection_memif(mcm_conn_param* svc_args, memif_conn_param* memif_args);
+/* Create memif connection. The relay region path is optional. */
+mcm_conn_context* mcm_create_connection_memif(mcm_conn_param* svc_args, memif_conn_param* memif_args,
+                                              const char* relay_region_path);
 
 /* Destroy memif connection. */
 void mcm_destroy_connection_memif(memif_conn_context* pctx);
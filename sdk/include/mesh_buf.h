@@ -6,8 +6,10 @@
 #ifndef MESH_BUF_H
 #define MESH_BUF_H
 
+#include <atomic>
 #include "mesh_dp.h"
 #include "mcm_dp.h"
+#include "mesh_seq.h"
 
 namespace mesh {
 
@@ -65,12 +67,33 @@ public:
  */
 class BufferSysData {
 public:
-    int64_t timestamp_ms;
-    uint32_t seq;
+    int64_t timestamp_ns; // capture time (CLOCK_REALTIME), 0 if not set
+    uint32_t seq;         // per-connection sequence number set by the sender
     uint32_t payload_len;
     uint32_t metadata_len;
 };
-    
+
+/**
+ * Connection statistics collected from the system data of buffers
+ */
+class ConnectionStats {
+public:
+    void on_receive(const BufferSysData *sysdata);
+    void get(MeshConnectionStats *stats) const;
+
+    std::atomic<uint64_t> buffers = 0;
+    SequenceTracker seq;
+
+    std::atomic<uint64_t> latency_count = 0;
+    std::atomic<int64_t> latency_last_ns = 0;
+    std::atomic<int64_t> latency_min_ns = 0;
+    std::atomic<int64_t> latency_max_ns = 0;
+    std::atomic<int64_t> latency_sum_ns = 0;
+};
+
+int64_t realtime_ns();
+
+
 } // namespace mesh
 
 #endif // MESH_BUF_H
@@ -110,6 +110,10 @@ public:
         struct {
             std::string provider = "tcp";
             uint8_t num_endpoints = 1;
+            std::string transport = "send";
+            std::string completion = "hybrid";
+            uint32_t segment_size = 0;
+            std::string flow_control = "none";
         } rdma;
     } options;
 
@@ -183,6 +187,13 @@ public:
     void *grpc_conn = nullptr;
 
     ConnectionConfig cfg;
+
+    /**
+     * Sequence number of the next buffer sent.
+     */
+    uint32_t tx_seq = 0;
+
+    ConnectionStats stats;
 };
 
 } // namespace mesh
@@ -81,6 +81,38 @@ typedef struct{
 
 } MeshBuffer;
 
+/**
+ * Mesh connection statistics
+ */
+typedef struct{
+    /**
+     * Number of buffers sent or received
+     */
+    uint64_t buffers;
+    /**
+     * Number of buffers missing in the sequence of received buffers
+     */
+    uint64_t lost;
+    /**
+     * Number of buffers received more than once
+     */
+    uint64_t duplicated;
+    /**
+     * Number of buffers received out of order
+     */
+    uint64_t reordered;
+    /**
+     * End-to-end latency in nanoseconds, from the moment the sender put
+     * the buffer to the moment the receiver got it. Requires the clocks of
+     * the sender and receiver hosts to be synchronized, e.g. by PTP.
+     */
+    int64_t latency_last_ns;
+    int64_t latency_min_ns;
+    int64_t latency_max_ns;
+    int64_t latency_avg_ns;
+
+} MeshConnectionStats;
+
 /**
  * Timeout configuration constants
  */
@@ -240,6 +272,19 @@ int mesh_buffer_set_payload_len(MeshBuffer *buf, size_t len);
  */
 int mesh_buffer_set_metadata_len(MeshBuffer *buf, size_t len);
 
+/**
+ * @brief Get statistics of a mesh connection.
+ *
+ * Sequence and latency statistics are collected by receiver connections
+ * only. Sender connections report the number of buffers sent.
+ *
+ * @param [in] conn Pointer to a connection structure.
+ * @param [out] stats Pointer to a connection statistics structure.
+ *
+ * @return 0 on success; an error code otherwise.
+ */
+int mesh_get_connection_stats(MeshConnection *conn, MeshConnectionStats *stats);
+
 /**
  * @brief Get text description of an error code.
  * 
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2025 Intel Corporation
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+#ifndef MESH_SEQ_H
+#define MESH_SEQ_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace mesh {
+
+/**
+ * Sequence number tracker
+ *
+ * Checks the sequence numbers of a stream of buffers and counts buffers
+ * lost, duplicated and received out of order. Sequence numbers wrap around.
+ * A window of recently received sequence numbers tells late buffers from
+ * duplicates. A buffer far behind the window is treated as a restart of
+ * the sender. Updated by a single thread, counters can be read by any thread.
+ *
+ * Shared by the SDK and the media proxy.
+ */
+class SequenceTracker {
+public:
+    static constexpr uint32_t window_size = 64;
+
+    void update(uint32_t seq);
+
+    std::atomic<uint64_t> lost = 0;
+    std::atomic<uint64_t> duplicated = 0;
+    std::atomic<uint64_t> reordered = 0;
+
+private:
+    static void counter_add(std::atomic<uint64_t>& counter, int64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    uint32_t next = 0;
+    uint64_t window = 0; // bit i is set if (next - 1 - i) was received
+    bool started = false;
+};
+
+inline void SequenceTracker::update(uint32_t seq)
+{
+    if (!started) [[unlikely]] {
+        started = true;
+        next = seq + 1;
+        window = 1;
+        return;
+    }
+
+    int32_t diff = seq - next;
+
+    if (diff >= 0) [[likely]] {
+        if (diff)
+            counter_add(lost, diff);
+
+        uint64_t shift = (uint64_t)diff + 1;
+        window = shift < window_size ? (window << shift) | 1 : 1;
+        next = seq + 1;
+        return;
+    }
+
+    uint32_t age = next - 1 - seq;
+    if (age >= window_size) {
+        next = seq + 1;
+        window = 1;
+        return;
+    }
+
+    uint64_t bit = 1ULL << age;
+    if (window & bit) {
+        counter_add(duplicated, 1);
+        return;
+    }
+
+    // The buffer was counted as lost when the gap was detected.
+    window |= bit;
+    counter_add(reordered, 1);
+    if (lost.load(std::memory_order_relaxed))
+        counter_add(lost, -1);
+}
+
+} // namespace mesh
+
+#endif // MESH_SEQ_H
@@ -204,7 +204,7 @@ mcm_conn_context* mcm_create_connection_proxy(mcm_conn_param* param)
     }
 
     /* Connect memif connection. */
-    conn_ctx = mcm_create_connection_memif(param, &memif_param);
+    conn_ctx = mcm_create_connection_memif(param, &memif_param, NULL);
     if (conn_ctx == NULL) {
         log_error("Fail to create memif interface.");
         close_socket(sockfd);
@@ -281,7 +281,7 @@ mcm_conn_context* mcm_create_connection(mcm_conn_param* param)
         memif_conn_param memif_param = {};
         parse_memif_param(param, &(memif_param.socket_args), &(memif_param.conn_args));
         /* Connect memif connection. */
-        conn_ctx = mcm_create_connection_memif(param, &memif_param);
+        conn_ctx = mcm_create_connection_memif(param, &memif_param, NULL);
         if (!conn_ctx) {
             log_error("Failed to create memif connection.");
             return NULL;
@@ -4,11 +4,14 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#define _GNU_SOURCE
 #include "memif_impl.h"
 #include "libmemif.h"
 #include "logger.h"
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <errno.h>
@@ -198,7 +201,58 @@ int rx_on_receive(memif_conn_handle_t conn, void* priv_data, uint16_t qid)
     return 0;
 }
 
-mcm_conn_context* mcm_create_connection_memif(mcm_conn_param* svc_args, memif_conn_param* memif_args)
+/* Map the buffer region shared by Media Proxy for zero-copy relay.
+ * Falls back to a private region if the shared one can't be mapped,
+ * in which case Media Proxy copies the frames. */
+static int relay_add_region(void** addr, uint32_t size, int* fd, void* priv_data)
+{
+    memif_conn_context* pmemif = (memif_conn_context*)priv_data;
+    struct stat st;
+
+    *fd = open(pmemif->relay_region_path, O_RDWR);
+    if (*fd >= 0) {
+        if (!fstat(*fd, &st) && st.st_size == size) {
+            *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+            if (*addr != MAP_FAILED)
+                return MEMIF_ERR_SUCCESS;
+        }
+        close(*fd);
+    }
+
+    log_error("Relay region %s not mapped, fall back to copying.",
+              pmemif->relay_region_path);
+
+    *fd = memfd_create("memif region 1", MFD_ALLOW_SEALING);
+    if (*fd < 0)
+        return MEMIF_ERR_NOMEM;
+
+    if (ftruncate(*fd, size) < 0) {
+        close(*fd);
+        return MEMIF_ERR_NOMEM;
+    }
+
+    *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+    if (*addr == MAP_FAILED) {
+        *addr = NULL;
+        close(*fd);
+        return MEMIF_ERR_NOMEM;
+    }
+
+    return MEMIF_ERR_SUCCESS;
+}
+
+static int relay_del_region(void* addr, uint32_t size, int fd, void* priv_data)
+{
+    if (addr)
+        munmap(addr, size);
+    if (fd >= 0)
+        close(fd);
+
+    return MEMIF_ERR_SUCCESS;
+}
+
+mcm_conn_context* mcm_create_connection_memif(mcm_conn_param* svc_args, memif_conn_param* memif_args,
+                                              const char* relay_region_path)
 {
     int ret = 0;
     mcm_conn_context* conn_ctx = NULL;
@@ -236,6 +290,13 @@ mcm_conn_context* mcm_create_connection_memif(mcm_conn_param* svc_args, memif_co
     shm_conn->sockfd = memif_socket;
     memif_args->conn_args.socket = memif_socket;
 
+    if (relay_region_path && relay_region_path[0]) {
+        strncpy(shm_conn->relay_region_path, relay_region_path,
+                sizeof(shm_conn->relay_region_path) - 1);
+        memif_register_external_region(memif_socket, relay_add_region, NULL,
+                                        relay_del_region, NULL);
+    }
+
     log_info("Create memif interface.");
     if (svc_args->type == is_tx) {
         ret = memif_create(&shm_conn->conn, &memif_args->conn_args,
@@ -7,6 +7,7 @@
 #include "mesh_conn.h"
 #include "mesh_logger.h"
 #include "mesh_dp_legacy.h"
+#include <time.h>
 
 namespace mesh {
 
@@ -44,6 +45,8 @@ int BufferContext::dequeue(int timeout_ms)
             sysdata->payload_len = conn->cfg.buf_parts.payload.size;
         if (sysdata->metadata_len > conn->cfg.buf_parts.metadata.size)
             sysdata->metadata_len = conn->cfg.buf_parts.metadata.size;
+
+        conn->stats.on_receive(sysdata);
     }
 
     *(void **)&__public.payload_ptr = payload_ptr;
@@ -66,8 +69,10 @@ int BufferContext::enqueue(int timeout_ms)
 
         sysdata->payload_len = __public.payload_len;
         sysdata->metadata_len = __public.metadata_len;
-        sysdata->seq = 0;          // TODO: Implement incremental seq numbers
-        sysdata->timestamp_ms = 0; // TODO: Implement timestamping
+        sysdata->seq = conn->tx_seq++;
+        sysdata->timestamp_ns = realtime_ns();
+
+        conn->stats.buffers.fetch_add(1, std::memory_order_relaxed);
     }
 
     /**
@@ -107,4 +112,56 @@ size_t BufferPartitions::total_size() const {
     return payload.size + metadata.size + sysdata.size;
 }
 
+/**
+ * Check the sequence number and measure the latency from the capture
+ * timestamp set by the sender. Buffers without a timestamp come from
+ * senders that do not fill in the system data and are not checked.
+ */
+void ConnectionStats::on_receive(const BufferSysData *sysdata)
+{
+    buffers.fetch_add(1, std::memory_order_relaxed);
+
+    if (!sysdata->timestamp_ns)
+        return;
+
+    seq.update(sysdata->seq);
+
+    int64_t latency = realtime_ns() - sysdata->timestamp_ns;
+    auto count = latency_count.load(std::memory_order_relaxed);
+
+    if (!count || latency < latency_min_ns.load(std::memory_order_relaxed))
+        latency_min_ns.store(latency, std::memory_order_relaxed);
+    if (!count || latency > latency_max_ns.load(std::memory_order_relaxed))
+        latency_max_ns.store(latency, std::memory_order_relaxed);
+
+    latency_last_ns.store(latency, std::memory_order_relaxed);
+    latency_sum_ns.fetch_add(latency, std::memory_order_relaxed);
+    latency_count.store(count + 1, std::memory_order_release);
+}
+
+void ConnectionStats::get(MeshConnectionStats *stats) const
+{
+    auto count = latency_count.load(std::memory_order_acquire);
+
+    stats->buffers = buffers.load(std::memory_order_relaxed);
+    stats->lost = seq.lost.load(std::memory_order_relaxed);
+    stats->duplicated = seq.duplicated.load(std::memory_order_relaxed);
+    stats->reordered = seq.reordered.load(std::memory_order_relaxed);
+    stats->latency_last_ns = latency_last_ns.load(std::memory_order_relaxed);
+    stats->latency_min_ns = latency_min_ns.load(std::memory_order_relaxed);
+    stats->latency_max_ns = latency_max_ns.load(std::memory_order_relaxed);
+    stats->latency_avg_ns = count ?
+        latency_sum_ns.load(std::memory_order_relaxed) / (int64_t)count : 0;
+}
+
+/**
+ * Wall clock in nanoseconds, comparable across hosts with synchronized clocks
+ */
+int64_t realtime_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
 } // namespace mesh
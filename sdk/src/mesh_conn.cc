@@ -129,6 +129,40 @@ int ConnectionConfig::parse_from_json(const char *str)
                     log::error("rdma: number of endpoints out of range (1..8): %u", num_endpoints);
                     return -MESH_ERR_CONN_CONFIG_INVAL;
                 }                
+
+                str = rdma.value("transport", "send");
+                if (!str.compare("send") || !str.compare("write")) {
+                    options.rdma.transport = str;
+                } else {
+                    log::error("rdma: wrong transport: %s", str.c_str());
+                    return -MESH_ERR_CONN_CONFIG_INVAL;
+                }
+
+                str = rdma.value("completion", "hybrid");
+                if (!str.compare("hybrid") || !str.compare("busy-poll") ||
+                    !str.compare("fd-wait")) {
+                    options.rdma.completion = str;
+                } else {
+                    log::error("rdma: wrong completion strategy: %s", str.c_str());
+                    return -MESH_ERR_CONN_CONFIG_INVAL;
+                }
+
+                uint32_t segment_size = rdma.value("segmentSize", 0);
+                if (!segment_size || segment_size >= 4096) {
+                    options.rdma.segment_size = segment_size;
+                } else {
+                    log::error("rdma: segment size too small (min 4096): %u", segment_size);
+                    return -MESH_ERR_CONN_CONFIG_INVAL;
+                }
+
+                str = rdma.value("flowControl", "none");
+                if (!str.compare("none") || !str.compare("block") ||
+                    !str.compare("drop-oldest") || !str.compare("drop-newest")) {
+                    options.rdma.flow_control = str;
+                } else {
+                    log::error("rdma: wrong flow control: %s", str.c_str());
+                    return -MESH_ERR_CONN_CONFIG_INVAL;
+                }
             }
         }
 
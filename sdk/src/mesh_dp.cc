@@ -217,6 +217,24 @@ int mesh_buffer_set_metadata_len(MeshBuffer *buf, size_t len)
     return buf_ctx->setMetadataLen(len);
 }
 
+/**
+ * Get statistics of a mesh connection
+ */
+int mesh_get_connection_stats(MeshConnection *conn, MeshConnectionStats *stats)
+{
+    if (!conn)
+        return -MESH_ERR_BAD_CONN_PTR;
+
+    if (!stats)
+        return -EINVAL;
+
+    ConnectionContext *conn_ctx = (ConnectionContext *)conn;
+
+    conn_ctx->stats.get(stats);
+
+    return 0;
+}
+
 /**
  * Get text description of an error code.
  */
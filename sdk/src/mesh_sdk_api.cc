@@ -50,7 +50,8 @@ public:
         : stub_(SDKAPI::NewStub(channel)) {}
 
     int CreateConnection(std::string& conn_id, mcm_conn_param *param,
-                         memif_conn_param *memif_param) {
+                         memif_conn_param *memif_param,
+                         std::string& relay_region_path) {
         if (!param || !memif_param)
             return -1;
 
@@ -80,6 +81,7 @@ public:
             }
 
             memcpy(memif_param, resp.memif_conn_param().data(), sz);
+            relay_region_path = resp.relay_region_path();
 
             return 0;
         } else {
@@ -90,7 +92,8 @@ public:
     }
 
     int CreateConnectionJson(std::string& conn_id, const ConnectionConfig& cfg,
-                             memif_conn_param *memif_param) {
+                             memif_conn_param *memif_param,
+                             std::string& relay_region_path) {
         if (!memif_param)
             return -1;
 
@@ -160,6 +163,10 @@ public:
         auto options_rdma = options->mutable_rdma();
         options_rdma->set_provider(cfg.options.rdma.provider);
         options_rdma->set_num_endpoints(cfg.options.rdma.num_endpoints);
+        options_rdma->set_transport(cfg.options.rdma.transport);
+        options_rdma->set_completion(cfg.options.rdma.completion);
+        options_rdma->set_segment_size(cfg.options.rdma.segment_size);
+        options_rdma->set_flow_control(cfg.options.rdma.flow_control);
 
         if (cfg.payload_type == MESH_PAYLOAD_TYPE_VIDEO) {
             auto video = new ConfigVideo();
@@ -199,6 +206,7 @@ public:
             }
 
             memcpy(memif_param, resp.memif_conn_param().data(), sz);
+            relay_region_path = resp.relay_region_path();
 
             return 0;
         } else {
@@ -309,7 +317,8 @@ public:
 // Can't include the entire header file due to the C/C++ atomics incompatibility.
 extern "C"
 mcm_conn_context* mcm_create_connection_memif(mcm_conn_param* svc_args,
-                                              memif_conn_param* memif_args);
+                                              memif_conn_param* memif_args,
+                                              const char* relay_region_path);
 
 void * mesh_grpc_create_conn(void *client, mcm_conn_param *param)
 {
@@ -323,8 +332,10 @@ void * mesh_grpc_create_conn(void *client, mcm_conn_param *param)
         return NULL;
 
     memif_conn_param memif_param = {};
+    std::string relay_region_path;
 
-    int err = cli->CreateConnection(conn->conn_id, param, &memif_param);
+    int err = cli->CreateConnection(conn->conn_id, param, &memif_param,
+                                    relay_region_path);
     if (err) {
         delete conn;
         log::error("Create gRPC connection failed (%d)", err);
@@ -338,7 +349,8 @@ void * mesh_grpc_create_conn(void *client, mcm_conn_param *param)
 
     // Connect memif connection
     // TODO: Propagate the main context to enable cancellation.
-    conn->handle = mcm_create_connection_memif(param, &memif_param);
+    conn->handle = mcm_create_connection_memif(param, &memif_param,
+                                               relay_region_path.c_str());
     if (!conn->handle) {
         delete conn;
         log::error("gRPC: failed to create memif interface");
@@ -360,8 +372,10 @@ void * mesh_grpc_create_conn_json(void *client, const mesh::ConnectionConfig& cf
         return NULL;
 
     memif_conn_param memif_param = {};
+    std::string relay_region_path;
 
-    int err = cli->CreateConnectionJson(conn->conn_id, cfg, &memif_param);
+    int err = cli->CreateConnectionJson(conn->conn_id, cfg, &memif_param,
+                                        relay_region_path);
     if (err) {
         delete conn;
         log::error("Create gRPC connection failed (%d)", err);
@@ -398,7 +412,8 @@ void * mesh_grpc_create_conn_json(void *client, const mesh::ConnectionConfig& cf
 
     // Connect memif connection
     // TODO: Propagate the main context to enable cancellation.
-    conn->handle = mcm_create_connection_memif(&param, &memif_param);
+    conn->handle = mcm_create_connection_memif(&param, &memif_param,
+                                               relay_region_path.c_str());
     if (!conn->handle) {
         delete conn;
         log::error("gRPC: failed to create memif interface");
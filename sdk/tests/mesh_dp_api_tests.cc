@@ -1251,6 +1251,43 @@ TEST(APITests_MeshConnection, TestNegative_DeleteConnection_NulledConn) {
     EXPECT_EQ(conn, (MeshConnection *)NULL);
 }
 
+/**
+ * Test negative scenario of getting connection statistics - nulled conn
+ */
+TEST(APITests_MeshConnection, TestNegative_GetConnectionStats_NulledConn) {
+    MeshConnectionStats stats = {};
+    int err;
+
+    APITests_Setup();
+
+    err = mesh_get_connection_stats(NULL, &stats);
+    ASSERT_EQ(err, -MESH_ERR_BAD_CONN_PTR) << mesh_err2str(err);
+}
+
+/**
+ * Test detection of lost, duplicated and reordered buffers
+ */
+TEST(APITests_MeshConnection, Test_SequenceTracker) {
+    mesh::SequenceTracker seq;
+
+    for (uint32_t s : { 10U, 11U, 13U, 12U, 14U, 14U, 20U })
+        seq.update(s);
+
+    EXPECT_EQ(seq.lost, 5);
+    EXPECT_EQ(seq.duplicated, 1);
+    EXPECT_EQ(seq.reordered, 1);
+
+    // Wrap around of sequence numbers
+    mesh::SequenceTracker wrap;
+
+    for (uint32_t s : { UINT32_MAX - 1, UINT32_MAX, 0U, 2U })
+        wrap.update(s);
+
+    EXPECT_EQ(wrap.lost, 1);
+    EXPECT_EQ(wrap.duplicated, 0);
+    EXPECT_EQ(wrap.reordered, 0);
+}
+
 // /**
 //  * Test getting and putting of a mesh buffer
 //  */